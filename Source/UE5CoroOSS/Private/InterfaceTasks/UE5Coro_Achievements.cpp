@@ -10,17 +10,32 @@ void UAsyncAchievements::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 
-	Achievements = Online::GetSubsystem(GetWorld(), FName(TEXT("RedpointEOS")))->GetAchievementsInterface().ToWeakPtr();
+	if (const IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld(), FName(TEXT("RedpointEOS"))))
+	{
+		Achievements = OnlineSubsystem->GetAchievementsInterface().ToWeakPtr();
+	}
 }
 
-UAsyncAchievements* UAsyncAchievements::Get()
+void UAsyncAchievements::Deinitialize()
 {
-	return GEngine->GameViewport->GetGameInstance()->GetSubsystem<UAsyncAchievements>();
+	Achievements.Reset();
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
+	Super::Deinitialize();
+}
+
+UAsyncAchievements* UAsyncAchievements::Get(const UObject* WorldContext)
+{
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncAchievements>(WorldContext);
 }
 
 void UAsyncAchievements::SetInterfaceName(const FName& Name)
 {
-	Achievements = Online::GetSubsystem(Get()->GetWorld(), Name)->GetAchievementsInterface().ToWeakPtr();
+	if (const IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld(), Name))
+	{
+		Achievements = OnlineSubsystem->GetAchievementsInterface().ToWeakPtr();
+	}
 }
 
 
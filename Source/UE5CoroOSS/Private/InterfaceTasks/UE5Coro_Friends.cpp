@@ -11,27 +11,30 @@ void UAsyncFriends::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 
-	[](const FLatentLambda) -> TCoroutine<>
+	if (const IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld()))
 	{
-		co_await UGameViewportClient::OnViewportCreated();
-
-		Friends = Online::GetSubsystem(Get()->GetWorld())->GetFriendsInterface().ToWeakPtr();
-	}(FLambdaParam(this));
+		Friends = OnlineSubsystem->GetFriendsInterface().ToWeakPtr();
+	}
 }
 
 void UAsyncFriends::Deinitialize()
 {
 	Friends.Reset();
-	
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
 	Super::Deinitialize();
 }
 
-UAsyncFriends* UAsyncFriends::Get()
+UAsyncFriends* UAsyncFriends::Get(const UObject* WorldContext)
 {
-	return GEngine->GameViewport->GetGameInstance()->GetSubsystem<UAsyncFriends>();
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncFriends>(WorldContext);
 }
 
 void UAsyncFriends::SetInterfaceName(const FName& Name)
 {
-	Friends = Online::GetSubsystem(Get()->GetWorld(), Name)->GetFriendsInterface().ToWeakPtr();
+	if (const IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld(), Name))
+	{
+		Friends = OnlineSubsystem->GetFriendsInterface().ToWeakPtr();
+	}
 }
@@ -11,27 +11,166 @@ void UAsyncIdentity::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 
-	[](const FLatentLambda) -> TCoroutine<>
+	if (const IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld()))
 	{
-		co_await UGameViewportClient::OnViewportCreated();
-
-		Identity = Online::GetSubsystem(Get()->GetWorld())->GetIdentityInterface().ToWeakPtr();
-	}(FLambdaParam(this));
+		Identity = OnlineSubsystem->GetIdentityInterface().ToWeakPtr();
+	}
 }
 
 void UAsyncIdentity::Deinitialize()
 {
+	UE5CoroOSS::ForgetSubsystem(this);
+
 	Super::Deinitialize();
 
 	Identity.Reset();
 }
 
-UAsyncIdentity* UAsyncIdentity::Get()
+UAsyncIdentity* UAsyncIdentity::Get(const UObject* WorldContext)
 {
-	return GEngine->GameViewport->GetGameInstance()->GetSubsystem<UAsyncIdentity>();
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncIdentity>(WorldContext);
 }
 
 void UAsyncIdentity::SetInterfaceName(const FName& Name)
 {
-	Identity = Online::GetSubsystem(Get()->GetWorld(), Name)->GetIdentityInterface().ToWeakPtr();
+	if (const IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld(), Name))
+	{
+		Identity = OnlineSubsystem->GetIdentityInterface().ToWeakPtr();
+	}
+}
+
+TCoroutine<FUniqueNetIdPtr> UAsyncIdentity::WaitForLogin(const int32 LocalUserNum, const FForceLatentCoroutine)
+{
+	co_await Latent::Until([this, LocalUserNum]
+	{
+		const TSharedPtr<IOnlineIdentity> PinnedIdentity = Identity.Pin();
+
+		return !PinnedIdentity.IsValid() || PinnedIdentity->GetLoginStatus(LocalUserNum) == ELoginStatus::LoggedIn;
+	});
+
+	const TSharedPtr<IOnlineIdentity> PinnedIdentity = Identity.Pin();
+
+	co_return PinnedIdentity.IsValid() ? PinnedIdentity->GetUniquePlayerId(LocalUserNum) : nullptr;
+}
+
+TCoroutine<TOptional<FAutoLoginResult>> UAsyncIdentity::AutoLoginUser(const FPlatformUserId PlatformUser, const FForceLatentCoroutine)
+{
+	FOnLoginCompleteDelegate AutoLoginDelegate;
+
+	int LocalUserNum = 0;
+	bool bWasSuccessful = false;
+	FUniqueNetIdRepl UserId;
+	FString Error;
+	FDelegateHandle LoginHandle;
+
+	const TSharedPtr<IOnlineIdentity> PinnedIdentity = Identity.Pin();
+
+	const TCoroutine<> DoAutoLogin = []
+		(const FLatentLambda, const TSharedPtr<IOnlineIdentity> ThisIdentity, int& OutLocalUserNum, bool& bOutWasSuccessful,
+			FUniqueNetIdRepl& OutUserId, FString& OutError, FOnLoginCompleteDelegate& ThisAutoLoginDelegate,
+			FDelegateHandle& ThisLoginHandle) -> TCoroutine<>
+	{
+		auto [InnerLocalUserNum, bInnerWasSuccesful, InnerUserId, InnerError] = co_await ThisAutoLoginDelegate;
+
+		// Only this login's delegate is removed, so logins of other users and other game instances are left alone.
+		if (ThisIdentity.IsValid())
+		{
+			ThisIdentity->ClearOnLoginCompleteDelegate_Handle(InnerLocalUserNum, ThisLoginHandle);
+		}
+
+		OutLocalUserNum = InnerLocalUserNum;
+		bOutWasSuccessful = bInnerWasSuccesful;
+		OutUserId = InnerUserId;
+		OutError = InnerError;
+	}(FLambdaParam(this), PinnedIdentity, LocalUserNum, bWasSuccessful, UserId, Error, AutoLoginDelegate, LoginHandle);
+	
+	const TCoroutine<> AutoLoginCoroutine = []
+		(const FLatentLambda This, const TSharedPtr<IOnlineIdentity> ThisIdentity, const FPlatformUserId& ThisPlatformUser, 
+			FOnLoginCompleteDelegate& ThisAutoLoginDelegate, FDelegateHandle& ThisLoginHandle) -> TCoroutine<>
+	{
+		co_await Latent::Until([This, ThisAutoLoginDelegate]
+			() -> bool
+		{
+			return ThisAutoLoginDelegate.IsBound();
+		});
+
+		if (!ThisIdentity.IsValid())
+		{
+			co_return;
+		}
+
+		ThisLoginHandle = ThisIdentity->AddOnLoginCompleteDelegate_Handle(ThisPlatformUser.GetInternalId(), ThisAutoLoginDelegate);
+	
+		if (!ThisIdentity->AutoLogin(ThisPlatformUser.GetInternalId()))
+		{
+			ThisIdentity->ClearOnLoginCompleteDelegate_Handle(ThisPlatformUser.GetInternalId(), ThisLoginHandle);
+			co_return;
+		}
+
+		co_await Latent::RealSeconds(UE5CoroOSS::GetLoginTimeout());
+
+		co_return;
+	}(FLambdaParam(this), PinnedIdentity, PlatformUser, AutoLoginDelegate, LoginHandle);
+
+	if (const int32 Success = co_await Race(AutoLoginCoroutine, DoAutoLogin); !Success)
+	{
+		// The race cancelled DoAutoLogin before it could remove the delegate, so a late login result is not delivered to it.
+		if (PinnedIdentity.IsValid() && LoginHandle.IsValid())
+		{
+			PinnedIdentity->ClearOnLoginCompleteDelegate_Handle(PlatformUser.GetInternalId(), LoginHandle);
+		}
+
+		co_return {};
+	}
+
+	FAutoLoginResult Result;
+	Result.PlatformUser = FPlatformUserId::CreateFromInternalId(LocalUserNum);
+	Result.bWasSuccessful = bWasSuccessful;
+	Result.UserId = MoveTemp(UserId);
+	Result.Error = MoveTemp(Error);
+
+	co_return Result;
+}
+
+TCoroutine<TArray<FAutoLoginResult>> UAsyncIdentity::AutoLoginAll(TArray<FPlatformUserId> PlatformUsers,
+	TFunction<void(const FAutoLoginResult&)> OnUserLoggedIn)
+{
+	// Every login starts before any is awaited, so they run side by side.
+	TArray<TCoroutine<FAutoLoginResult>> Logins;
+	Logins.Reserve(PlatformUsers.Num());
+
+	for (const FPlatformUserId& PlatformUser : PlatformUsers)
+	{
+		Logins.Add(AutoLoginAndReport(PlatformUser, OnUserLoggedIn));
+	}
+
+	TArray<FAutoLoginResult> Results;
+	Results.Reserve(Logins.Num());
+
+	for (TCoroutine<FAutoLoginResult>& Login : Logins)
+	{
+		Results.Add(co_await Login);
+	}
+
+	co_return Results;
+}
+
+TCoroutine<FAutoLoginResult> UAsyncIdentity::AutoLoginAndReport(const FPlatformUserId PlatformUser,
+	TFunction<void(const FAutoLoginResult&)> OnUserLoggedIn)
+{
+	TOptional<FAutoLoginResult> Result = co_await AutoLoginUser(PlatformUser);
+
+	if (!Result.IsSet())
+	{
+		Result.Emplace();
+		Result->PlatformUser = PlatformUser;
+		Result->Error = TEXT("AutoLogin timed out or did not start.");
+	}
+
+	if (OnUserLoggedIn)
+	{
+		OnUserLoggedIn(*Result);
+	}
+
+	co_return MoveTemp(*Result);
 }
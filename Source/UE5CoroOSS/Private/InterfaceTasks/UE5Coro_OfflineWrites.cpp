@@ -0,0 +1,424 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "InterfaceTasks/UE5Coro_OfflineWrites.h"
+#include "HAL/IConsoleManager.h"
+#include "InterfaceTasks/UE5Coro_Achievements.h"
+#include "InterfaceTasks/UE5Coro_Stats.h"
+#include "Misc/Paths.h"
+#include "PlayFabHelpers/AsyncPlayFabClient.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogOfflineWrites, Log, All);
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		float OfflineWritesSyncInterval = 0.5f;
+		FAutoConsoleVariableRef CVarOfflineWritesSyncInterval(
+			TEXT("oss.offlinewrites.syncinterval"),
+			OfflineWritesSyncInterval,
+			TEXT("Seconds between flushes of the offline write journal to disk. Writes in between share one fsync."));
+
+		float OfflineWritesRetryDelay = 5.0f;
+		FAutoConsoleVariableRef CVarOfflineWritesRetryDelay(
+			TEXT("oss.offlinewrites.retrydelay"),
+			OfflineWritesRetryDelay,
+			TEXT("Seconds before journaled writes are replayed again after the first failed replay."));
+
+		float OfflineWritesMaxRetryDelay = 300.0f;
+		FAutoConsoleVariableRef CVarOfflineWritesMaxRetryDelay(
+			TEXT("oss.offlinewrites.maxretrydelay"),
+			OfflineWritesMaxRetryDelay,
+			TEXT("Longest delay between replays of journaled writes, however often they failed."));
+
+		/** PlayFab rejects UpdateUserData requests touching more keys than this. */
+		constexpr int32 MAX_USER_DATA_KEYS_PER_REQUEST = 10;
+
+		double GetReplayRetryDelay(const int32 FailedReplays)
+		{
+			const double Delay = FMath::Min(static_cast<double>(OfflineWritesMaxRetryDelay),
+				OfflineWritesRetryDelay * FMath::Pow(2.0, FMath::Min(FailedReplays - 1, 16)));
+
+			// Spread out clients that lost connectivity together, so they do not all come back at once.
+			return Delay * FMath::FRandRange(0.5, 1.5);
+		}
+	} // namespace Private
+} // namespace UE5CoroOSS
+
+UAsyncOfflineWrites::UAsyncOfflineWrites() = default;
+
+void UAsyncOfflineWrites::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const int32 Recovered = WriteJournal.Open(FPaths::ProjectSavedDir() / TEXT("OfflineWrites") / TEXT("Journal.bin"));
+	if (Recovered > 0)
+	{
+		UE_LOG(LogOfflineWrites, Log, TEXT("Recovered %d journaled writes"), Recovered);
+	}
+
+	LastSyncTime = FPlatformTime::Seconds();
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UAsyncOfflineWrites::Tick));
+}
+
+void UAsyncOfflineWrites::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	// Whatever the replay sent but did not acknowledge yet stays pending, and is sent again next time.
+	if (CurrentReplay.IsSet())
+	{
+		CurrentReplay->Cancel();
+		CurrentReplay.Reset();
+	}
+
+	WriteJournal.Close();
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
+	Super::Deinitialize();
+}
+
+UAsyncOfflineWrites* UAsyncOfflineWrites::Get(const UObject* WorldContext)
+{
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncOfflineWrites>(WorldContext);
+}
+
+void UAsyncOfflineWrites::UpdateStats(const FUniqueNetIdRef LocalUserId, const TArray<FOnlineStatsUserUpdatedStats>& UpdatedStats)
+{
+	for (const FOnlineStatsUserUpdatedStats& UserStats : UpdatedStats)
+	{
+		for (const TPair<FString, FOnlineStatUpdate>& Stat : UserStats.Stats)
+		{
+			FOfflineWrite Write;
+			Write.Kind = EOfflineWriteKind::Stat;
+			Write.LocalUserId = FUniqueNetIdRepl(LocalUserId);
+			Write.UserId = FUniqueNetIdRepl(UserStats.Account);
+			Write.Key = Stat.Key;
+			Write.Value = Stat.Value.GetValue();
+			Write.Method = static_cast<uint8>(Stat.Value.GetModificationType());
+
+			WriteJournal.Append(MoveTemp(Write));
+		}
+	}
+}
+
+void UAsyncOfflineWrites::WriteAchievements(const FUniqueNetId& PlayerId, const FOnlineAchievementsWriteRef& WriteObject)
+{
+	for (const TPair<FName, FVariantData>& Property : WriteObject->Properties)
+	{
+		FOfflineWrite Write;
+		Write.Kind = EOfflineWriteKind::Achievement;
+		Write.LocalUserId = FUniqueNetIdRepl(PlayerId);
+		Write.UserId = Write.LocalUserId;
+		Write.Key = Property.Key.ToString();
+		Write.Value = Property.Value;
+
+		WriteJournal.Append(MoveTemp(Write));
+	}
+}
+
+bool UAsyncOfflineWrites::UpdateUserData(const PlayFab::ClientModels::FUpdateUserDataRequest& Request)
+{
+	const UAsyncPlayFabClient* Client = GetGameInstance()->GetSubsystem<UAsyncPlayFabClient>();
+	const FString Owner = Client ? Client->GetPlayFabId() : FString();
+
+	if (Owner.IsEmpty())
+	{
+		UE_LOG(LogOfflineWrites, Warning, TEXT("Not journaling a user data update, as no PlayFab player is logged in"));
+		return false;
+	}
+
+	EOfflineUserDataMethod Permission = EOfflineUserDataMethod::None;
+	if (Request.Permission.notNull())
+	{
+		Permission = Request.Permission.mValue == PlayFab::ClientModels::UserDataPermissionPublic
+			? EOfflineUserDataMethod::Public : EOfflineUserDataMethod::Private;
+	}
+
+	for (const TPair<FString, FString>& Data : Request.Data)
+	{
+		FOfflineWrite Write;
+		Write.Kind = EOfflineWriteKind::UserData;
+		Write.Owner = Owner;
+		Write.Key = Data.Key;
+		Write.Value.SetValue(Data.Value);
+		Write.Method = static_cast<uint8>(Permission);
+
+		WriteJournal.Append(MoveTemp(Write));
+	}
+
+	for (const FString& Key : Request.KeysToRemove)
+	{
+		FOfflineWrite Write;
+		Write.Kind = EOfflineWriteKind::UserData;
+		Write.Owner = Owner;
+		Write.Key = Key;
+		Write.Method = static_cast<uint8>(EOfflineUserDataMethod::Remove);
+
+		WriteJournal.Append(MoveTemp(Write));
+	}
+
+	return true;
+}
+
+void UAsyncOfflineWrites::ReplayNow()
+{
+	NextReplayTime = 0.0;
+	FailedReplays = 0;
+}
+
+int32 UAsyncOfflineWrites::GetPendingWriteCount() const
+{
+	return WriteJournal.Num();
+}
+
+bool UAsyncOfflineWrites::Tick(float)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	// Swap in a finished rewrite, so what was appended in the meantime can be synced.
+	if (!WriteJournal.IsCompacting())
+	{
+		WriteJournal.FinishCompact();
+	}
+
+	if (WriteJournal.NeedsSync() && Now - LastSyncTime >= UE5CoroOSS::Private::OfflineWritesSyncInterval)
+	{
+		LastSyncTime = Now;
+		WriteJournal.Sync();
+	}
+
+	// Acknowledged writes only leave the file once it is rewritten, which happens on a worker thread.
+	if (WriteJournal.NeedsCompaction())
+	{
+		WriteJournal.BeginCompact();
+	}
+
+	if (WriteJournal.Num() > 0 && !IsReplayInFlight() && Now >= NextReplayTime)
+	{
+		CurrentReplay.Emplace(Replay());
+	}
+
+	return true;
+}
+
+bool UAsyncOfflineWrites::IsReplayInFlight() const
+{
+	return CurrentReplay.IsSet() && !CurrentReplay->IsDone();
+}
+
+TCoroutine<> UAsyncOfflineWrites::Replay(const FForceLatentCoroutine)
+{
+	TMap<FUniqueNetIdRepl, TArray<FOfflineWrite>> Stats;
+	TMap<FUniqueNetIdRepl, TArray<FOfflineWrite>> Achievements;
+	TArray<FOfflineWrite> UserData;
+
+	const UAsyncPlayFabClient* Client = GetGameInstance()->GetSubsystem<UAsyncPlayFabClient>();
+	const FString PlayFabId = Client ? Client->GetPlayFabId() : FString();
+	bool bOtherPlayers = false;
+
+	for (FOfflineWrite& Write : WriteJournal.GetPending())
+	{
+		switch (Write.Kind)
+		{
+		case EOfflineWriteKind::Stat:
+			Stats.FindOrAdd(Write.LocalUserId).Add(MoveTemp(Write));
+			break;
+		case EOfflineWriteKind::Achievement:
+			Achievements.FindOrAdd(Write.UserId).Add(MoveTemp(Write));
+			break;
+		default:
+			if (PlayFabId.IsEmpty() || Write.Owner != PlayFabId)
+			{
+				// Written as another player, so it waits until they are logged in again.
+				bOtherPlayers = true;
+			}
+			else
+			{
+				UserData.Add(MoveTemp(Write));
+			}
+			break;
+		}
+	}
+
+	bool bSucceeded = true;
+
+	for (TPair<FUniqueNetIdRepl, TArray<FOfflineWrite>>& UserStats : Stats)
+	{
+		bSucceeded &= co_await ReplayStats(UserStats.Key, MoveTemp(UserStats.Value));
+	}
+
+	for (TPair<FUniqueNetIdRepl, TArray<FOfflineWrite>>& UserAchievements : Achievements)
+	{
+		bSucceeded &= co_await ReplayAchievements(UserAchievements.Key, MoveTemp(UserAchievements.Value));
+	}
+
+	if (!UserData.IsEmpty())
+	{
+		bSucceeded &= co_await ReplayUserData(MoveTemp(UserData));
+	}
+
+	// Make the acknowledgements durable right away, so a crash does not send the writes again.
+	WriteJournal.Sync();
+	LastSyncTime = FPlatformTime::Seconds();
+
+	if (bSucceeded)
+	{
+		// Writes of players who are not logged in are not a failure, but are only looked at again after the base delay.
+		FailedReplays = 0;
+		NextReplayTime = bOtherPlayers ? FPlatformTime::Seconds() + UE5CoroOSS::Private::OfflineWritesRetryDelay : 0.0;
+		co_return;
+	}
+
+	++FailedReplays;
+	const double Delay = UE5CoroOSS::Private::GetReplayRetryDelay(FailedReplays);
+	NextReplayTime = FPlatformTime::Seconds() + Delay;
+
+	UE_LOG(LogOfflineWrites, Log, TEXT("%d journaled writes still pending, retrying in %.0fs"), WriteJournal.Num(), Delay);
+}
+
+TCoroutine<bool> UAsyncOfflineWrites::ReplayStats(const FUniqueNetIdRepl LocalUserId, TArray<FOfflineWrite> Writes,
+	const FForceLatentCoroutine)
+{
+	UAsyncStats* AsyncStats = GetGameInstance()->GetSubsystem<UAsyncStats>();
+	if (!AsyncStats || !LocalUserId.IsValid())
+	{
+		co_return false;
+	}
+
+	// A request holds one update per stat, so writes of one stat with different modification types go out separately.
+	TMap<uint8, TArray<FOfflineWrite>> ByMethod;
+	for (FOfflineWrite& Write : Writes)
+	{
+		ByMethod.FindOrAdd(Write.Method).Add(MoveTemp(Write));
+	}
+
+	for (TPair<uint8, TArray<FOfflineWrite>>& Group : ByMethod)
+	{
+		const EOnlineStatModificationType Method = static_cast<EOnlineStatModificationType>(Group.Key);
+
+		TMap<FUniqueNetIdRepl, TMap<FString, FOnlineStatUpdate>> StatsByUser;
+		for (const FOfflineWrite& Write : Group.Value)
+		{
+			StatsByUser.FindOrAdd(Write.UserId).Add(Write.Key, FOnlineStatUpdate(Write.Value, Method));
+		}
+
+		TArray<FOnlineStatsUserUpdatedStats> UpdatedStats;
+		for (TPair<FUniqueNetIdRepl, TMap<FString, FOnlineStatUpdate>>& UserStats : StatsByUser)
+		{
+			if (UserStats.Key.IsValid())
+			{
+				UpdatedStats.Emplace(UserStats.Key->AsShared(), MoveTemp(UserStats.Value));
+			}
+		}
+
+		const auto Result = co_await AsyncStats->UpdateStats(LocalUserId->AsShared(), UpdatedStats);
+		if (!Result.IsSet() || !Result->Get<0>().WasSuccessful())
+		{
+			co_return false;
+		}
+
+		// Only what the request carried is acknowledged.
+		for (const FOfflineWrite& Write : Group.Value)
+		{
+			WriteJournal.Acknowledge(Write);
+		}
+	}
+
+	co_return true;
+}
+
+TCoroutine<bool> UAsyncOfflineWrites::ReplayAchievements(const FUniqueNetIdRepl UserId, TArray<FOfflineWrite> Writes,
+	const FForceLatentCoroutine)
+{
+	UAsyncAchievements* AsyncAchievements = GetGameInstance()->GetSubsystem<UAsyncAchievements>();
+	if (!AsyncAchievements || !UserId.IsValid())
+	{
+		co_return false;
+	}
+
+	FOnlineAchievementsWriteRef WriteObject = MakeShared<FOnlineAchievementsWrite>();
+	for (const FOfflineWrite& Write : Writes)
+	{
+		WriteObject->Properties.Add(FName(*Write.Key), Write.Value);
+	}
+
+	const auto Result = co_await AsyncAchievements->WriteAchievements(*UserId, WriteObject);
+	if (!Result.IsSet() || !Result->Get<1>())
+	{
+		co_return false;
+	}
+
+	for (const FOfflineWrite& Write : Writes)
+	{
+		WriteJournal.Acknowledge(Write);
+	}
+
+	co_return true;
+}
+
+TCoroutine<bool> UAsyncOfflineWrites::ReplayUserData(TArray<FOfflineWrite> Writes, const FForceLatentCoroutine)
+{
+	UAsyncPlayFabClient* Client = GetGameInstance()->GetSubsystem<UAsyncPlayFabClient>();
+	if (!Client)
+	{
+		co_return false;
+	}
+
+	// A request carries a single permission, and removals carry none.
+	TMap<uint8, TArray<FOfflineWrite>> ByPermission;
+	for (FOfflineWrite& Write : Writes)
+	{
+		const EOfflineUserDataMethod Method = static_cast<EOfflineUserDataMethod>(Write.Method);
+		ByPermission.FindOrAdd(static_cast<uint8>(Method & ~EOfflineUserDataMethod::Remove)).Add(MoveTemp(Write));
+	}
+
+	for (TPair<uint8, TArray<FOfflineWrite>>& Group : ByPermission)
+	{
+		const EOfflineUserDataMethod Permission = static_cast<EOfflineUserDataMethod>(Group.Key);
+
+		for (int32 Start = 0; Start < Group.Value.Num(); Start += UE5CoroOSS::Private::MAX_USER_DATA_KEYS_PER_REQUEST)
+		{
+			const TArrayView<const FOfflineWrite> Chunk = MakeArrayView(Group.Value).Slice(Start,
+				FMath::Min(UE5CoroOSS::Private::MAX_USER_DATA_KEYS_PER_REQUEST, Group.Value.Num() - Start));
+
+			PlayFab::ClientModels::FUpdateUserDataRequest Request;
+			if (EnumHasAnyFlags(Permission, EOfflineUserDataMethod::Public))
+			{
+				Request.Permission = PlayFab::ClientModels::UserDataPermissionPublic;
+			}
+			else if (EnumHasAnyFlags(Permission, EOfflineUserDataMethod::Private))
+			{
+				Request.Permission = PlayFab::ClientModels::UserDataPermissionPrivate;
+			}
+
+			for (const FOfflineWrite& Write : Chunk)
+			{
+				if (EnumHasAnyFlags(static_cast<EOfflineUserDataMethod>(Write.Method), EOfflineUserDataMethod::Remove))
+				{
+					Request.KeysToRemove.Add(Write.Key);
+				}
+				else
+				{
+					FString Value;
+					Write.Value.GetValue(Value);
+					Request.Data.Add(Write.Key, MoveTemp(Value));
+				}
+			}
+
+			const TOptional<FUpdateUserDataOutcome> Result = co_await Client->UpdateUserData(MoveTemp(Request));
+			if (!Result.IsSet() || Result->HasError())
+			{
+				co_return false;
+			}
+
+			for (const FOfflineWrite& Write : Chunk)
+			{
+				WriteJournal.Acknowledge(Write);
+			}
+		}
+	}
+
+	co_return true;
+}
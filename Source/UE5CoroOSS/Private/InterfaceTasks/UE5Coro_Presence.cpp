@@ -11,22 +11,22 @@ void UAsyncPresence::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 
-	[](const FLatentLambda) -> TCoroutine<>
+	if (const IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld()))
 	{
-		co_await UGameViewportClient::OnViewportCreated();
-
-		Presence = Online::GetSubsystem(Get()->GetWorld())->GetPresenceInterface().ToWeakPtr();
-	}(FLambdaParam(this));
+		Presence = OnlineSubsystem->GetPresenceInterface().ToWeakPtr();
+	}
 }
 
 void UAsyncPresence::Deinitialize()
 {
 	Presence.Reset();
-	
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
 	Super::Deinitialize();
 }
 
-UAsyncPresence* UAsyncPresence::Get()
+UAsyncPresence* UAsyncPresence::Get(const UObject* WorldContext)
 {
-	return GEngine->GameViewport->GetGameInstance()->GetSubsystem<UAsyncPresence>();
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncPresence>(WorldContext);
 }
\ No newline at end of file
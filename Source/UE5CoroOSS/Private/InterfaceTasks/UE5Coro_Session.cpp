@@ -9,22 +9,22 @@ void UAsyncSession::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 
-	[](const FLatentLambda) -> TCoroutine<>
+	if (const IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld()))
 	{
-		co_await UGameViewportClient::OnViewportCreated();
-
-		Session = Online::GetSubsystem(Get()->GetWorld())->GetSessionInterface().ToWeakPtr();
-	}(FLambdaParam(this));
+		Session = OnlineSubsystem->GetSessionInterface().ToWeakPtr();
+	}
 }
 
 void UAsyncSession::Deinitialize()
 {
 	Session.Reset();
-	
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
 	Super::Deinitialize();
 }
 
 UAsyncSession* UAsyncSession::Get(const UObject* WorldContext)
 {
-	return WorldContext->GetWorld()->GetGameInstance()->GetSubsystem<UAsyncSession>();
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncSession>(WorldContext);
 }
@@ -10,17 +10,32 @@ void UAsyncStats::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 
-	Stats = Online::GetSubsystem(GetWorld(), FName(TEXT("RedpointEOS")))->GetStatsInterface().ToWeakPtr();
+	if (const IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld(), FName(TEXT("RedpointEOS"))))
+	{
+		Stats = OnlineSubsystem->GetStatsInterface().ToWeakPtr();
+	}
 }
 
-UAsyncStats* UAsyncStats::Get()
+void UAsyncStats::Deinitialize()
 {
-	return GEngine->GameViewport->GetGameInstance()->GetSubsystem<UAsyncStats>();
+	Stats.Reset();
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
+	Super::Deinitialize();
+}
+
+UAsyncStats* UAsyncStats::Get(const UObject* WorldContext)
+{
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncStats>(WorldContext);
 }
 
 void UAsyncStats::SetInterfaceName(FName Name)
 {
-	Stats = Online::GetSubsystem(Get()->GetWorld(), MoveTemp(Name))->GetStatsInterface().ToWeakPtr();
+	if (const IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld(), MoveTemp(Name)))
+	{
+		Stats = OnlineSubsystem->GetStatsInterface().ToWeakPtr();
+	}
 }
 
 
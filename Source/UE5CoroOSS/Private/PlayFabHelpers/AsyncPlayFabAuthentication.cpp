@@ -2,7 +2,31 @@
 
 #include "PlayFabHelpers/AsyncPlayFabAuthentication.h"
 #include "PlayFab.h"
-#include "PlayFabAuthenticationInstanceAPI.h"
+#include "Core/PlayFabAuthenticationInstanceAPI.h"
+#include "HAL/IConsoleManager.h"
+#include "UE5CoroOSS_Shared.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPlayFabAuthentication, Log, All);
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		float TokenRefreshAhead = 600.0f;
+		FAutoConsoleVariableRef CVarTokenRefreshAhead(
+			TEXT("oss.playfab.tokenrefreshahead"),
+			TokenRefreshAhead,
+			TEXT("Seconds before the entity token expires that it is refreshed in the background."));
+
+		float TokenExpiryMargin = 30.0f;
+		FAutoConsoleVariableRef CVarTokenExpiryMargin(
+			TEXT("oss.playfab.tokenexpirymargin"),
+			TokenExpiryMargin,
+			TEXT("Seconds before the entity token expires that entity API calls wait for it to be refreshed."));
+
+		constexpr double TokenRefreshRetryDelay = 15.0;
+	} // namespace Private
+} // namespace UE5CoroOSS
 
 UAsyncPlayFabAuthentication::UAsyncPlayFabAuthentication() = default;
 
@@ -13,42 +37,167 @@ void UAsyncPlayFabAuthentication::Initialize(FSubsystemCollectionBase& Collectio
 	AuthenticationAPI = IPlayFabModuleInterface::Get().GetAuthenticationAPI();
 }
 
+void UAsyncPlayFabAuthentication::Deinitialize()
+{
+	// Ends every refresh loop.
+	EntityTokens.Reset();
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
+	Super::Deinitialize();
+}
+
 UAsyncPlayFabAuthentication* UAsyncPlayFabAuthentication::Get(const UObject* WorldContext)
 {
-	return WorldContext->GetWorld()->GetGameInstance()->GetSubsystem<UAsyncPlayFabAuthentication>();
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncPlayFabAuthentication>(WorldContext);
 }
 
-TCoroutine<TOptional<FGetEntityTokenUnion>> UAsyncPlayFabAuthentication::GetEntityToken(
+TCoroutine<TOptional<FGetEntityTokenOutcome>> UAsyncPlayFabAuthentication::GetEntityToken(
 	PlayFab::AuthenticationModels::FGetEntityTokenRequest Request, const FForceLatentCoroutine)
 {
-	PlayFab::AuthenticationModels::FGetEntityTokenResponse Response;
-	PlayFab::FPlayFabCppError Error;
+	TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext = Request.AuthenticationContext;
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority(EPlayFabPriority::Critical);
+
+	// The global API stores the new token in the global session. A player's token goes through an instance API bound to
+	// their context, which stores it there instead.
+	const TSharedPtr<PlayFab::UPlayFabAuthenticationInstanceAPI> InstanceAPI = AuthenticationContext.IsValid()
+		? MakeShared<PlayFab::UPlayFabAuthenticationInstanceAPI>(AuthenticationContext) : nullptr;
+
+	TOptional<FGetEntityTokenOutcome> Result = co_await (InstanceAPI.IsValid()
+		? UE5CoroOSS::CallPlayFab(InstanceAPI, &PlayFab::UPlayFabAuthenticationInstanceAPI::GetEntityToken, MoveTemp(Request), Priority)
+		: Call(&PlayFab::UPlayFabAuthenticationAPI::GetEntityToken, MoveTemp(Request), Priority));
+
+	if (Result.IsSet() && Result->HasValue() && Result->GetValue().TokenExpiration.notNull())
+	{
+		TrackEntityToken(Result->GetValue().TokenExpiration.mValue, MoveTemp(AuthenticationContext));
+	}
+
+	co_return Result;
+}
+
+void UAsyncPlayFabAuthentication::TrackEntityToken(const FDateTime& TokenExpiration,
+	TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext)
+{
+	FEntityToken& EntityToken = EntityTokens.FindOrAdd(AuthenticationContext);
+	EntityToken.Expiration = TokenExpiration;
+	EntityToken.Generation = NextEntityTokenGeneration++;
+
+	KeepEntityTokenFresh(MoveTemp(AuthenticationContext), EntityToken.Generation);
+}
+
+void UAsyncPlayFabAuthentication::ForgetEntityToken(const TSharedPtr<UPlayFabAuthenticationContext>& AuthenticationContext)
+{
+	// Ends the refresh loop. A refresh in flight completes, but its token is no longer tracked.
+	EntityTokens.Remove(AuthenticationContext);
+}
+
+TCoroutine<bool> UAsyncPlayFabAuthentication::WaitForEntityToken(TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext)
+{
+	const FEntityToken* EntityToken = EntityTokens.Find(AuthenticationContext);
+
+	if (!EntityToken || !EntityToken->Expiration.IsSet())
+	{
+		co_return true;
+	}
 
-	PlayFab::UPlayFabAuthenticationInstanceAPI::FGetEntityTokenDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+	const FTimespan Remaining = *EntityToken->Expiration - FDateTime::UtcNow();
 
-	const TCoroutine<> OnGetEntityToken = []
-		(const FLatentLambda, PlayFab::UPlayFabAuthenticationInstanceAPI::FGetEntityTokenDelegate& ThisSuccessDelegate,
-			PlayFab::AuthenticationModels::FGetEntityTokenResponse& ThisResponse) -> TCoroutine<>
+	if (Remaining.GetTotalSeconds() > UE5CoroOSS::Private::TokenExpiryMargin)
 	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
+		if (Remaining.GetTotalSeconds() <= UE5CoroOSS::Private::TokenRefreshAhead)
+		{
+			// Should the refresh loop have been cut short, the first caller inside the window starts the refresh instead.
+			RefreshEntityToken(MoveTemp(AuthenticationContext));
+		}
 
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
+		co_return true;
+	}
+
+	co_return co_await RefreshEntityToken(MoveTemp(AuthenticationContext));
+}
+
+TCoroutine<bool> UAsyncPlayFabAuthentication::RefreshEntityToken(TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext)
+{
+	FEntityToken& EntityToken = EntityTokens.FindOrAdd(AuthenticationContext);
 
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+	if (!EntityToken.Refresh.IsSet() || EntityToken.Refresh->IsDone())
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
+		EntityToken.Refresh.Emplace(SendEntityTokenRefresh(MoveTemp(AuthenticationContext)));
+	}
+
+	return *EntityToken.Refresh;
+}
 
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+bool UAsyncPlayFabAuthentication::HasValidEntityToken(const TSharedPtr<UPlayFabAuthenticationContext>& AuthenticationContext) const
+{
+	const FEntityToken* EntityToken = EntityTokens.Find(AuthenticationContext);
+
+	return EntityToken && EntityToken->Expiration.IsSet() && *EntityToken->Expiration > FDateTime::UtcNow();
+}
+
+PlayFab::FPlayFabCppError UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError()
+{
+	PlayFab::FPlayFabCppError Error;
+	Error.HttpCode = 401;
+	Error.HttpStatus = TEXT("Unauthorized");
+	Error.ErrorName = TEXT("EntityTokenExpired");
+	Error.ErrorMessage = TEXT("The entity token expired and could not be refreshed");
+
+	return Error;
+}
 
-	if (!AuthenticationAPI->GetEntityToken(Request, SuccessDelegate, ErrorDelegate))
+TCoroutine<bool> UAsyncPlayFabAuthentication::SendEntityTokenRefresh(TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext,
+	const FForceLatentCoroutine)
+{
+	// Sent with the player's current entity token, which PlayFab exchanges for a fresh one while it is still valid.
+	PlayFab::AuthenticationModels::FGetEntityTokenRequest Request;
+	Request.AuthenticationContext = MoveTemp(AuthenticationContext);
+
+	const TOptional<FGetEntityTokenOutcome> Result = co_await GetEntityToken(MoveTemp(Request));
+
+	if (!Result.IsSet() || Result->HasError())
 	{
-		co_return {};
+		UE_LOG(LogPlayFabAuthentication, Warning, TEXT("Failed to refresh the entity token: %s"),
+			Result.IsSet() ? *Result->GetError().GenerateErrorReport() : TEXT("request did not start"));
+
+		co_return false;
 	}
 
-	co_return { !co_await Race(OnGetEntityToken, OnError) ? FGetEntityTokenUnion(Response) : FGetEntityTokenUnion(Error) };
+	co_return true;
+}
+
+TCoroutine<> UAsyncPlayFabAuthentication::KeepEntityTokenFresh(TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext,
+	const uint32 Generation, const FForceLatentCoroutine)
+{
+	const auto IsCurrent = [this, &AuthenticationContext, Generation]
+	{
+		const FEntityToken* EntityToken = EntityTokens.Find(AuthenticationContext);
+		return EntityToken && EntityToken->Generation == Generation && EntityToken->Expiration.IsSet();
+	};
+
+	while (IsCurrent())
+	{
+		const double Remaining = (*EntityTokens[AuthenticationContext].Expiration - FDateTime::UtcNow()).GetTotalSeconds();
+		const double Delay = Remaining - UE5CoroOSS::Private::TokenRefreshAhead;
+
+		if (Delay > 0.0)
+		{
+			co_await Latent::RealSeconds(Delay);
+			continue;
+		}
+
+		// A successful refresh tracks the new token, which starts a new loop and ends this one.
+		if (co_await RefreshEntityToken(AuthenticationContext) || !IsCurrent())
+		{
+			continue;
+		}
+
+		if (Remaining <= 0.0)
+		{
+			// An expired token can not be exchanged, only a new login issues another one.
+			co_return;
+		}
+
+		co_await Latent::RealSeconds(FMath::Min(UE5CoroOSS::Private::TokenRefreshRetryDelay, FMath::Max(1.0, Remaining / 2.0)));
+	}
 }
@@ -2,7 +2,42 @@
 
 #include "PlayFabHelpers/AsyncPlayFabClient.h"
 #include "PlayFab.h"
-#include "PlayFabClientInstanceAPI.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "PlayFabHelpers/PlayFabUserDataCodec.h"
+#include "UE5CoroOSS_Shared.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPlayFabClient, Log, All);
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		int32 TitleNewsProbeCount = 5;
+		FAutoConsoleVariableRef CVarTitleNewsProbeCount(
+			TEXT("oss.playfab.titlenewsprobecount"),
+			TitleNewsProbeCount,
+			TEXT("Number of the newest title news items requested to check the cached feed for changes."));
+
+		int32 TitleNewsMaxItems = 20;
+		FAutoConsoleVariableRef CVarTitleNewsMaxItems(
+			TEXT("oss.playfab.titlenewsmaxitems"),
+			TitleNewsMaxItems,
+			TEXT("Number of title news items kept in the cache, and fetched when a check finds only new items."));
+
+		float TitleNewsRefreshInterval = 300.0f;
+		FAutoConsoleVariableRef CVarTitleNewsRefreshInterval(
+			TEXT("oss.playfab.titlenewsrefreshinterval"),
+			TitleNewsRefreshInterval,
+			TEXT("Seconds after a check of the title news feed before reading the cache starts another."));
+
+		float TitleNewsRetryDelay = 30.0f;
+		FAutoConsoleVariableRef CVarTitleNewsRetryDelay(
+			TEXT("oss.playfab.titlenewsretrydelay"),
+			TitleNewsRetryDelay,
+			TEXT("Seconds after a failed check of the title news feed before reading the cache starts another. Doubles with every further failure, up to oss.playfab.titlenewsrefreshinterval."));
+	} // namespace Private
+} // namespace UE5CoroOSS
 
 UAsyncPlayFabClient::UAsyncPlayFabClient() = default;
 
@@ -11,254 +46,423 @@ void UAsyncPlayFabClient::Initialize(FSubsystemCollectionBase& Collection)
 	Super::Initialize(Collection);
 
 	ClientAPI = IPlayFabModuleInterface::Get().GetClientAPI();
+	Authentication = Collection.InitializeDependency<UAsyncPlayFabAuthentication>();
+	Economy = Collection.InitializeDependency<UAsyncPlayFabEconomy>();
+	Profiles = Collection.InitializeDependency<UAsyncPlayFabProfiles>();
+
+	LoadTitleNewsCache();
 }
 
-UAsyncPlayFabClient* UAsyncPlayFabClient::Get(const UObject* WorldContext)
+void UAsyncPlayFabClient::Deinitialize()
 {
-	return GEngine->GameViewport->GetGameInstance()->GetSubsystem<UAsyncPlayFabClient>();
+	if (TitleNewsRefresh.IsSet())
+	{
+		TitleNewsRefresh->Cancel();
+		TitleNewsRefresh.Reset();
+	}
+
+	TitleNewsCache.Save();
+
+	ClientInstanceAPIs.Reset();
+	PlayFabIds.Reset();
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
+	Super::Deinitialize();
 }
 
-TCoroutine<TOptional<FLoginUnion>> UAsyncPlayFabClient::LoginWithOpenIdConnect(PlayFab::ClientModels::FLoginWithOpenIdConnectRequest Request,
-	const TLatentContext<>)
+UAsyncPlayFabClient* UAsyncPlayFabClient::Get(const UObject* WorldContext)
 {
-	PlayFab::ClientModels::FLoginResult Response;
-	PlayFab::FPlayFabCppError Error;
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncPlayFabClient>(WorldContext);
+}
 
-	PlayFab::UPlayFabClientInstanceAPI::FLoginWithOpenIdConnectDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+TSharedPtr<PlayFab::UPlayFabClientInstanceAPI> UAsyncPlayFabClient::GetClientAPI(const FPlatformUserId PlatformUserId)
+{
+	TSharedPtr<PlayFab::UPlayFabClientInstanceAPI>& ClientInstanceAPI = ClientInstanceAPIs.FindOrAdd(PlatformUserId);
 
-	const TCoroutine<> OnLoginWithOpenIdConnect = []
-		(const FLatentLambda, PlayFab::UPlayFabClientInstanceAPI::FLoginWithOpenIdConnectDelegate& ThisSuccessDelegate,
-			PlayFab::ClientModels::FLoginResult& ThisResponse) -> TCoroutine<>
-	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
-
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+	if (!ClientInstanceAPI.IsValid())
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		ClientInstanceAPI = MakeShared<PlayFab::UPlayFabClientInstanceAPI>();
+	}
 
-	if (!ClientAPI->LoginWithOpenIdConnect(Request, SuccessDelegate, ErrorDelegate))
+	return ClientInstanceAPI;
+}
+
+TSharedPtr<UPlayFabAuthenticationContext> UAsyncPlayFabClient::GetAuthenticationContext(const FPlatformUserId PlatformUserId)
+{
+	return PlatformUserId.IsValid() ? GetClientAPI(PlatformUserId)->GetOrCreateAuthenticationContext() : nullptr;
+}
+
+void UAsyncPlayFabClient::ReleaseClientAPI(const FPlatformUserId PlatformUserId)
+{
+	TSharedPtr<PlayFab::UPlayFabClientInstanceAPI> ClientInstanceAPI;
+
+	if (ClientInstanceAPIs.RemoveAndCopyValue(PlatformUserId, ClientInstanceAPI) && ClientInstanceAPI.IsValid())
 	{
-		co_return {};
+		Authentication->ForgetEntityToken(ClientInstanceAPI->GetOrCreateAuthenticationContext());
 	}
 
-	co_return { !co_await Race(OnLoginWithOpenIdConnect, OnError) ? FLoginUnion(Response) : FLoginUnion(Error) };
+	PlayFabIds.Remove(PlatformUserId);
 }
 
-TCoroutine<TOptional<FLoginUnion>> UAsyncPlayFabClient::LoginWithSteam(PlayFab::ClientModels::FLoginWithSteamRequest Request,
-	const FForceLatentCoroutine)
+FString UAsyncPlayFabClient::GetPlayFabId(const FPlatformUserId PlatformUserId) const
 {
-	PlayFab::ClientModels::FLoginResult Response;
-	PlayFab::FPlayFabCppError Error;
+	const FString* PlayFabId = PlayFabIds.Find(PlatformUserId);
 
-	PlayFab::UPlayFabClientInstanceAPI::FLoginWithSteamDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+	return PlayFabId ? *PlayFabId : FString();
+}
 
-	const TCoroutine<> OnLoginWithSteam = []
-		(const FLatentLambda, PlayFab::UPlayFabClientInstanceAPI::FLoginWithSteamDelegate& ThisSuccessDelegate,
-			PlayFab::ClientModels::FLoginResult& ThisResponse) -> TCoroutine<>
+TCoroutine<TOptional<FLoginOutcome>> UAsyncPlayFabClient::LoginWithOpenIdConnect(
+	PlayFab::ClientModels::FLoginWithOpenIdConnectRequest Request,
+	const FPlatformUserId PlatformUserId)
+{
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority(EPlayFabPriority::Critical);
+
+	return TrackLogin(PlatformUserId.IsValid()
+		? CallAs(PlatformUserId, &PlayFab::UPlayFabClientInstanceAPI::LoginWithOpenIdConnect, MoveTemp(Request), Priority)
+		: Call(&PlayFab::UPlayFabClientAPI::LoginWithOpenIdConnect, MoveTemp(Request), Priority), PlatformUserId);
+}
+
+TCoroutine<TOptional<FLoginOutcome>> UAsyncPlayFabClient::LoginWithSteam(PlayFab::ClientModels::FLoginWithSteamRequest Request,
+	const FPlatformUserId PlatformUserId)
+{
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority(EPlayFabPriority::Critical);
+
+	return TrackLogin(PlatformUserId.IsValid()
+		? CallAs(PlatformUserId, &PlayFab::UPlayFabClientInstanceAPI::LoginWithSteam, MoveTemp(Request), Priority)
+		: Call(&PlayFab::UPlayFabClientAPI::LoginWithSteam, MoveTemp(Request), Priority), PlatformUserId);
+}
+
+TCoroutine<TOptional<FLoginOutcome>> UAsyncPlayFabClient::LoginWithPSN(PlayFab::ClientModels::FLoginWithPSNRequest Request,
+	const FPlatformUserId PlatformUserId)
+{
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority(EPlayFabPriority::Critical);
+
+	return TrackLogin(PlatformUserId.IsValid()
+		? CallAs(PlatformUserId, &PlayFab::UPlayFabClientInstanceAPI::LoginWithPSN, MoveTemp(Request), Priority)
+		: Call(&PlayFab::UPlayFabClientAPI::LoginWithPSN, MoveTemp(Request), Priority), PlatformUserId);
+}
+
+TCoroutine<TOptional<FGetUserDataOutcome>> UAsyncPlayFabClient::GetUserData(PlayFab::ClientModels::FGetUserDataRequest Request)
+{
+	TOptional<FGetUserDataOutcome> Result = co_await (UE5CoroOSS::IsOffGameThreadParseEnabled()
+		? UE5CoroOSS::CallPlayFabOffGameThread<PlayFab::ClientModels::FGetUserDataResult>(TEXT("/Client/GetUserData"),
+			EPlayFabAuthHeader::SessionTicket, MoveTemp(Request))
+		: Call(&PlayFab::UPlayFabClientAPI::GetUserData, MoveTemp(Request)));
+
+	if (Result.IsSet() && Result->HasValue() && UE5CoroOSS::HasEncodedUserData(Result->GetValue().Data))
 	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
-
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+		co_await Tasks::MoveToTask(TEXT("PlayFabDecodeUserData"));
+
+		UE5CoroOSS::DecodeUserDataRecords(Result->GetValue().Data);
+
+		co_await Async::MoveToGameThread();
+	}
+
+	co_return Result;
+}
+
+TCoroutine<TOptional<FTitleDataOutcome>> UAsyncPlayFabClient::GetTitleData(PlayFab::ClientModels::FGetTitleDataRequest Request)
+{
+	return Call(&PlayFab::UPlayFabClientAPI::GetTitleData, MoveTemp(Request));
+}
+
+TCoroutine<TOptional<FTitleNewsOutcome>> UAsyncPlayFabClient::GetTitleNews(PlayFab::ClientModels::FGetTitleNewsRequest Request)
+{
+	return Call(&PlayFab::UPlayFabClientAPI::GetTitleNews, MoveTemp(Request));
+}
+
+const TArray<PlayFab::ClientModels::FTitleNewsItem>& UAsyncPlayFabClient::GetCachedTitleNews()
+{
+	LoadTitleNewsCache();
+
+	const FTimespan SinceChecked = FDateTime::UtcNow() - TitleNewsCache.GetLastChecked();
+
+	if (SinceChecked.GetTotalSeconds() >= UE5CoroOSS::Private::TitleNewsRefreshInterval
+		&& FPlatformTime::Seconds() >= TitleNewsRetryTime)
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		RefreshTitleNews();
+	}
 
-	if (!ClientAPI->LoginWithSteam(Request, SuccessDelegate, ErrorDelegate))
+	return TitleNewsCache.GetItems();
+}
+
+TCoroutine<bool> UAsyncPlayFabClient::RefreshTitleNews()
+{
+	if (!TitleNewsRefresh.IsSet() || TitleNewsRefresh->IsDone())
 	{
-		co_return {};
+		TitleNewsRefresh.Emplace(SendTitleNewsRefresh());
 	}
 
-	co_return { !co_await Race(OnLoginWithSteam, OnError) ? FLoginUnion(Response) : FLoginUnion(Error) };
+	return *TitleNewsRefresh;
 }
 
-TCoroutine<TOptional<FLoginUnion>> UAsyncPlayFabClient::LoginWithPSN(PlayFab::ClientModels::FLoginWithPSNRequest Request,
-	const FForceLatentCoroutine)
+TCoroutine<TOptional<FUpdateUserDataOutcome>> UAsyncPlayFabClient::UpdateUserData(
+	PlayFab::ClientModels::FUpdateUserDataRequest Request)
 {
-	PlayFab::ClientModels::FLoginResult Response;
-	PlayFab::FPlayFabCppError Error;
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority();
 
-	PlayFab::UPlayFabClientInstanceAPI::FLoginWithPSNDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+	// Copied before the first suspension, as this coroutine does not keep the subsystem alive.
+	const TSharedPtr<PlayFab::UPlayFabClientAPI> Api = ClientAPI;
 
-	const TCoroutine<> OnLoginWithPSN = []
-		(const FLatentLambda, PlayFab::UPlayFabClientInstanceAPI::FLoginWithPSNDelegate& ThisSuccessDelegate,
-			PlayFab::ClientModels::FLoginResult& ThisResponse) -> TCoroutine<>
+	TArray<FString> CompressedKeys;
+	for (const TPair<FString, FString>& Data : Request.Data)
 	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
-
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+		if (CompressedUserDataKeys.Contains(Data.Key))
+		{
+			CompressedKeys.Add(Data.Key);
+		}
+	}
+
+	if (!CompressedKeys.IsEmpty())
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		co_await Tasks::MoveToTask(TEXT("PlayFabEncodeUserData"));
+
+		for (const FString& Key : CompressedKeys)
+		{
+			FString& Value = Request.Data.FindChecked(Key);
+
+			if (FString Encoded; UE5CoroOSS::EncodeUserData(Value, Encoded))
+			{
+				Value = MoveTemp(Encoded);
+			}
+		}
+
+		co_await Async::MoveToGameThread();
+	}
+
+	co_return co_await UE5CoroOSS::CallPlayFab(Api, &PlayFab::UPlayFabClientAPI::UpdateUserData, MoveTemp(Request), Priority);
+}
 
-	if (!ClientAPI->LoginWithPSN(Request, SuccessDelegate, ErrorDelegate))
+void UAsyncPlayFabClient::SetUserDataCompressed(const FString& Key, const bool bCompressed)
+{
+	if (bCompressed)
 	{
-		co_return {};
+		CompressedUserDataKeys.Add(Key);
+	}
+	else
+	{
+		CompressedUserDataKeys.Remove(Key);
 	}
+}
+
+TCoroutine<TOptional<FLoginPipelineOutcome>> UAsyncPlayFabClient::LoginPipeline(PlayFab::ClientModels::FLoginWithSteamRequest Request,
+	FPlayFabLoginOptions Options, const FPlatformUserId PlatformUserId)
+{
+	Request.InfoRequestParameters = MakeInfoRequestParameters(Options);
+
+	return RunLoginPipeline(LoginWithSteam(MoveTemp(Request), PlatformUserId), MoveTemp(Options), PlatformUserId);
+}
+
+TCoroutine<TOptional<FLoginPipelineOutcome>> UAsyncPlayFabClient::LoginPipeline(PlayFab::ClientModels::FLoginWithPSNRequest Request,
+	FPlayFabLoginOptions Options, const FPlatformUserId PlatformUserId)
+{
+	Request.InfoRequestParameters = MakeInfoRequestParameters(Options);
+
+	return RunLoginPipeline(LoginWithPSN(MoveTemp(Request), PlatformUserId), MoveTemp(Options), PlatformUserId);
+}
+
+TCoroutine<TOptional<FLoginPipelineOutcome>> UAsyncPlayFabClient::LoginPipeline(
+	PlayFab::ClientModels::FLoginWithOpenIdConnectRequest Request, FPlayFabLoginOptions Options,
+	const FPlatformUserId PlatformUserId)
+{
+	Request.InfoRequestParameters = MakeInfoRequestParameters(Options);
 
-	co_return { !co_await Race(OnLoginWithPSN, OnError) ? FLoginUnion(Response) : FLoginUnion(Error) };
+	return RunLoginPipeline(LoginWithOpenIdConnect(MoveTemp(Request), PlatformUserId), MoveTemp(Options), PlatformUserId);
 }
 
-TCoroutine<TOptional<FGetUserDataUnion>> UAsyncPlayFabClient::GetUserData(PlayFab::ClientModels::FGetUserDataRequest Request,
-	const FForceLatentCoroutine)
+TSharedPtr<PlayFab::ClientModels::FGetPlayerCombinedInfoRequestParams> UAsyncPlayFabClient::MakeInfoRequestParameters(
+	const FPlayFabLoginOptions& Options)
 {
-	PlayFab::ClientModels::FGetUserDataResult Response;
-	PlayFab::FPlayFabCppError Error;
+	const TSharedPtr<PlayFab::ClientModels::FGetPlayerCombinedInfoRequestParams> Parameters =
+		MakeShared<PlayFab::ClientModels::FGetPlayerCombinedInfoRequestParams>();
 
-	PlayFab::UPlayFabClientInstanceAPI::FGetUserDataDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+	Parameters->GetUserData = EnumHasAnyFlags(Options.Fetch, EPlayFabLoginData::UserData);
+	Parameters->UserDataKeys = Options.UserDataKeys;
+	Parameters->GetTitleData = EnumHasAnyFlags(Options.Fetch, EPlayFabLoginData::TitleData);
+	Parameters->TitleDataKeys = Options.TitleDataKeys;
+	Parameters->GetPlayerProfile = EnumHasAnyFlags(Options.Fetch, EPlayFabLoginData::Profile);
+
+	return Parameters;
+}
+
+TCoroutine<TOptional<FLoginPipelineOutcome>> UAsyncPlayFabClient::RunLoginPipeline(TCoroutine<TOptional<FLoginOutcome>> Login,
+	FPlayFabLoginOptions Options, const FPlatformUserId PlatformUserId, const FForceLatentCoroutine)
+{
+	TOptional<FLoginOutcome> LoginResult = co_await Login;
 
-	const TCoroutine<> OnGetUserData = []
-		(const FLatentLambda, PlayFab::UPlayFabClientInstanceAPI::FGetUserDataDelegate& ThisSuccessDelegate,
-			PlayFab::ClientModels::FGetUserDataResult& ThisResponse) -> TCoroutine<>
+	if (!LoginResult.IsSet())
 	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
-
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+		co_return {};
+	}
+
+	if (LoginResult->HasError())
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		co_return { FLoginPipelineOutcome(MakeError(LoginResult->StealError())) };
+	}
+
+	FPlayFabLoginData Data;
+	Data.Login = LoginResult->StealValue();
 
-	if (!ClientAPI->GetUserData(Request, SuccessDelegate, ErrorDelegate))
+	const bool bHasEntity = Data.Login.EntityToken.IsValid() && Data.Login.EntityToken->Entity.IsValid();
+
+	if (!bHasEntity && EnumHasAnyFlags(Options.Fetch & Options.Required, EPlayFabLoginData::Inventory))
 	{
-		co_return {};
+		PlayFab::FPlayFabCppError Error;
+		Error.HttpCode = 200;
+		Error.ErrorName = TEXT("EntityTokenMissing");
+		Error.ErrorMessage = TEXT("The login returned no entity token, so the required inventory cannot be fetched");
+
+		co_return { FLoginPipelineOutcome(MakeError(MoveTemp(Error))) };
 	}
 
-	co_return { !co_await Race(OnGetUserData, OnError) ? FGetUserDataUnion(Response) : FGetUserDataUnion(Error) };
-}
+	if (Data.Login.InfoResultPayload.IsValid() && UE5CoroOSS::HasEncodedUserData(Data.Login.InfoResultPayload->UserData))
+	{
+		co_await Tasks::MoveToTask(TEXT("PlayFabDecodeUserData"));
 
-TCoroutine<TOptional<FTitleDataUnion>> UAsyncPlayFabClient::GetTitleData(PlayFab::ClientModels::FGetTitleDataRequest Request,
-	const FForceLatentCoroutine)
-{
-	PlayFab::ClientModels::FGetTitleDataResult Response;
-	PlayFab::FPlayFabCppError Error;
+		UE5CoroOSS::DecodeUserDataRecords(Data.Login.InfoResultPayload->UserData);
+
+		co_await Async::MoveToGameThread();
+	}
 
-	PlayFab::UPlayFabClientInstanceAPI::FGetTitleDataDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+	// Both calls are made as the player who logged in, and start before either is awaited, so they run side by side.
+	const TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext = GetAuthenticationContext(PlatformUserId);
 
-	const TCoroutine<> OnGetTitleData = []
-		(const FLatentLambda, PlayFab::UPlayFabClientInstanceAPI::FGetTitleDataDelegate& ThisSuccessDelegate,
-			PlayFab::ClientModels::FGetTitleDataResult& ThisResponse) -> TCoroutine<>
+	if (EnumHasAnyFlags(Options.Fetch, EPlayFabLoginData::Inventory) && bHasEntity)
 	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
-
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+		PlayFab::EconomyModels::FGetInventoryItemsRequest Request;
+		Request.Entity = MakeShared<PlayFab::EconomyModels::FEntityKey>();
+		Request.Entity->Id = Data.Login.EntityToken->Entity->Id;
+		Request.Entity->Type = Data.Login.EntityToken->Entity->Type;
+		Request.CollectionId = Options.InventoryCollectionId;
+		Request.AuthenticationContext = AuthenticationContext;
+
+		Data.Inventory.Emplace(Economy->GetInventoryItems(MoveTemp(Request)));
+	}
+
+	if (EnumHasAnyFlags(Options.Fetch, EPlayFabLoginData::TitlePlayers))
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsRequest Request;
+		Request.MasterPlayerAccountIds.Add(Data.Login.PlayFabId);
+		Request.AuthenticationContext = AuthenticationContext;
+
+		Data.TitlePlayers.Emplace(Profiles->GetTitlePlayersFromMasterPlayerAccountIds(Request));
+	}
 
-	if (!ClientAPI->GetTitleData(Request, SuccessDelegate, ErrorDelegate))
+	if (Data.Inventory.IsSet() && EnumHasAnyFlags(Options.Required, EPlayFabLoginData::Inventory))
 	{
-		co_return {};
+		co_await *Data.Inventory;
 	}
 
-	co_return { !co_await Race(OnGetTitleData, OnError) ? FTitleDataUnion(Response) : FTitleDataUnion(Error) };
+	if (Data.TitlePlayers.IsSet() && EnumHasAnyFlags(Options.Required, EPlayFabLoginData::TitlePlayers))
+	{
+		co_await *Data.TitlePlayers;
+	}
+
+	co_return { FLoginPipelineOutcome(MakeValue(MoveTemp(Data))) };
 }
 
-TCoroutine<TOptional<FTitleNewsUnion>> UAsyncPlayFabClient::GetTitleNews(PlayFab::ClientModels::FGetTitleNewsRequest Request,
-	const FForceLatentCoroutine)
+void UAsyncPlayFabClient::LoadTitleNewsCache()
 {
-	PlayFab::ClientModels::FGetTitleNewsResult Response;
-	PlayFab::FPlayFabCppError Error;
+	const FString TitleId = PlayFab::PlayFabSettings::GetTitleId();
+
+	if (TitleNewsTitleId.IsSet() && *TitleNewsTitleId == TitleId)
+	{
+		return;
+	}
+
+	TitleNewsCache.Save();
+
+	// Each title has its own feed, so switching titles never shows the news of another.
+	TitleNewsCache.Load(TitleId.IsEmpty() ? FString()
+		: FPaths::ProjectSavedDir() / TEXT("PlayFab") / TEXT("TitleNews") / (TitleId + TEXT(".bin")));
+
+	TitleNewsTitleId = TitleId;
+	TitleNewsRetryTime = 0.0;
+	FailedTitleNewsRefreshes = 0;
+}
+
+TCoroutine<bool> UAsyncPlayFabClient::SendTitleNewsRefresh(const FForceLatentCoroutine)
+{
+	LoadTitleNewsCache();
+
+	const FString TitleId = *TitleNewsTitleId;
+	const int32 MaxItems = FMath::Max(1, UE5CoroOSS::Private::TitleNewsMaxItems);
+	const int32 ProbeCount = FMath::Clamp(UE5CoroOSS::Private::TitleNewsProbeCount, 1, MaxItems);
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority(EPlayFabPriority::Background);
+
+	PlayFab::ClientModels::FGetTitleNewsRequest Request;
+	Request.Count = ProbeCount;
+
+	TOptional<FTitleNewsOutcome> Result = co_await Call(&PlayFab::UPlayFabClientAPI::GetTitleNews, Request, Priority);
+
+	if (Result.IsSet() && Result->HasValue() && ProbeCount < MaxItems && Result->GetValue().News.Num() >= ProbeCount
+		&& !Result->GetValue().News.ContainsByPredicate([this](const PlayFab::ClientModels::FTitleNewsItem& Item)
+		{
+			return TitleNewsCache.Contains(Item);
+		}))
+	{
+		// Nothing the probe returned is cached yet, so there may be more new items behind it.
+		Request.Count = MaxItems;
 
-	PlayFab::UPlayFabClientInstanceAPI::FGetTitleNewsDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+		Result = co_await Call(&PlayFab::UPlayFabClientAPI::GetTitleNews, Request, Priority);
+	}
 
-	const TCoroutine<> OnGetTitleNews = []
-		(const FLatentLambda, PlayFab::UPlayFabClientInstanceAPI::FGetTitleNewsDelegate& ThisSuccessDelegate,
-			PlayFab::ClientModels::FGetTitleNewsResult& ThisResponse) -> TCoroutine<>
+	if (TitleId != PlayFab::PlayFabSettings::GetTitleId())
 	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
-
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+		// The title changed while the feed was fetched, so the response belongs to a cache that is no longer loaded.
+		co_return false;
+	}
+
+	if (!Result.IsSet() || Result->HasError())
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		++FailedTitleNewsRefreshes;
+
+		const double Delay = FMath::Min(static_cast<double>(UE5CoroOSS::Private::TitleNewsRefreshInterval),
+			UE5CoroOSS::Private::TitleNewsRetryDelay * FMath::Pow(2.0, FMath::Min(FailedTitleNewsRefreshes - 1, 16)));
+		TitleNewsRetryTime = FPlatformTime::Seconds() + Delay;
+
+		UE_LOG(LogPlayFabClient, Warning, TEXT("Failed to refresh the title news, retrying in %.0fs: %s"), Delay,
+			Result.IsSet() ? *Result->GetError().GenerateErrorReport() : TEXT("request did not start"));
+
+		co_return false;
+	}
+
+	TitleNewsRetryTime = 0.0;
+	FailedTitleNewsRefreshes = 0;
 
-	if (!ClientAPI->GetTitleNews(Request, SuccessDelegate, ErrorDelegate))
+	const TArray<PlayFab::ClientModels::FTitleNewsItem>& News = Result->GetValue().News;
+
+	// Fewer items than asked for means the response holds the whole feed.
+	const bool bChanged = TitleNewsCache.Merge(News, News.Num() < Request.Count.mValue, MaxItems);
+
+	TitleNewsCache.MarkChecked();
+	TitleNewsCache.Save();
+
+	if (bChanged)
 	{
-		co_return {};
+		OnTitleNewsChanged.Broadcast();
 	}
 
-	co_return { !co_await Race(OnGetTitleNews, OnError) ? FTitleNewsUnion(Response) : FTitleNewsUnion(Error) };
+	co_return true;
 }
 
-TCoroutine<TOptional<FUpdateUserDataUnion>> UAsyncPlayFabClient::UpdateUserData(PlayFab::ClientModels::FUpdateUserDataRequest Request,
-	const FForceLatentCoroutine)
+TCoroutine<TOptional<FLoginOutcome>> UAsyncPlayFabClient::TrackLogin(TCoroutine<TOptional<FLoginOutcome>> Login,
+	const FPlatformUserId PlatformUserId, const FForceLatentCoroutine)
 {
-	PlayFab::ClientModels::FUpdateUserDataResult Response;
-	PlayFab::FPlayFabCppError Error;
+	TOptional<FLoginOutcome> Result = co_await Login;
 
-	PlayFab::UPlayFabClientInstanceAPI::FUpdateUserDataDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
-
-	const TCoroutine<> OnUpdateUserData = []
-		(const FLatentLambda, PlayFab::UPlayFabClientInstanceAPI::FUpdateUserDataDelegate& ThisSuccessDelegate,
-			PlayFab::ClientModels::FUpdateUserDataResult& ThisResponse) -> TCoroutine<>
-	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
-
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+	if (Result.IsSet() && Result->HasValue())
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		PlayFabIds.Add(PlatformUserId, Result->GetValue().PlayFabId);
+	}
 
-	if (!ClientAPI->UpdateUserData(Request, SuccessDelegate, ErrorDelegate))
+	if (Result.IsSet() && Result->HasValue() && Result->GetValue().EntityToken.IsValid()
+		&& Result->GetValue().EntityToken->TokenExpiration.notNull())
 	{
-		co_return {};
+		Authentication->TrackEntityToken(Result->GetValue().EntityToken->TokenExpiration.mValue,
+			GetAuthenticationContext(PlatformUserId));
 	}
 
-	co_return { !co_await Race(OnUpdateUserData, OnError) ? FUpdateUserDataUnion(Response) : FUpdateUserDataUnion(Error) };
+	co_return Result;
 }
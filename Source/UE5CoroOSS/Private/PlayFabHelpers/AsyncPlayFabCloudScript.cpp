@@ -2,6 +2,310 @@
 
 #include "PlayFabHelpers/AsyncPlayFabCloudScript.h"
 #include "PlayFab.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeExit.h"
+#include "PlayFabHelpers/PlayFabStructJson.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UE5CoroOSS_Shared.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Warm Function Calls"), STAT_PlayFabWarmFunctionCalls, STATGROUP_UE5CoroOSSPlayFab);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cold Function Calls"), STAT_PlayFabColdFunctionCalls, STATGROUP_UE5CoroOSSPlayFab);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Function Warm-Ups"), STAT_PlayFabFunctionWarmUps, STATGROUP_UE5CoroOSSPlayFab);
+
+DEFINE_LOG_CATEGORY_STATIC(LogPlayFabCloudScript, Log, All);
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		float MultiplexWindow = 0.05f;
+		FAutoConsoleVariableRef CVarMultiplexWindow(
+			TEXT("oss.playfab.multiplexwindow"),
+			MultiplexWindow,
+			TEXT("Seconds to collect queued CloudScript function calls before sending them together."));
+
+		FString MultiplexFunction;
+		FAutoConsoleVariableRef CVarMultiplexFunction(
+			TEXT("oss.playfab.multiplexfunction"),
+			MultiplexFunction,
+			TEXT("Azure Function that dispatches multiplexed CloudScript calls. Queued calls are sent directly while empty."));
+
+		int32 MultiplexMaxCalls = 16;
+		FAutoConsoleVariableRef CVarMultiplexMaxCalls(
+			TEXT("oss.playfab.multiplexmaxcalls"),
+			MultiplexMaxCalls,
+			TEXT("Maximum number of CloudScript function calls sent in one multiplexed ExecuteFunction."));
+
+		float WarmJitter = 0.2f;
+		FAutoConsoleVariableRef CVarWarmJitter(
+			TEXT("oss.playfab.warmjitter"),
+			WarmJitter,
+			TEXT("Fraction of a function's keep-warm interval by which each warm-up is randomly moved, so clients do not ping in step."));
+
+		float ColdStartThreshold = 1.0f;
+		FAutoConsoleVariableRef CVarColdStartThreshold(
+			TEXT("oss.playfab.coldstartthreshold"),
+			ColdStartThreshold,
+			TEXT("Seconds after which a call to a registered CloudScript function is counted as having hit a cold instance."));
+
+		PlayFab::FPlayFabCppError MakeFunctionError(const TSharedPtr<FJsonObject>& ErrorObject)
+		{
+			PlayFab::FPlayFabCppError Error;
+			Error.HttpCode = 200;
+			ErrorObject->TryGetStringField(TEXT("Error"), Error.ErrorName);
+			ErrorObject->TryGetStringField(TEXT("Message"), Error.ErrorMessage);
+
+			return Error;
+		}
+
+		/** ExecuteFunction request with the parameter as plain JSON, which the SDK model can not hold. */
+		struct FExecuteFunctionJsonRequest
+		{
+			TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext;
+
+			FString FunctionName;
+
+			TSharedPtr<FJsonValue> FunctionParameter;
+
+			FString toJSONString() const
+			{
+				const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+				Root->SetStringField(TEXT("FunctionName"), FunctionName);
+				Root->SetField(TEXT("FunctionParameter"), FunctionParameter.IsValid() ? FunctionParameter : MakeShared<FJsonValueNull>());
+
+				FString Body;
+				FJsonSerializer::Serialize(Root, TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Body));
+
+				return Body;
+			}
+		};
+
+		/** ExecuteFunction result keeping the function result as plain JSON. */
+		struct FExecuteFunctionJsonResult
+		{
+			TSharedPtr<FJsonValue> FunctionResult;
+
+			TSharedPtr<FJsonObject> Error;
+
+			bool FunctionResultTooLarge = false;
+
+			bool readFromValue(const TSharedPtr<FJsonObject>& Data)
+			{
+				FunctionResult = Data->TryGetField(TEXT("FunctionResult"));
+
+				if (const TSharedPtr<FJsonObject>* FunctionError; Data->TryGetObjectField(TEXT("Error"), FunctionError))
+				{
+					Error = *FunctionError;
+				}
+
+				Data->TryGetBoolField(TEXT("FunctionResultTooLarge"), FunctionResultTooLarge);
+
+				return true;
+			}
+		};
+
+		/**
+		 * Execute a function with a JSON parameter, through the shared PlayFab transport. SentTime receives the time the
+		 * request left the scheduler, which function latency is measured from.
+		 */
+		TCoroutine<TOptional<FFunctionResultOutcome>> ExecuteFunctionJson(FString FunctionName, TSharedPtr<FJsonValue> Parameter,
+			TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext, const EPlayFabPriority Priority,
+			TSharedPtr<double> SentTime)
+		{
+			FExecuteFunctionJsonRequest Request;
+			Request.AuthenticationContext = MoveTemp(AuthenticationContext);
+			Request.FunctionName = MoveTemp(FunctionName);
+			Request.FunctionParameter = MoveTemp(Parameter);
+
+			TOptional<TPlayFabOutcome<FExecuteFunctionJsonResult>> Result = co_await CallPlayFabOffGameThread<FExecuteFunctionJsonResult>(
+				TEXT("/CloudScript/ExecuteFunction"), EPlayFabAuthHeader::EntityToken, MoveTemp(Request), Priority, MoveTemp(SentTime));
+
+			if (!Result.IsSet())
+			{
+				co_return {};
+			}
+
+			if (Result->HasError())
+			{
+				co_return { FFunctionResultOutcome(MakeError(Result->StealError())) };
+			}
+
+			const FExecuteFunctionJsonResult& Response = Result->GetValue();
+
+			if (Response.Error.IsValid())
+			{
+				co_return { FFunctionResultOutcome(MakeError(MakeFunctionError(Response.Error))) };
+			}
+
+			if (Response.FunctionResultTooLarge)
+			{
+				PlayFab::FPlayFabCppError Error;
+				Error.HttpCode = 200;
+				Error.ErrorName = TEXT("FunctionResultTooLarge");
+				Error.ErrorMessage = TEXT("The function result was too large to be returned");
+
+				co_return { FFunctionResultOutcome(MakeError(MoveTemp(Error))) };
+			}
+
+			co_return { FFunctionResultOutcome(MakeValue(Response.FunctionResult.IsValid() ? Response.FunctionResult
+				: MakeShared<FJsonValueNull>())) };
+		}
+
+		FString MakeExecuteFunctionBody(const FString& FunctionName, const UScriptStruct* ParameterStruct, const void* Parameter)
+		{
+			FString Body;
+
+			const TSharedRef<FCondensedJsonWriter> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Body);
+			Writer->WriteObjectStart();
+			Writer->WriteValue(TEXT("FunctionName"), FunctionName);
+			Writer->WriteIdentifierPrefix(TEXT("FunctionParameter"));
+			WriteStructJson(*Writer, ParameterStruct, Parameter);
+			Writer->WriteObjectEnd();
+			Writer->Close();
+
+			return Body;
+		}
+
+		bool ReadFunctionError(TJsonReader<>& Reader, PlayFab::FPlayFabCppError& OutError)
+		{
+			EJsonNotation Notation = EJsonNotation::Error;
+			while (Reader.ReadNext(Notation) && Notation != EJsonNotation::ObjectEnd)
+			{
+				if (Reader.GetIdentifier() == TEXT("Error") && Notation == EJsonNotation::String)
+				{
+					OutError.ErrorName = Reader.GetValueAsString();
+				}
+				else if (Reader.GetIdentifier() == TEXT("Message") && Notation == EJsonNotation::String)
+				{
+					OutError.ErrorMessage = Reader.GetValueAsString();
+				}
+				else if (!SkipJsonValue(Reader, Notation))
+				{
+					return false;
+				}
+			}
+
+			return Notation == EJsonNotation::ObjectEnd;
+		}
+
+		bool ReadFunctionData(TJsonReader<>& Reader, const UScriptStruct* ResultStruct, void* OutResult,
+			PlayFab::FPlayFabCppError& OutError, bool& bOutFunctionFailed)
+		{
+			EJsonNotation Notation = EJsonNotation::Error;
+			while (Reader.ReadNext(Notation) && Notation != EJsonNotation::ObjectEnd)
+			{
+				bool bValid = true;
+
+				if (Reader.GetIdentifier() == TEXT("FunctionResult"))
+				{
+					bValid = ReadStructJson(Reader, Notation, ResultStruct, OutResult);
+				}
+				else if (Reader.GetIdentifier() == TEXT("FunctionResultTooLarge") && Notation == EJsonNotation::Boolean)
+				{
+					if (Reader.GetValueAsBoolean())
+					{
+						bOutFunctionFailed = true;
+						OutError.ErrorName = TEXT("FunctionResultTooLarge");
+						OutError.ErrorMessage = TEXT("The function result was too large to be returned");
+					}
+				}
+				else if (Reader.GetIdentifier() == TEXT("Error") && Notation == EJsonNotation::ObjectStart)
+				{
+					bOutFunctionFailed = true;
+					bValid = ReadFunctionError(Reader, OutError);
+				}
+				else
+				{
+					bValid = SkipJsonValue(Reader, Notation);
+				}
+
+				if (!bValid)
+				{
+					return false;
+				}
+			}
+
+			return Notation == EJsonNotation::ObjectEnd;
+		}
+
+		/** Streams the ExecuteFunction envelope, reading FunctionResult straight into OutResult. */
+		bool ReadExecuteFunctionResponse(const FHttpResponsePtr& HttpResponse, const bool bSucceeded,
+			const UScriptStruct* ResultStruct, void* OutResult, PlayFab::FPlayFabCppError& OutError)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_PlayFabParseResponse);
+			TRACE_CPUPROFILER_EVENT_SCOPE(UE5CoroOSS::ReadExecuteFunctionResponse);
+
+			if (!bSucceeded || !HttpResponse.IsValid())
+			{
+				OutError.HttpCode = 0;
+				OutError.HttpStatus = TEXT("Failed to contact server");
+				OutError.ErrorName = TEXT("ServiceUnavailable");
+				OutError.ErrorMessage = TEXT("Failed to contact server");
+				return false;
+			}
+
+			INC_DWORD_STAT_BY(STAT_PlayFabParsedBytes, HttpResponse->GetContentLength());
+			if (!IsInGameThread())
+			{
+				INC_DWORD_STAT(STAT_PlayFabParsedOffGameThread);
+			}
+
+			OutError.HttpCode = HttpResponse->GetResponseCode();
+
+			bool bFunctionFailed = false;
+
+			const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(HttpResponse->GetContentAsString());
+
+			EJsonNotation Notation = EJsonNotation::Error;
+			bool bValid = Reader->ReadNext(Notation) && Notation == EJsonNotation::ObjectStart;
+
+			while (bValid && Reader->ReadNext(Notation) && Notation != EJsonNotation::ObjectEnd)
+			{
+				const FString& Identifier = Reader->GetIdentifier();
+
+				if (Identifier == TEXT("code") && Notation == EJsonNotation::Number)
+				{
+					OutError.HttpCode = static_cast<int32>(Reader->GetValueAsNumber());
+				}
+				else if (Identifier == TEXT("status") && Notation == EJsonNotation::String)
+				{
+					OutError.HttpStatus = Reader->GetValueAsString();
+				}
+				else if (Identifier == TEXT("error") && Notation == EJsonNotation::String)
+				{
+					OutError.ErrorName = Reader->GetValueAsString();
+				}
+				else if (Identifier == TEXT("errorCode") && Notation == EJsonNotation::Number)
+				{
+					OutError.ErrorCode = static_cast<int32>(Reader->GetValueAsNumber());
+				}
+				else if (Identifier == TEXT("errorMessage") && Notation == EJsonNotation::String)
+				{
+					OutError.ErrorMessage = Reader->GetValueAsString();
+				}
+				else if (Identifier == TEXT("data") && Notation == EJsonNotation::ObjectStart)
+				{
+					bValid = ReadFunctionData(*Reader, ResultStruct, OutResult, OutError, bFunctionFailed);
+				}
+				else
+				{
+					bValid = SkipJsonValue(*Reader, Notation);
+				}
+			}
+
+			if (!bValid || Notation != EJsonNotation::ObjectEnd)
+			{
+				OutError.ErrorName = TEXT("JsonParseError");
+				OutError.ErrorMessage = TEXT("The response could not be parsed as JSON");
+				return false;
+			}
+
+			return OutError.HttpCode == 200 && !bFunctionFailed;
+		}
+	} // namespace Private
+} // namespace UE5CoroOSS
 
 UAsyncPlayFabCloudScript::UAsyncPlayFabCloudScript() = default;
 
@@ -10,78 +314,437 @@ void UAsyncPlayFabCloudScript::Initialize(FSubsystemCollectionBase& Collection)
 	Super::Initialize(Collection);
 
 	CloudScriptAPI = IPlayFabModuleInterface::Get().GetCloudScriptAPI();
+	Authentication = Collection.InitializeDependency<UAsyncPlayFabAuthentication>();
+}
+
+void UAsyncPlayFabCloudScript::Deinitialize()
+{
+	if (FunctionFlush.IsSet())
+	{
+		FunctionFlush->Cancel();
+		FunctionFlush.Reset();
+	}
+
+	// Keep-warm loops stop once their function is no longer registered.
+	WarmFunctions.Empty();
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
+	Super::Deinitialize();
 }
 
 UAsyncPlayFabCloudScript* UAsyncPlayFabCloudScript::Get(const UObject* WorldContext)
 {
-	return WorldContext->GetWorld()->GetGameInstance()->GetSubsystem<UAsyncPlayFabCloudScript>();
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncPlayFabCloudScript>(WorldContext);
 }
 
-TCoroutine<TOptional<FExecuteCloudScriptUnion>> UAsyncPlayFabCloudScript::ExecuteCloudScript(
-	PlayFab::CloudScriptModels::FExecuteEntityCloudScriptRequest Request, const FForceLatentCoroutine)
+TCoroutine<TOptional<FExecuteCloudScriptOutcome>> UAsyncPlayFabCloudScript::ExecuteCloudScript(
+	PlayFab::CloudScriptModels::FExecuteEntityCloudScriptRequest Request)
 {
-	PlayFab::CloudScriptModels::FExecuteCloudScriptResult Result;
-	PlayFab::FPlayFabCppError Error;
+	return Call(&PlayFab::UPlayFabCloudScriptAPI::ExecuteEntityCloudScript, MoveTemp(Request));
+}
 
-	PlayFab::UPlayFabCloudScriptAPI::FExecuteEntityCloudScriptDelegate Success;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+TCoroutine<TOptional<FExecuteFunctionOutcome>> UAsyncPlayFabCloudScript::ExecuteFunction(
+	PlayFab::CloudScriptModels::FExecuteFunctionRequest Request, const FForceLatentCoroutine)
+{
+	const FString FunctionName = Request.FunctionName;
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority();
 
-	const TCoroutine<> OnExecuteCloudScript = []
-		(const FLatentLambda, PlayFab::UPlayFabCloudScriptAPI::FExecuteEntityCloudScriptDelegate& ThisSuccess,
-			PlayFab::CloudScriptModels::FExecuteCloudScriptResult& ThisResult) -> TCoroutine<>
+	if (!co_await Authentication->WaitForEntityToken(Request.AuthenticationContext))
 	{
-		auto [InnerResult] = co_await ThisSuccess;
-		
-		ThisResult = InnerResult;
-	}(FLambdaParam(this), Success, Result);
+		co_return { FExecuteFunctionOutcome(MakeError(UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError())) };
+	}
 
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate, PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+	// Timed from when the request leaves the scheduler, so time spent queued is not counted as a cold start.
+	const TSharedRef<double> SentTime = MakeShared<double>(FPlatformTime::Seconds());
+
+	TOptional<FExecuteFunctionOutcome> Result = co_await (UE5CoroOSS::IsOffGameThreadParseEnabled()
+		? UE5CoroOSS::CallPlayFabOffGameThread<PlayFab::CloudScriptModels::FExecuteFunctionResult>(TEXT("/CloudScript/ExecuteFunction"),
+			EPlayFabAuthHeader::EntityToken, MoveTemp(Request), Priority, SentTime)
+		: UE5CoroOSS::CallPlayFab(CloudScriptAPI, &PlayFab::UPlayFabCloudScriptAPI::ExecuteFunction, MoveTemp(Request), Priority,
+			SentTime));
+
+	if (Result.IsSet())
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		RecordFunctionCall(FunctionName, FPlatformTime::Seconds() - *SentTime);
+	}
 
-	if (!CloudScriptAPI->ExecuteEntityCloudScript(Request, Success, ErrorDelegate))
+	co_return Result;
+}
+
+TCoroutine<TOptional<TPlayFabOutcome<TSharedRef<FStructOnScope>>>> UAsyncPlayFabCloudScript::ExecuteFunction(FString FunctionName,
+	const UScriptStruct* ParameterStruct, const void* Parameter, const UScriptStruct* ResultStruct,
+	TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext, const FForceLatentCoroutine)
+{
+	FString Body = UE5CoroOSS::Private::MakeExecuteFunctionBody(FunctionName, ParameterStruct, Parameter);
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority();
+
+	if (!co_await Authentication->WaitForEntityToken(AuthenticationContext))
+	{
+		co_return { TPlayFabOutcome<TSharedRef<FStructOnScope>>(MakeError(UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError())) };
+	}
+
+	const TSharedRef<FStructOnScope> Result = MakeShared<FStructOnScope>(ResultStruct);
+
+	const TSharedRef<double> SentTime = MakeShared<double>(FPlatformTime::Seconds());
+
+	const TOptional<TTuple<FHttpResponsePtr, bool>> Sent = co_await UE5CoroOSS::Private::SendPlayFabRequest(
+		TEXT("/CloudScript/ExecuteFunction"), EPlayFabAuthHeader::EntityToken, MoveTemp(AuthenticationContext), MoveTemp(Body), Priority,
+		SentTime);
+
+	if (!Sent.IsSet())
 	{
 		co_return {};
 	}
 
-	co_return { !co_await Race(OnExecuteCloudScript, OnError) ? FExecuteCloudScriptUnion(Result) : FExecuteCloudScriptUnion(Error) };
+	const double Latency = FPlatformTime::Seconds() - *SentTime;
+
+	const auto& [HttpResponse, bSucceeded] = *Sent;
+
+	const bool bOnWorker = UE5CoroOSS::Private::ShouldParseOnWorker(HttpResponse);
+	if (bOnWorker)
+	{
+		co_await Tasks::MoveToTask(TEXT("PlayFabParseFunctionResult"));
+	}
+
+	PlayFab::FPlayFabCppError Error;
+	const bool bSuccess = UE5CoroOSS::Private::ReadExecuteFunctionResponse(HttpResponse, bSucceeded, ResultStruct,
+		Result->GetStructMemory(), Error);
+
+	if (bOnWorker)
+	{
+		co_await Async::MoveToGameThread();
+	}
+
+	RecordFunctionCall(FunctionName, Latency);
+
+	if (!bSuccess)
+	{
+		co_return { TPlayFabOutcome<TSharedRef<FStructOnScope>>(MakeError(MoveTemp(Error))) };
+	}
+
+	co_return { TPlayFabOutcome<TSharedRef<FStructOnScope>>(MakeValue(Result)) };
 }
 
-TCoroutine<TOptional<FExecuteFunctionUnion>> UAsyncPlayFabCloudScript::ExecuteFunction(PlayFab::CloudScriptModels::FExecuteFunctionRequest Request,
-	const FForceLatentCoroutine)
+TCoroutine<TOptional<FFunctionResultOutcome>> UAsyncPlayFabCloudScript::QueueFunction(FString FunctionName,
+	TSharedPtr<FJsonValue> Parameter, TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext, const FForceLatentCoroutine)
 {
-	PlayFab::CloudScriptModels::FExecuteFunctionResult Result;
-	PlayFab::FPlayFabCppError Error;
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority();
+
+	if (UE5CoroOSS::Private::MultiplexFunction.IsEmpty())
+	{
+		if (!co_await Authentication->WaitForEntityToken(AuthenticationContext))
+		{
+			co_return { FFunctionResultOutcome(MakeError(UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError())) };
+		}
 
-	PlayFab::UPlayFabCloudScriptAPI::FExecuteFunctionDelegate Success;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+		const TSharedRef<double> SentTime = MakeShared<double>(FPlatformTime::Seconds());
 
-	const TCoroutine<> OnExecuteFunction = []
-		(const FLatentLambda, PlayFab::UPlayFabCloudScriptAPI::FExecuteFunctionDelegate& ThisSuccess,
-			PlayFab::CloudScriptModels::FExecuteFunctionResult& ThisResult) -> TCoroutine<>
+		TOptional<FFunctionResultOutcome> Result = co_await UE5CoroOSS::Private::ExecuteFunctionJson(FunctionName, MoveTemp(Parameter),
+			MoveTemp(AuthenticationContext), Priority, SentTime);
+		if (Result.IsSet())
+		{
+			RecordFunctionCall(FunctionName, FPlatformTime::Seconds() - *SentTime);
+		}
+
+		co_return Result;
+	}
+
+	const TSharedRef<FQueuedFunctionCall> Queued = MakeShared<FQueuedFunctionCall>();
+	Queued->FunctionName = MoveTemp(FunctionName);
+	Queued->Parameter = MoveTemp(Parameter);
+	Queued->AuthenticationContext = MoveTemp(AuthenticationContext);
+	Queued->Priority = Priority;
+
+	QueuedFunctionCalls.Add(Queued);
+
+	if (QueuedFunctionCalls.Num() >= FMath::Max(1, UE5CoroOSS::Private::MultiplexMaxCalls))
 	{
-		auto [InnerResult] = co_await ThisSuccess;
-		
-		ThisResult = InnerResult;
-	}(FLambdaParam(this), Success, Result);
+		// The window of the calls just sent is over, the next queued call starts a new one.
+		if (FunctionFlush.IsSet())
+		{
+			FunctionFlush->Cancel();
+			FunctionFlush.Reset();
+		}
 
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate, PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+		DispatchQueuedFunctionCalls();
+	}
+	else if (!FunctionFlush.IsSet())
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		FunctionFlush.Emplace(FlushFunctionQueue());
+	}
 
-	if (!CloudScriptAPI->ExecuteFunction(Request, Success, ErrorDelegate))
+	co_await Latent::Until([Queued]
 	{
-		co_return {};
+		return Queued->bDone;
+	});
+
+	co_return MoveTemp(Queued->Result);
+}
+
+TCoroutine<> UAsyncPlayFabCloudScript::FlushFunctionQueue(const FForceLatentCoroutine)
+{
+	co_await Latent::RealSeconds(FMath::Max(0.0f, UE5CoroOSS::Private::MultiplexWindow));
+
+	FunctionFlush.Reset();
+
+	DispatchQueuedFunctionCalls();
+}
+
+void UAsyncPlayFabCloudScript::DispatchQueuedFunctionCalls()
+{
+	// Calls made as different players can not share a dispatcher call.
+	TMap<TSharedPtr<UPlayFabAuthenticationContext>, TArray<TSharedRef<FQueuedFunctionCall>>> Batches;
+
+	for (const TSharedRef<FQueuedFunctionCall>& Queued : QueuedFunctionCalls)
+	{
+		Batches.FindOrAdd(Queued->AuthenticationContext).Add(Queued);
+	}
+
+	QueuedFunctionCalls.Reset();
+
+	for (TPair<TSharedPtr<UPlayFabAuthenticationContext>, TArray<TSharedRef<FQueuedFunctionCall>>>& Batch : Batches)
+	{
+		DispatchFunctionCalls(MoveTemp(Batch.Value));
+	}
+}
+
+TCoroutine<> UAsyncPlayFabCloudScript::DispatchFunctionCalls(TArray<TSharedRef<FQueuedFunctionCall>> Batch, const FForceLatentCoroutine)
+{
+	ON_SCOPE_EXIT
+	{
+		for (const TSharedRef<FQueuedFunctionCall>& Queued : Batch)
+		{
+			Queued->bDone = true;
+		}
+	};
+
+	// The batch goes out as urgently as its most urgent call.
+	EPlayFabPriority Priority = EPlayFabPriority::Background;
+	for (const TSharedRef<FQueuedFunctionCall>& Queued : Batch)
+	{
+		Priority = FMath::Min(Priority, Queued->Priority);
+	}
+
+	if (!co_await Authentication->WaitForEntityToken(Batch[0]->AuthenticationContext))
+	{
+		for (const TSharedRef<FQueuedFunctionCall>& Queued : Batch)
+		{
+			Queued->Result.Emplace(MakeError(UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError()));
+		}
+
+		co_return;
+	}
+
+	const TSharedRef<double> SentTime = MakeShared<double>(FPlatformTime::Seconds());
+
+	if (Batch.Num() == 1)
+	{
+		Batch[0]->Result = co_await UE5CoroOSS::Private::ExecuteFunctionJson(Batch[0]->FunctionName, Batch[0]->Parameter,
+			Batch[0]->AuthenticationContext, Priority, SentTime);
+		if (Batch[0]->Result.IsSet())
+		{
+			RecordFunctionCall(Batch[0]->FunctionName, FPlatformTime::Seconds() - *SentTime);
+		}
+
+		co_return;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> Calls;
+	Calls.Reserve(Batch.Num());
+
+	for (const TSharedRef<FQueuedFunctionCall>& Queued : Batch)
+	{
+		const TSharedRef<FJsonObject> FunctionCall = MakeShared<FJsonObject>();
+		FunctionCall->SetStringField(TEXT("FunctionName"), Queued->FunctionName);
+		FunctionCall->SetField(TEXT("FunctionParameter"), Queued->Parameter.IsValid() ? Queued->Parameter : MakeShared<FJsonValueNull>());
+
+		Calls.Add(MakeShared<FJsonValueObject>(FunctionCall));
+	}
+
+	const TSharedRef<FJsonObject> Parameter = MakeShared<FJsonObject>();
+	Parameter->SetArrayField(TEXT("Calls"), Calls);
+
+	const TOptional<FFunctionResultOutcome> Result = co_await UE5CoroOSS::Private::ExecuteFunctionJson(
+		UE5CoroOSS::Private::MultiplexFunction, MakeShared<FJsonValueObject>(Parameter), Batch[0]->AuthenticationContext, Priority,
+		SentTime);
+
+	if (!Result.IsSet())
+	{
+		co_return;
+	}
+
+	const double RoundTrip = FPlatformTime::Seconds() - *SentTime;
+
+	RecordFunctionCall(UE5CoroOSS::Private::MultiplexFunction, RoundTrip);
+
+	if (Result->HasError())
+	{
+		for (const TSharedRef<FQueuedFunctionCall>& Queued : Batch)
+		{
+			Queued->Result.Emplace(MakeError(Result->GetError()));
+		}
+
+		co_return;
+	}
+
+	const TSharedPtr<FJsonObject>* DispatchResult = nullptr;
+	const TArray<TSharedPtr<FJsonValue>>* Results = nullptr;
+
+	if (Result->GetValue()->TryGetObject(DispatchResult))
+	{
+		(*DispatchResult)->TryGetArrayField(TEXT("Results"), Results);
+	}
+
+	for (int32 Index = 0; Index < Batch.Num(); ++Index)
+	{
+		const TSharedPtr<FJsonObject>* Entry = nullptr;
+
+		if (!Results || !Results->IsValidIndex(Index) || !(*Results)[Index]->TryGetObject(Entry))
+		{
+			PlayFab::FPlayFabCppError Error;
+			Error.HttpCode = 200;
+			Error.ErrorName = TEXT("MultiplexResultMissing");
+			Error.ErrorMessage = FString::Printf(TEXT("%s returned no result for call %d"), *UE5CoroOSS::Private::MultiplexFunction, Index);
+
+			Batch[Index]->Result.Emplace(MakeError(MoveTemp(Error)));
+			continue;
+		}
+
+		// Each call is timed by the dispatcher if it reports it, so one cold function does not mark its whole batch cold.
+		double DurationMs = 0.0;
+		RecordFunctionCall(Batch[Index]->FunctionName, (*Entry)->TryGetNumberField(TEXT("DurationMs"), DurationMs)
+			? DurationMs / 1000.0 : RoundTrip);
+
+		if (const TSharedPtr<FJsonObject>* CallError; (*Entry)->TryGetObjectField(TEXT("Error"), CallError))
+		{
+			Batch[Index]->Result.Emplace(MakeError(UE5CoroOSS::Private::MakeFunctionError(*CallError)));
+			continue;
+		}
+
+		const TSharedPtr<FJsonValue> CallResult = (*Entry)->TryGetField(TEXT("Result"));
+		Batch[Index]->Result.Emplace(MakeValue(CallResult.IsValid() ? CallResult : MakeShared<FJsonValueNull>()));
 	}
+}
+
+void UAsyncPlayFabCloudScript::RegisterWarmFunction(FString FunctionName, const float KeepWarmInterval, TSharedPtr<FJsonValue> WarmUpParameter)
+{
+	if (!WarmUpParameter.IsValid())
+	{
+		const TSharedRef<FJsonObject> DefaultParameter = MakeShared<FJsonObject>();
+		DefaultParameter->SetBoolField(TEXT("WarmUp"), true);
+
+		WarmUpParameter = MakeShared<FJsonValueObject>(DefaultParameter);
+	}
+
+	FWarmFunction& WarmFunction = WarmFunctions.FindOrAdd(FunctionName);
+	WarmFunction.WarmUpParameter = MoveTemp(WarmUpParameter);
+	WarmFunction.KeepWarmInterval = KeepWarmInterval;
+	WarmFunction.Generation = ++WarmFunctionGeneration;
+
+	if (KeepWarmInterval > 0.0f)
+	{
+		KeepFunctionWarm(MoveTemp(FunctionName), WarmFunction.Generation);
+	}
+}
+
+void UAsyncPlayFabCloudScript::UnregisterWarmFunction(const FString& FunctionName)
+{
+	WarmFunctions.Remove(FunctionName);
+}
+
+void UAsyncPlayFabCloudScript::WarmUpFunctions()
+{
+	for (const TPair<FString, FWarmFunction>& WarmFunction : WarmFunctions)
+	{
+		WarmUpFunction(WarmFunction.Key);
+	}
+}
+
+const UAsyncPlayFabCloudScript::FFunctionWarmth* UAsyncPlayFabCloudScript::GetFunctionWarmth(const FString& FunctionName) const
+{
+	const FWarmFunction* WarmFunction = WarmFunctions.Find(FunctionName);
+
+	return WarmFunction ? &WarmFunction->Warmth : nullptr;
+}
+
+TCoroutine<> UAsyncPlayFabCloudScript::KeepFunctionWarm(FString FunctionName, const uint32 Generation, const FForceLatentCoroutine)
+{
+	while (true)
+	{
+		// Looked up again every time around, as the map may have changed while suspended.
+		const FWarmFunction* WarmFunction = WarmFunctions.Find(FunctionName);
+		if (!WarmFunction || WarmFunction->Generation != Generation)
+		{
+			co_return;
+		}
+
+		const float Jitter = FMath::Clamp(UE5CoroOSS::Private::WarmJitter, 0.0f, 1.0f);
+		const double Interval = WarmFunction->KeepWarmInterval * (1.0f + FMath::FRandRange(-Jitter, Jitter));
+		const double Idle = FPlatformTime::Seconds() - WarmFunction->LastInvokeTime;
 
-	co_return { !co_await Race(OnExecuteFunction, OnError) ? FExecuteFunctionUnion(Result) : FExecuteFunctionUnion(Error) };
+		if (Idle < Interval)
+		{
+			// Real calls keep the instance warm too, so only ping once the function has actually been idle.
+			co_await Latent::RealSeconds(Interval - Idle);
+			continue;
+		}
+
+		co_await WarmUpFunction(FunctionName);
+	}
 }
 
+TCoroutine<> UAsyncPlayFabCloudScript::WarmUpFunction(FString FunctionName)
+{
+	FWarmFunction* WarmFunction = WarmFunctions.Find(FunctionName);
+	if (!WarmFunction)
+	{
+		co_return;
+	}
+
+	WarmFunction->LastInvokeTime = FPlatformTime::Seconds();
+	++WarmFunction->Warmth.WarmUpCalls;
+	INC_DWORD_STAT(STAT_PlayFabFunctionWarmUps);
+
+	TSharedPtr<FJsonValue> WarmUpParameter = WarmFunction->WarmUpParameter;
+
+	// Nothing to warm up as a player whose session is gone.
+	if (!co_await Authentication->WaitForEntityToken())
+	{
+		co_return;
+	}
+
+	const TOptional<FFunctionResultOutcome> Result = co_await UE5CoroOSS::Private::ExecuteFunctionJson(FunctionName,
+		MoveTemp(WarmUpParameter), nullptr, EPlayFabPriority::Background, nullptr);
+
+	if (!Result.IsSet() || Result->HasError())
+	{
+		UE_LOG(LogPlayFabCloudScript, Verbose, TEXT("Warm-up of %s failed: %s"), *FunctionName,
+			Result.IsSet() ? *Result->GetError().GenerateErrorReport() : TEXT("request did not start"));
+	}
+}
+
+void UAsyncPlayFabCloudScript::RecordFunctionCall(const FString& FunctionName, const double Latency)
+{
+	FWarmFunction* WarmFunction = WarmFunctions.Find(FunctionName);
+	if (!WarmFunction)
+	{
+		return;
+	}
+
+	WarmFunction->LastInvokeTime = FPlatformTime::Seconds();
+	WarmFunction->Warmth.LastLatency = Latency;
+
+	if (WarmFunction->Warmth.LastLatency > UE5CoroOSS::Private::ColdStartThreshold)
+	{
+		++WarmFunction->Warmth.ColdCalls;
+		INC_DWORD_STAT(STAT_PlayFabColdFunctionCalls);
+
+		UE_LOG(LogPlayFabCloudScript, Log, TEXT("%s took %.2fs, likely a cold start"), *FunctionName, WarmFunction->Warmth.LastLatency);
+	}
+	else
+	{
+		++WarmFunction->Warmth.WarmCalls;
+		INC_DWORD_STAT(STAT_PlayFabWarmFunctionCalls);
+	}
+}
@@ -1,8 +1,63 @@
 ﻿// Copyright No Bright Shadows. All Rights Reserved.
 
 #include "PlayFabHelpers/AsyncPlayFabEconomy.h"
-#include "Core/PlayFabEconomyInstanceAPI.h"
 #include "PlayFab.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "Misc/SecureHash.h"
+#include "UE5CoroOSS_Shared.h"
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		int32 MaxPurchasesInFlight = 2;
+		FAutoConsoleVariableRef CVarMaxPurchasesInFlight(
+			TEXT("oss.playfab.maxpurchasesinflight"),
+			MaxPurchasesInFlight,
+			TEXT("Maximum number of queued purchase transactions sent at once."));
+
+		int32 MaxInventoryOperations = 10;
+		FAutoConsoleVariableRef CVarMaxInventoryOperations(
+			TEXT("oss.playfab.maxinventoryoperations"),
+			MaxInventoryOperations,
+			TEXT("Maximum number of queued purchases combined into one ExecuteInventoryOperations transaction."));
+
+		int32 MaxPurchaseRetries = 3;
+		FAutoConsoleVariableRef CVarMaxPurchaseRetries(
+			TEXT("oss.playfab.maxpurchaseretries"),
+			MaxPurchaseRetries,
+			TEXT("Number of times a queued purchase is retried after a transient failure."));
+
+		float CatalogCacheSaveDelay = 5.f;
+		FAutoConsoleVariableRef CVarCatalogCacheSaveDelay(
+			TEXT("oss.playfab.catalogcachesavedelay"),
+			CatalogCacheSaveDelay,
+			TEXT("Seconds to wait after a catalog item changes before writing the catalog cache, so bursts of changes are written once."));
+
+		bool IsTransientPurchaseError(const PlayFab::FPlayFabCppError& Error)
+		{
+			return Error.HttpCode == 0 || Error.HttpCode == 429 || Error.HttpCode >= 500;
+		}
+
+		template <typename TResponse>
+		bool ShouldRetryPurchase(const TOptional<TPlayFabOutcome<TResponse>>& Result, const int32 Attempt)
+		{
+			if (!Result.IsSet() || Attempt >= MaxPurchaseRetries || !Result->HasError())
+			{
+				return false;
+			}
+
+			return IsTransientPurchaseError(Result->GetError());
+		}
+
+		double GetPurchaseRetryDelay(const int32 Attempt)
+		{
+			return 0.5 * FMath::Pow(2.0, Attempt) * FMath::FRandRange(0.8, 1.2);
+		}
+	} // namespace Private
+} // namespace UE5CoroOSS
 
 UAsyncPlayFabEconomy::UAsyncPlayFabEconomy() = default;
 
@@ -11,113 +66,514 @@ void UAsyncPlayFabEconomy::Initialize(FSubsystemCollectionBase& Collection)
 	Super::Initialize(Collection);
 
 	EconomyAPI = IPlayFabModuleInterface::Get().GetEconomyAPI();
+	Authentication = Collection.InitializeDependency<UAsyncPlayFabAuthentication>();
+
+	CatalogCache.Load(FPaths::ProjectSavedDir() / TEXT("PlayFab") / TEXT("CatalogCache.bin"));
+}
+
+void UAsyncPlayFabEconomy::Deinitialize()
+{
+	if (CatalogCacheSave.IsSet())
+	{
+		CatalogCacheSave->Cancel();
+		CatalogCacheSave.Reset();
+	}
+
+	// Finishes a write still running on a worker thread, then writes whatever changed after it started.
+	CatalogCache.Save();
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
+	Super::Deinitialize();
 }
 
 UAsyncPlayFabEconomy* UAsyncPlayFabEconomy::Get(const UObject* WorldContext)
 {
-	return WorldContext->GetWorld()->GetGameInstance()->GetSubsystem<UAsyncPlayFabEconomy>();
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncPlayFabEconomy>(WorldContext);
 }
 
-TCoroutine<TOptional<FItemsUnion>> UAsyncPlayFabEconomy::GetItems(PlayFab::EconomyModels::FGetItemsRequest Request, const FForceLatentCoroutine)
+TCoroutine<TOptional<FItemsOutcome>> UAsyncPlayFabEconomy::GetItems(
+	PlayFab::EconomyModels::FGetItemsRequest Request, const FForceLatentCoroutine)
 {
-	PlayFab::EconomyModels::FGetItemsResponse Response;
-	PlayFab::FPlayFabCppError Error;
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority();
+
+	if (!co_await Authentication->WaitForEntityToken(Request.AuthenticationContext))
+	{
+		co_return { FItemsOutcome(MakeError(UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError())) };
+	}
 
-	PlayFab::UPlayFabEconomyInstanceAPI::FGetItemsDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+	TOptional<FItemsOutcome> Result = co_await (UE5CoroOSS::IsOffGameThreadParseEnabled()
+		? UE5CoroOSS::CallPlayFabOffGameThread<PlayFab::EconomyModels::FGetItemsResponse>(TEXT("/Catalog/GetItems"),
+			EPlayFabAuthHeader::EntityToken, MoveTemp(Request), Priority)
+		: Call(&PlayFab::UPlayFabEconomyAPI::GetItems, MoveTemp(Request), Priority));
 
-	const TCoroutine<> OnGetItems = []
-		(const FLatentLambda, PlayFab::UPlayFabEconomyInstanceAPI::FGetItemsDelegate& ThisSuccessDelegate,
-			PlayFab::EconomyModels::FGetItemsResponse& ThisResponse) -> TCoroutine<>
+	if (Result.IsSet() && Result->HasValue())
 	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
+		CatalogIndex.Add(Result->GetValue().Items);
+	}
+
+	co_return Result;
+}
 
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+TCoroutine<TOptional<FItemsOutcome>> UAsyncPlayFabEconomy::GetItemsCached(PlayFab::EconomyModels::FGetItemsRequest Request,
+	const FForceLatentCoroutine)
+{
+	if (Request.AlternateIds.IsEmpty() && !Request.Ids.IsEmpty())
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		if (PlayFab::EconomyModels::FGetItemsResponse Cached; CatalogCache.FindAll(Request.Ids, Cached.Items))
+		{
+			CatalogIndex.Add(Cached.Items);
+
+			{
+				const UE5CoroOSS::FScopedPlayFabPriority BackgroundPriority(EPlayFabPriority::Background);
+
+				RevalidateCatalogItems(MoveTemp(Request));
+			}
+
+			co_return { FItemsOutcome(MakeValue(MoveTemp(Cached))) };
+		}
+	}
+
+	TOptional<FItemsOutcome> Result = co_await GetItems(Request);
 
-	if (!EconomyAPI->GetItems(Request, SuccessDelegate, ErrorDelegate))
+	if (Result.IsSet() && Result->HasValue())
 	{
-		co_return {};
+		CacheCatalogItems(Result->GetValue().Items);
 	}
 
-	co_return { !co_await Race(OnGetItems, OnError) ? FItemsUnion(Response) : FItemsUnion(Error) };
+	co_return Result;
 }
 
-TCoroutine<TOptional<FInventoryItemsUnion>> UAsyncPlayFabEconomy::GetInventoryItems(PlayFab::EconomyModels::FGetInventoryItemsRequest Request,
-	const FForceLatentCoroutine)
+TCoroutine<> UAsyncPlayFabEconomy::RevalidateCatalogItems(
+	PlayFab::EconomyModels::FGetItemsRequest Request, const FForceLatentCoroutine)
 {
-	PlayFab::EconomyModels::FGetInventoryItemsResponse Response;
-	PlayFab::FPlayFabCppError Error;
+	Request.Ids.RemoveAll([this](const FString& ItemId)
+	{
+		return RevalidatingItemIds.Contains(ItemId);
+	});
+
+	if (Request.Ids.IsEmpty())
+	{
+		co_return;
+	}
+
+	RevalidatingItemIds.Append(Request.Ids);
 
-	PlayFab::UPlayFabEconomyInstanceAPI::FGetInventoryItemsDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+	const TOptional<FItemsOutcome> Result = co_await GetItems(Request);
 
-	const TCoroutine<> OnGetInventoryItems = []
-		(const FLatentLambda, PlayFab::UPlayFabEconomyInstanceAPI::FGetInventoryItemsDelegate& ThisSuccessDelegate,
-			PlayFab::EconomyModels::FGetInventoryItemsResponse& ThisResponse) -> TCoroutine<>
+	for (const FString& ItemId : Request.Ids)
 	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
+		RevalidatingItemIds.Remove(ItemId);
+	}
 
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+	if (Result.IsSet() && Result->HasValue())
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		if (const TArray<FString> ChangedItemIds = CacheCatalogItems(Result->GetValue().Items);
+			!ChangedItemIds.IsEmpty())
+		{
+			OnCatalogItemsChanged.Broadcast(ChangedItemIds);
+		}
+	}
+}
 
-	if (!EconomyAPI->GetInventoryItems(Request, SuccessDelegate, ErrorDelegate))
+TArray<FString> UAsyncPlayFabEconomy::CacheCatalogItems(const TArray<PlayFab::EconomyModels::FCatalogItem>& Items)
+{
+	TArray<FString> ChangedItemIds = CatalogCache.Update(Items);
+	if (!ChangedItemIds.IsEmpty() && !CatalogCacheSave.IsSet())
 	{
-		co_return {};
+		CatalogCacheSave.Emplace(SaveCatalogCache());
 	}
 
-	co_return { !co_await Race(OnGetInventoryItems, OnError) ? FInventoryItemsUnion(Response) : FInventoryItemsUnion(Error) };
+	return ChangedItemIds;
 }
 
-TCoroutine<TOptional<FPurchaseInventoryItemsUnion>> UAsyncPlayFabEconomy::PurchaseInventoryItems(
+TCoroutine<> UAsyncPlayFabEconomy::SaveCatalogCache(const FForceLatentCoroutine)
+{
+	// Items changed while a write runs are written by the next pass, so keep going until nothing is left to write.
+	for (;;)
+	{
+		co_await Latent::RealSeconds(FMath::Max(0.f, UE5CoroOSS::Private::CatalogCacheSaveDelay));
+
+		if (!CatalogCache.BeginSave())
+		{
+			break;
+		}
+
+		co_await Latent::Until([this]
+		{
+			return !CatalogCache.IsSaving();
+		});
+
+		CatalogCache.FinishSave();
+	}
+
+	CatalogCacheSave.Reset();
+}
+
+const FPlayFabCatalogIndex& UAsyncPlayFabEconomy::GetCatalogIndex() const
+{
+	return CatalogIndex;
+}
+
+TCoroutine<TOptional<FInventoryItemsOutcome>> UAsyncPlayFabEconomy::GetInventoryItems(
+	PlayFab::EconomyModels::FGetInventoryItemsRequest Request)
+{
+	if (UE5CoroOSS::IsOffGameThreadParseEnabled())
+	{
+		const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority();
+
+		if (!co_await Authentication->WaitForEntityToken(Request.AuthenticationContext))
+		{
+			co_return { FInventoryItemsOutcome(MakeError(UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError())) };
+		}
+
+		co_return co_await UE5CoroOSS::CallPlayFabOffGameThread<PlayFab::EconomyModels::FGetInventoryItemsResponse>(
+			TEXT("/Inventory/GetInventoryItems"), EPlayFabAuthHeader::EntityToken, MoveTemp(Request), Priority);
+	}
+
+	co_return co_await Call(&PlayFab::UPlayFabEconomyAPI::GetInventoryItems, MoveTemp(Request));
+}
+
+TCoroutine<TOptional<FInventoryItemsOutcome>> UAsyncPlayFabEconomy::ForEachInventoryPage(
+	PlayFab::EconomyModels::FGetInventoryItemsRequest Request,
+	TFunction<TCoroutine<bool>(const PlayFab::EconomyModels::FGetInventoryItemsResponse&)> OnPage, const FForceLatentCoroutine)
+{
+	check(OnPage);
+
+	TCoroutine<TOptional<FInventoryItemsOutcome>> PendingPage = GetInventoryItems(Request);
+
+	while (true)
+	{
+		TOptional<FInventoryItemsOutcome> Page = co_await PendingPage;
+
+		if (!Page.IsSet() || Page->HasError())
+		{
+			co_return Page;
+		}
+
+		const PlayFab::EconomyModels::FGetInventoryItemsResponse& Response = Page->GetValue();
+
+		const bool bHasNextPage = !Response.ContinuationToken.IsEmpty();
+		if (bHasNextPage)
+		{
+			Request.ContinuationToken = Response.ContinuationToken;
+			PendingPage = GetInventoryItems(Request);
+		}
+
+		if (!co_await OnPage(Response))
+		{
+			if (bHasNextPage)
+			{
+				PendingPage.Cancel();
+			}
+
+			co_return Page;
+		}
+
+		if (!bHasNextPage)
+		{
+			co_return Page;
+		}
+	}
+}
+
+TCoroutine<TOptional<FPurchaseInventoryItemsOutcome>> UAsyncPlayFabEconomy::PurchaseInventoryItems(
+	PlayFab::EconomyModels::FPurchaseInventoryItemsRequest Request, const FForceLatentCoroutine)
+{
+	TOptional<FPurchaseInventoryItemsOutcome> Result = co_await Call(&PlayFab::UPlayFabEconomyAPI::PurchaseInventoryItems, Request,
+		UE5CoroOSS::GetPlayFabPriority(EPlayFabPriority::Critical));
+
+	if (Result.IsSet() && Result->HasValue())
+	{
+		ApplyPurchaseToMirror(Request, Result->GetValue());
+	}
+
+	co_return Result;
+}
+
+TCoroutine<TOptional<FPurchaseInventoryItemsOutcome>> UAsyncPlayFabEconomy::QueuePurchaseInventoryItems(
 	PlayFab::EconomyModels::FPurchaseInventoryItemsRequest Request, const FForceLatentCoroutine)
 {
-	PlayFab::EconomyModels::FPurchaseInventoryItemsResponse Response;
-	PlayFab::FPlayFabCppError Error;
+	if (Request.IdempotencyId.IsEmpty())
+	{
+		Request.IdempotencyId = FGuid::NewGuid().ToString(EGuidFormats::DigitsWithHyphensLower);
+	}
+
+	const TSharedRef<FPendingPurchase> Pending = MakeShared<FPendingPurchase>();
+	Pending->Request = MoveTemp(Request);
+
+	QueuedPurchases.Add(Pending);
+
+	if (!bPurchaseFlushScheduled)
+	{
+		bPurchaseFlushScheduled = true;
+		FlushPurchaseQueue();
+	}
+
+	co_await Latent::Until([Pending]
+	{
+		return Pending->bDone;
+	});
+
+	co_return MoveTemp(Pending->Result);
+}
+
+TCoroutine<TOptional<FExecuteInventoryOperationsOutcome>> UAsyncPlayFabEconomy::ExecuteInventoryOperations(
+	PlayFab::EconomyModels::FExecuteInventoryOperationsRequest Request)
+{
+	return Call(&PlayFab::UPlayFabEconomyAPI::ExecuteInventoryOperations, MoveTemp(Request),
+		UE5CoroOSS::GetPlayFabPriority(EPlayFabPriority::Critical));
+}
+
+TCoroutine<> UAsyncPlayFabEconomy::FlushPurchaseQueue(const FForceLatentCoroutine)
+{
+	co_await Latent::NextTick();
+
+	bPurchaseFlushScheduled = false;
+
+	const TArray<TSharedRef<FPendingPurchase>> Queued = MoveTemp(QueuedPurchases);
+	QueuedPurchases.Reset();
+
+	const int32 MaxOperations = FMath::Max(1, UE5CoroOSS::Private::MaxInventoryOperations);
+
+	// Keyed by the player the purchases are made as, then by the inventory, so one player never pays for another's items.
+	TMap<TPair<TSharedPtr<UPlayFabAuthenticationContext>, FString>, TArray<TSharedRef<FPendingPurchase>>> Batches;
+
+	for (const TSharedRef<FPendingPurchase>& Pending : Queued)
+	{
+		const PlayFab::EconomyModels::FPurchaseInventoryItemsRequest& Request = Pending->Request;
+
+		if (!Request.ETag.IsEmpty() || !Request.CustomTags.IsEmpty())
+		{
+			ExecutePurchaseBatch({ Pending });
+			continue;
+		}
+
+		TArray<TSharedRef<FPendingPurchase>>& Batch = Batches.FindOrAdd(
+			MakeTuple(Request.AuthenticationContext, MakeInventoryKey(Request.Entity, Request.CollectionId)));
+		Batch.Add(Pending);
+
+		if (Batch.Num() >= MaxOperations)
+		{
+			ExecutePurchaseBatch(MoveTemp(Batch));
+			Batch.Reset();
+		}
+	}
+
+	for (TPair<TPair<TSharedPtr<UPlayFabAuthenticationContext>, FString>, TArray<TSharedRef<FPendingPurchase>>>& Batch : Batches)
+	{
+		if (!Batch.Value.IsEmpty())
+		{
+			ExecutePurchaseBatch(MoveTemp(Batch.Value));
+		}
+	}
+}
+
+TCoroutine<> UAsyncPlayFabEconomy::ExecutePurchaseBatch(TArray<TSharedRef<FPendingPurchase>> Batch, const FForceLatentCoroutine)
+{
+	ON_SCOPE_EXIT
+	{
+		for (const TSharedRef<FPendingPurchase>& Pending : Batch)
+		{
+			Pending->bDone = true;
+		}
+	};
+
+	co_await Latent::Until([this]
+	{
+		return PurchasesInFlight < FMath::Max(1, UE5CoroOSS::Private::MaxPurchasesInFlight);
+	});
+
+	++PurchasesInFlight;
 
-	PlayFab::UPlayFabEconomyInstanceAPI::FPurchaseInventoryItemsDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+	ON_SCOPE_EXIT
+	{
+		--PurchasesInFlight;
+	};
+
+	if (Batch.Num() == 1)
+	{
+		co_await ExecutePurchase(Batch[0]);
+		co_return;
+	}
+
+	PlayFab::EconomyModels::FExecuteInventoryOperationsRequest Request;
+	Request.Entity = Batch[0]->Request.Entity;
+	Request.CollectionId = Batch[0]->Request.CollectionId;
+	Request.AuthenticationContext = Batch[0]->Request.AuthenticationContext;
+
+	// Derived from the member purchases, so resubmitting the same purchases can not apply them twice.
+	FString IdempotencySource;
+
+	for (const TSharedRef<FPendingPurchase>& Pending : Batch)
+	{
+		const PlayFab::EconomyModels::FPurchaseInventoryItemsRequest& Purchase = Pending->Request;
+
+		PlayFab::EconomyModels::FInventoryOperation& Operation = Request.Operations.AddDefaulted_GetRef();
+		Operation.Purchase = MakeShared<PlayFab::EconomyModels::FPurchaseInventoryItemsOperation>();
+		Operation.Purchase->Amount = Purchase.Amount;
+		Operation.Purchase->DeleteEmptyStacks = Purchase.DeleteEmptyStacks;
+		Operation.Purchase->Item = Purchase.Item;
+		Operation.Purchase->PriceAmounts = Purchase.PriceAmounts;
+		Operation.Purchase->StoreId = Purchase.StoreId;
+
+		IdempotencySource += Purchase.IdempotencyId;
+	}
+
+	Request.IdempotencyId = FMD5::HashAnsiString(*IdempotencySource);
 
-	const TCoroutine<> OnPurchaseInventoryItems = []
-		(const FLatentLambda, PlayFab::UPlayFabEconomyInstanceAPI::FPurchaseInventoryItemsDelegate& ThisSuccessDelegate,
-			PlayFab::EconomyModels::FPurchaseInventoryItemsResponse& ThisResponse) -> TCoroutine<>
+	TOptional<FExecuteInventoryOperationsOutcome> Result;
+
+	for (int32 Attempt = 0;; ++Attempt)
+	{
+		Result = co_await ExecuteInventoryOperations(Request);
+
+		if (!UE5CoroOSS::Private::ShouldRetryPurchase(Result, Attempt))
+		{
+			break;
+		}
+
+		co_await Latent::RealSeconds(UE5CoroOSS::Private::GetPurchaseRetryDelay(Attempt));
+	}
+
+	if (!Result.IsSet())
 	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
+		co_return;
+	}
 
-	const TCoroutine<> OnError = []
-		(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-			PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+	// The transaction is atomic, so one purchase the player can not afford fails the whole batch without applying any of
+	// it. Resending the purchases one by one, each under its own IdempotencyId, lets the others go through. They are sent
+	// in turn, as the batch holds a single oss.playfab.maxpurchasesinflight slot.
+	if (Result->HasError() && !UE5CoroOSS::Private::IsTransientPurchaseError(Result->GetError()))
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
-	
-	if (!EconomyAPI->PurchaseInventoryItems(Request, SuccessDelegate, ErrorDelegate))
+		for (const TSharedRef<FPendingPurchase>& Pending : Batch)
+		{
+			co_await ExecutePurchase(Pending);
+		}
+
+		co_return;
+	}
+
+	if (Result->HasError())
 	{
-		co_return {};
+		for (const TSharedRef<FPendingPurchase>& Pending : Batch)
+		{
+			Pending->Result.Emplace(MakeError(Result->GetError()));
+		}
+
+		co_return;
 	}
 
-	co_return { !co_await Race(OnPurchaseInventoryItems, OnError) ? FPurchaseInventoryItemsUnion(Response) : FPurchaseInventoryItemsUnion(Error) };
+	const PlayFab::EconomyModels::FExecuteInventoryOperationsResponse& BatchResponse = Result->GetValue();
+
+	for (const TSharedRef<FPendingPurchase>& Pending : Batch)
+	{
+		PlayFab::EconomyModels::FPurchaseInventoryItemsResponse Response;
+		Response.ETag = BatchResponse.ETag;
+		Response.IdempotencyId = Pending->Request.IdempotencyId;
+		Response.TransactionIds = BatchResponse.TransactionIds;
+
+		ApplyPurchaseToMirror(Pending->Request, Response);
+
+		Pending->Result.Emplace(MakeValue(MoveTemp(Response)));
+	}
+}
+
+TCoroutine<> UAsyncPlayFabEconomy::ExecutePurchase(const TSharedRef<FPendingPurchase> Pending, const FForceLatentCoroutine)
+{
+	for (int32 Attempt = 0;; ++Attempt)
+	{
+		Pending->Result = co_await PurchaseInventoryItems(Pending->Request);
+
+		if (!UE5CoroOSS::Private::ShouldRetryPurchase(Pending->Result, Attempt))
+		{
+			co_return;
+		}
+
+		co_await Latent::RealSeconds(UE5CoroOSS::Private::GetPurchaseRetryDelay(Attempt));
+	}
+}
+
+TCoroutine<bool> UAsyncPlayFabEconomy::ReconcileInventory(TSharedPtr<PlayFab::EconomyModels::FEntityKey> Entity, FString CollectionId,
+	const FForceLatentCoroutine)
+{
+	const FString Key = MakeInventoryKey(Entity, CollectionId);
+
+	PlayFab::EconomyModels::FGetInventoryItemsRequest Request;
+	Request.Entity = Entity;
+	Request.CollectionId = CollectionId;
+
+	if (const FPlayFabInventoryMirror* Mirror = InventoryMirrors.Find(Key); Mirror && !Mirror->IsStale())
+	{
+		Request.Count = 1;
+
+		const TOptional<FInventoryItemsOutcome> Probe = co_await GetInventoryItems(Request);
+		if (!Probe.IsSet() || Probe->HasError())
+		{
+			co_return false;
+		}
+
+		// The mirror may have been replaced while the probe was in flight.
+		Mirror = InventoryMirrors.Find(Key);
+		if (Mirror && Mirror->GetETag() == Probe->GetValue().ETag)
+		{
+			co_return true;
+		}
+	}
+
+	Request.Count = 50;
+
+	TArray<PlayFab::EconomyModels::FInventoryItem> Items;
+	FString ETag;
+
+	const TOptional<FInventoryItemsOutcome> LastPage = co_await ForEachInventoryPage(Request,
+		[&Items, &ETag](const PlayFab::EconomyModels::FGetInventoryItemsResponse& Page) -> TCoroutine<bool>
+	{
+		Items.Append(Page.Items);
+		ETag = Page.ETag;
+
+		co_return true;
+	});
+
+	if (!LastPage.IsSet() || LastPage->HasError())
+	{
+		co_return false;
+	}
+
+	InventoryMirrors.FindOrAdd(Key).Reset(MoveTemp(Items), ETag);
+
+	co_return true;
+}
+
+const FPlayFabInventoryMirror* UAsyncPlayFabEconomy::FindInventoryMirror(const TSharedPtr<PlayFab::EconomyModels::FEntityKey>& Entity,
+	const FString& CollectionId) const
+{
+	return InventoryMirrors.Find(MakeInventoryKey(Entity, CollectionId));
+}
+
+void UAsyncPlayFabEconomy::ApplyPurchaseToMirror(const PlayFab::EconomyModels::FPurchaseInventoryItemsRequest& Request,
+	const PlayFab::EconomyModels::FPurchaseInventoryItemsResponse& Response)
+{
+	FPlayFabInventoryMirror* Mirror = InventoryMirrors.Find(MakeInventoryKey(Request.Entity, Request.CollectionId));
+	if (!Mirror)
+	{
+		return;
+	}
+
+	const PlayFab::EconomyModels::FCatalogItem* CatalogItem = Request.Item.IsValid()
+		? CatalogIndex.Get(CatalogIndex.FindById(Request.Item->Id)) : nullptr;
+
+	// Without the catalog item there is no telling whether a bundle was bought, so let the next reconcile fetch the result.
+	if (!CatalogItem)
+	{
+		Mirror->MarkStale();
+		return;
+	}
+
+	Mirror->ApplyPurchase(Request, Response, CatalogItem->Type == TEXT("bundle"));
+}
+
+FString UAsyncPlayFabEconomy::MakeInventoryKey(const TSharedPtr<PlayFab::EconomyModels::FEntityKey>& Entity, const FString& CollectionId)
+{
+	return Entity.IsValid() ? FString::Printf(TEXT("%s/%s/%s"), *Entity->Type, *Entity->Id, *CollectionId) : TEXT("//") + CollectionId;
 }
@@ -0,0 +1,323 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "PlayFabHelpers/AsyncPlayFabEvents.h"
+#include "PlayFab.h"
+#include "HAL/IConsoleManager.h"
+#include "UE5CoroOSS_Shared.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Written"), STAT_PlayFabEventsWritten, STATGROUP_UE5CoroOSSPlayFab);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Dropped"), STAT_PlayFabEventsDropped, STATGROUP_UE5CoroOSSPlayFab);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Event Batches"), STAT_PlayFabEventBatches, STATGROUP_UE5CoroOSSPlayFab);
+
+DEFINE_LOG_CATEGORY_STATIC(LogPlayFabEvents, Log, All);
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		float EventFlushInterval = 5.0f;
+		FAutoConsoleVariableRef CVarEventFlushInterval(
+			TEXT("oss.playfab.eventflushinterval"),
+			EventFlushInterval,
+			TEXT("Seconds between writes of buffered PlayFab events."));
+
+		int32 EventBatchSize = 200;
+		FAutoConsoleVariableRef CVarEventBatchSize(
+			TEXT("oss.playfab.eventbatchsize"),
+			EventBatchSize,
+			TEXT("Maximum number of buffered PlayFab events written in one request, at most 200. Reaching it also triggers a write."));
+
+		int32 MaxBufferedEvents = 4096;
+		FAutoConsoleVariableRef CVarMaxBufferedEvents(
+			TEXT("oss.playfab.maxbufferedevents"),
+			MaxBufferedEvents,
+			TEXT("Maximum number of PlayFab events waiting to be written. Further events are dropped."));
+
+		int32 MaxEventRetries = 3;
+		FAutoConsoleVariableRef CVarMaxEventRetries(
+			TEXT("oss.playfab.maxeventretries"),
+			MaxEventRetries,
+			TEXT("Number of times a buffered PlayFab event is sent again after its batch failed with a transient error."));
+
+		/** The most events WriteEvents and WriteTelemetryEvents accept in one request. */
+		constexpr int32 MAX_EVENTS_PER_REQUEST = 200;
+
+		int32 GetEventBatchSize()
+		{
+			return FMath::Clamp(EventBatchSize, 1, MAX_EVENTS_PER_REQUEST);
+		}
+
+		bool IsTransientEventError(const PlayFab::FPlayFabCppError& Error)
+		{
+			return Error.HttpCode == 0 || Error.HttpCode == 429 || Error.HttpCode >= 500;
+		}
+
+		/** Write events without a subsystem, for the final flush. Only the API is kept alive. */
+		TCoroutine<> WriteRemainingEvents(const TSharedPtr<PlayFab::UPlayFabEventsAPI> Api,
+			PlayFab::EventsModels::FWriteEventsRequest Request, const bool bTelemetry)
+		{
+			const int32 EventCount = Request.Events.Num();
+
+			const TOptional<FWriteEventsOutcome> Result = co_await CallPlayFab(Api, bTelemetry
+				? &PlayFab::UPlayFabEventsAPI::WriteTelemetryEvents : &PlayFab::UPlayFabEventsAPI::WriteEvents,
+				MoveTemp(Request), EPlayFabPriority::Background);
+
+			if (!Result.IsSet() || Result->HasError())
+			{
+				UE_LOG(LogPlayFabEvents, Warning, TEXT("Dropped %d events that could not be written at shutdown: %s"),
+					EventCount, Result.IsSet() ? *Result->GetError().GenerateErrorReport() : TEXT("request did not start"));
+			}
+		}
+	} // namespace Private
+} // namespace UE5CoroOSS
+
+UAsyncPlayFabEvents::UAsyncPlayFabEvents() = default;
+
+void UAsyncPlayFabEvents::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	EventsAPI = IPlayFabModuleInterface::Get().GetEventsAPI();
+	Authentication = Collection.InitializeDependency<UAsyncPlayFabAuthentication>();
+
+	LastFlushTime = FPlatformTime::Seconds();
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UAsyncPlayFabEvents::Tick));
+}
+
+void UAsyncPlayFabEvents::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	// The batch in flight was already sent. Cancelling it only stops its events from being counted or retried.
+	if (CurrentBatch.IsSet())
+	{
+		CurrentBatch->Cancel();
+		CurrentBatch.Reset();
+	}
+
+	SendRemainingEvents();
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
+	Super::Deinitialize();
+}
+
+UAsyncPlayFabEvents* UAsyncPlayFabEvents::Get(const UObject* WorldContext)
+{
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncPlayFabEvents>(WorldContext);
+}
+
+TCoroutine<TOptional<FWriteEventsOutcome>> UAsyncPlayFabEvents::WriteEvents(PlayFab::EventsModels::FWriteEventsRequest Request)
+{
+	return Call(&PlayFab::UPlayFabEventsAPI::WriteEvents, MoveTemp(Request));
+}
+
+TCoroutine<TOptional<FWriteEventsOutcome>> UAsyncPlayFabEvents::WriteTelemetryEvents(
+	PlayFab::EventsModels::FWriteEventsRequest Request)
+{
+	return Call(&PlayFab::UPlayFabEventsAPI::WriteTelemetryEvents, MoveTemp(Request));
+}
+
+bool UAsyncPlayFabEvents::BufferEvent(FString EventNamespace, FString Name, FString PayloadJSON, const bool bTelemetry,
+	TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext)
+{
+	// Reserve a slot first, so concurrent producers can not overshoot the limit between checking and adding.
+	if (BufferedEventCount.fetch_add(1) >= UE5CoroOSS::Private::MaxBufferedEvents)
+	{
+		BufferedEventCount.fetch_sub(1);
+		DroppedEventCount.fetch_add(1);
+		INC_DWORD_STAT(STAT_PlayFabEventsDropped);
+
+		return false;
+	}
+
+	FBufferedEvent Event;
+	Event.Contents.EventNamespace = MoveTemp(EventNamespace);
+	Event.Contents.Name = MoveTemp(Name);
+	Event.Contents.PayloadJSON = MoveTemp(PayloadJSON);
+	Event.Contents.OriginalTimestamp = FDateTime::UtcNow();
+	Event.bTelemetry = bTelemetry;
+	Event.AuthenticationContext = MoveTemp(AuthenticationContext);
+
+	BufferedEvents.Enqueue(MoveTemp(Event));
+
+	return true;
+}
+
+TCoroutine<> UAsyncPlayFabEvents::FlushEvents(const FForceLatentCoroutine)
+{
+	while (true)
+	{
+		if (!IsBatchInFlight())
+		{
+			if (BufferedEventCount.load() <= 0)
+			{
+				co_return;
+			}
+
+			StartEventBatch();
+		}
+
+		// Awaits a copy, as the next batch replaces CurrentBatch.
+		const TCoroutine<> Batch = *CurrentBatch;
+		co_await Batch;
+	}
+}
+
+int32 UAsyncPlayFabEvents::GetDroppedEventCount() const
+{
+	return DroppedEventCount.load();
+}
+
+bool UAsyncPlayFabEvents::Tick(float)
+{
+	if (IsBatchInFlight())
+	{
+		return true;
+	}
+
+	const int32 Buffered = BufferedEventCount.load();
+	if (Buffered >= UE5CoroOSS::Private::GetEventBatchSize()
+		|| (Buffered > 0 && FPlatformTime::Seconds() - LastFlushTime >= UE5CoroOSS::Private::EventFlushInterval))
+	{
+		StartEventBatch();
+	}
+
+	return true;
+}
+
+bool UAsyncPlayFabEvents::IsBatchInFlight() const
+{
+	return CurrentBatch.IsSet() && !CurrentBatch->IsDone();
+}
+
+void UAsyncPlayFabEvents::StartEventBatch()
+{
+	LastFlushTime = FPlatformTime::Seconds();
+
+	CurrentBatch.Emplace(SendEventBatch());
+}
+
+TCoroutine<> UAsyncPlayFabEvents::SendEventBatch(const FForceLatentCoroutine)
+{
+	TArray<FEventBatch> Batches;
+
+	const int32 BatchSize = UE5CoroOSS::Private::GetEventBatchSize();
+
+	FBufferedEvent Event;
+	bool bBatchFull = false;
+	while (!bBatchFull && BufferedEvents.Dequeue(Event))
+	{
+		BufferedEventCount.fetch_sub(1);
+
+		FEventBatch* Batch = Batches.FindByPredicate([&Event](const FEventBatch& Candidate)
+		{
+			return Candidate.bTelemetry == Event.bTelemetry && Candidate.AuthenticationContext == Event.AuthenticationContext;
+		});
+
+		if (!Batch)
+		{
+			Batch = &Batches.AddDefaulted_GetRef();
+			Batch->AuthenticationContext = Event.AuthenticationContext;
+			Batch->bTelemetry = Event.bTelemetry;
+		}
+
+		Batch->Events.Add(MoveTemp(Event));
+		bBatchFull = Batch->Events.Num() >= BatchSize;
+	}
+
+	// Every request goes out before any is awaited.
+	TArray<TCoroutine<TOptional<FWriteEventsOutcome>>> Writes;
+	{
+		const UE5CoroOSS::FScopedPlayFabPriority BackgroundPriority(EPlayFabPriority::Background);
+
+		for (const FEventBatch& Batch : Batches)
+		{
+			// The request holds copies, so the events can be buffered again if their batch fails.
+			PlayFab::EventsModels::FWriteEventsRequest Request;
+			Request.AuthenticationContext = Batch.AuthenticationContext;
+			for (const FBufferedEvent& Buffered : Batch.Events)
+			{
+				Request.Events.Add(Buffered.Contents);
+			}
+
+			Writes.Add(Batch.bTelemetry ? WriteTelemetryEvents(MoveTemp(Request)) : WriteEvents(MoveTemp(Request)));
+		}
+	}
+
+	for (int32 Index = 0; Index < Writes.Num(); ++Index)
+	{
+		ReportEventBatch(co_await Writes[Index], MoveTemp(Batches[Index].Events));
+	}
+}
+
+void UAsyncPlayFabEvents::ReportEventBatch(const TOptional<FWriteEventsOutcome>& Result, TArray<FBufferedEvent> Events)
+{
+	INC_DWORD_STAT(STAT_PlayFabEventBatches);
+
+	if (Result.IsSet() && Result->HasValue())
+	{
+		INC_DWORD_STAT_BY(STAT_PlayFabEventsWritten, Events.Num());
+		return;
+	}
+
+	int32 Requeued = 0;
+	if (Result.IsSet() && UE5CoroOSS::Private::IsTransientEventError(Result->GetError()))
+	{
+		// Requeued past the buffer limit, as these events were already counted against it once.
+		for (FBufferedEvent& Event : Events)
+		{
+			if (++Event.Attempts <= UE5CoroOSS::Private::MaxEventRetries)
+			{
+				BufferedEventCount.fetch_add(1);
+				BufferedEvents.Enqueue(MoveTemp(Event));
+				++Requeued;
+			}
+		}
+	}
+
+	const int32 Dropped = Events.Num() - Requeued;
+	if (Dropped > 0)
+	{
+		DroppedEventCount.fetch_add(Dropped);
+		INC_DWORD_STAT_BY(STAT_PlayFabEventsDropped, Dropped);
+	}
+
+	UE_LOG(LogPlayFabEvents, Warning, TEXT("Failed to write %d events, %d buffered again: %s"), Events.Num(), Requeued,
+		Result.IsSet() ? *Result->GetError().GenerateErrorReport() : TEXT("request did not start"));
+}
+
+void UAsyncPlayFabEvents::SendRemainingEvents()
+{
+	// Keyed by whether the events are telemetry. Each player's events are written with their own requests.
+	TArray<TPair<bool, PlayFab::EventsModels::FWriteEventsRequest>> Requests;
+
+	const int32 BatchSize = UE5CoroOSS::Private::GetEventBatchSize();
+
+	FBufferedEvent Event;
+	while (BufferedEvents.Dequeue(Event))
+	{
+		TPair<bool, PlayFab::EventsModels::FWriteEventsRequest>* Batch = Requests.FindByPredicate(
+			[&Event, BatchSize](const TPair<bool, PlayFab::EventsModels::FWriteEventsRequest>& Candidate)
+			{
+				return Candidate.Key == Event.bTelemetry && Candidate.Value.AuthenticationContext == Event.AuthenticationContext
+					&& Candidate.Value.Events.Num() < BatchSize;
+			});
+
+		if (!Batch)
+		{
+			Batch = &Requests.AddDefaulted_GetRef();
+			Batch->Key = Event.bTelemetry;
+			Batch->Value.AuthenticationContext = Event.AuthenticationContext;
+		}
+
+		Batch->Value.Events.Add(MoveTemp(Event.Contents));
+	}
+
+	BufferedEventCount.store(0);
+
+	for (TPair<bool, PlayFab::EventsModels::FWriteEventsRequest>& Request : Requests)
+	{
+		UE5CoroOSS::Private::WriteRemainingEvents(EventsAPI, MoveTemp(Request.Value), Request.Key);
+	}
+}
@@ -3,7 +3,26 @@
 #include "PlayFabHelpers/AsyncPlayFabProfiles.h"
 
 #include "PlayFab.h"
-#include "PlayFabProfilesInstanceAPI.h"
+#include "HAL/IConsoleManager.h"
+#include "UE5CoroOSS_Shared.h"
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		int32 TitlePlayersChunkSize = 25;
+		FAutoConsoleVariableRef CVarTitlePlayersChunkSize(
+			TEXT("oss.playfab.titleplayerschunksize"),
+			TitlePlayersChunkSize,
+			TEXT("Maximum number of master player account ids sent in one GetTitlePlayersFromMasterPlayerAccountIds request."));
+
+		int32 MaxTitlePlayersRequests = 4;
+		FAutoConsoleVariableRef CVarMaxTitlePlayersRequests(
+			TEXT("oss.playfab.maxtitleplayerrequests"),
+			MaxTitlePlayersRequests,
+			TEXT("Maximum number of chunked GetTitlePlayersFromMasterPlayerAccountIds requests in flight at once."));
+	} // namespace Private
+} // namespace UE5CoroOSS
 
 UAsyncPlayFabProfiles::UAsyncPlayFabProfiles() = default;
 
@@ -12,44 +31,116 @@ void UAsyncPlayFabProfiles::Initialize(FSubsystemCollectionBase& Collection)
 	Super::Initialize(Collection);
 
 	ProfilesAPI = IPlayFabModuleInterface::Get().GetProfilesAPI();
+	Authentication = Collection.InitializeDependency<UAsyncPlayFabAuthentication>();
+}
+
+void UAsyncPlayFabProfiles::Deinitialize()
+{
+	UE5CoroOSS::ForgetSubsystem(this);
+
+	Super::Deinitialize();
 }
 
 UAsyncPlayFabProfiles* UAsyncPlayFabProfiles::Get(const UObject* WorldContext)
 {
-	return WorldContext->GetWorld()->GetGameInstance()->GetSubsystem<UAsyncPlayFabProfiles>();
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncPlayFabProfiles>(WorldContext);
 }
 
-TCoroutine<TOptional<FTitlePlayersUnion>> UAsyncPlayFabProfiles::GetTitlePlayersFromMasterPlayerAccountIds(
-	PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsRequest& Request, const FForceLatentCoroutine)
+TCoroutine<TOptional<FTitlePlayersOutcome>> UAsyncPlayFabProfiles::GetTitlePlayersFromMasterPlayerAccountIds(
+	PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsRequest& Request)
 {
+	return Call(&PlayFab::UPlayFabProfilesAPI::GetTitlePlayersFromMasterPlayerAccountIds, Request);
+}
+
+TCoroutine<TOptional<FTitlePlayersOutcome>> UAsyncPlayFabProfiles::GetTitlePlayersFromMasterPlayerAccountIds(
+	TArray<FString> MasterPlayerAccountIds, FString TitleId, TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext,
+	const FForceLatentCoroutine)
+{
+	const FString CacheKey = TitleId.IsEmpty() ? PlayFab::PlayFabSettings::GetTitleId() : TitleId;
+	const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority();
+
 	PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsResponse Response;
-	PlayFab::FPlayFabCppError Error;
+	Response.TitleId = CacheKey;
+
+	TArray<FString> Unresolved;
+	const TMap<FString, PlayFab::ProfilesModels::FEntityKey>* Cached = TitlePlayerCache.Find(CacheKey);
+
+	for (const FString& MasterPlayerAccountId : TSet<FString>(MasterPlayerAccountIds))
+	{
+		if (const PlayFab::ProfilesModels::FEntityKey* TitlePlayer = Cached ? Cached->Find(MasterPlayerAccountId) : nullptr)
+		{
+			Response.TitlePlayerAccounts.Add(MasterPlayerAccountId, *TitlePlayer);
+		}
+		else
+		{
+			Unresolved.Add(MasterPlayerAccountId);
+		}
+	}
+
+	const int32 ChunkSize = FMath::Max(1, UE5CoroOSS::Private::TitlePlayersChunkSize);
+	const int32 MaxInFlight = FMath::Max(1, UE5CoroOSS::Private::MaxTitlePlayersRequests);
 
-	PlayFab::UPlayFabProfilesInstanceAPI::FGetTitlePlayersFromMasterPlayerAccountIdsDelegate SuccessDelegate;
-	PlayFab::FPlayFabErrorDelegate ErrorDelegate;
+	TArray<TCoroutine<TOptional<FTitlePlayersOutcome>>> InFlight;
+	TOptional<FTitlePlayersOutcome> FirstError;
+	bool bAllStarted = true;
 
-	const TCoroutine<> OnGetTitlePlayersFromMasterPlayerAccountIds = []
-	(const FLatentLambda, PlayFab::UPlayFabProfilesInstanceAPI::FGetTitlePlayersFromMasterPlayerAccountIdsDelegate& ThisSuccessDelegate,
-		PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsResponse& ThisResponse) -> TCoroutine<>
+	const auto Merge = [&](const TOptional<FTitlePlayersOutcome>& Result)
 	{
-		auto [InnerResponse] = co_await ThisSuccessDelegate;
-		
-		ThisResponse = InnerResponse;
-	}(FLambdaParam(this), SuccessDelegate, Response);
-
-	const TCoroutine<> OnError = []
-	(const FLatentLambda, PlayFab::FPlayFabErrorDelegate& ThisErrorDelegate,
-		PlayFab::FPlayFabCppError& ThisError) -> TCoroutine<>
+		if (!Result.IsSet())
+		{
+			bAllStarted = false;
+			return;
+		}
+
+		if (Result->HasError())
+		{
+			if (!FirstError.IsSet())
+			{
+				FirstError.Emplace(MakeError(Result->GetError()));
+			}
+
+			return;
+		}
+
+		TMap<FString, PlayFab::ProfilesModels::FEntityKey>& Cache = TitlePlayerCache.FindOrAdd(CacheKey);
+		for (const TPair<FString, PlayFab::ProfilesModels::FEntityKey>& TitlePlayer : Result->GetValue().TitlePlayerAccounts)
+		{
+			Cache.Add(TitlePlayer.Key, TitlePlayer.Value);
+			Response.TitlePlayerAccounts.Add(TitlePlayer.Key, TitlePlayer.Value);
+		}
+	};
+
+	for (int32 Start = 0; Start < Unresolved.Num(); Start += ChunkSize)
 	{
-		auto [InnerError] = co_await ThisErrorDelegate;
-		
-		ThisError = InnerError;
-	}(FLambdaParam(this), ErrorDelegate, Error);
+		if (InFlight.Num() >= MaxInFlight)
+		{
+			// Chunks are the same size, so the oldest request tends to finish first.
+			Merge(co_await InFlight[0]);
+			InFlight.RemoveAt(0);
+		}
 
-	if (!ProfilesAPI->GetTitlePlayersFromMasterPlayerAccountIds(Request, SuccessDelegate, ErrorDelegate))
+		PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsRequest Request;
+		Request.MasterPlayerAccountIds.Append(&Unresolved[Start], FMath::Min(ChunkSize, Unresolved.Num() - Start));
+		Request.TitleId = TitleId;
+		Request.AuthenticationContext = AuthenticationContext;
+
+		InFlight.Add(Call(&PlayFab::UPlayFabProfilesAPI::GetTitlePlayersFromMasterPlayerAccountIds, MoveTemp(Request), Priority));
+	}
+
+	for (TCoroutine<TOptional<FTitlePlayersOutcome>>& Pending : InFlight)
+	{
+		Merge(co_await Pending);
+	}
+
+	if (!bAllStarted)
 	{
 		co_return {};
 	}
 
-	co_return { !co_await Race(OnGetTitlePlayersFromMasterPlayerAccountIds, OnError) ? FTitlePlayersUnion(Response) : FTitlePlayersUnion(Error) };
+	if (FirstError.IsSet())
+	{
+		co_return FirstError;
+	}
+
+	co_return { FTitlePlayersOutcome(MakeValue(MoveTemp(Response))) };
 }
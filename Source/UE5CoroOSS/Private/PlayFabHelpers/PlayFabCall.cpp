@@ -0,0 +1,161 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "PlayFabHelpers/PlayFabCall.h"
+#include "HttpModule.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+DEFINE_STAT(STAT_PlayFabParseResponse);
+DEFINE_STAT(STAT_PlayFabParsedBytes);
+DEFINE_STAT(STAT_PlayFabParsedOffGameThread);
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		bool bOffGameThreadParse = false;
+		FAutoConsoleVariableRef CVarOffGameThreadParse(
+			TEXT("oss.playfab.offgamethreadparse"),
+			bOffGameThreadParse,
+			TEXT("Send large PlayFab reads directly and deserialize their responses on a worker thread. The worker still builds the full JSON object tree before reading the model, so enable it only where profiling shows game thread parse spikes."));
+
+		int32 OffGameThreadParseMinBytes = 16 * 1024;
+		FAutoConsoleVariableRef CVarOffGameThreadParseMinBytes(
+			TEXT("oss.playfab.offgamethreadparseminbytes"),
+			OffGameThreadParseMinBytes,
+			TEXT("Responses smaller than this are deserialized on the game thread, where the thread hop costs more than the parse."));
+
+		FHttpRequestPtr MakePlayFabRequest(const FString& Path, const EPlayFabAuthHeader AuthHeader, const FString& AuthValue,
+			const FString& Body)
+		{
+			if (AuthValue.IsEmpty())
+			{
+				return nullptr;
+			}
+
+			const FHttpRequestRef HttpRequest = FHttpModule::Get().CreateRequest();
+			HttpRequest->SetURL(PlayFab::PlayFabSettings::GetUrl(Path));
+			HttpRequest->SetVerb(TEXT("POST"));
+			HttpRequest->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+			HttpRequest->SetHeader(TEXT("X-ReportErrorAsSuccess"), TEXT("true"));
+			HttpRequest->SetHeader(AuthHeader == EPlayFabAuthHeader::EntityToken ? TEXT("X-EntityToken") : TEXT("X-Authorization"),
+				AuthValue);
+			HttpRequest->SetContentAsString(Body);
+
+			return HttpRequest;
+		}
+
+		TCoroutine<TTuple<FHttpResponsePtr, bool>> ProcessPlayFabRequest(FHttpRequestRef HttpRequest, const EPlayFabPriority Priority,
+			const TSharedPtr<double> SentTime)
+		{
+			const FPlayFabSlot Slot(Priority);
+			co_await Slot.WhenGranted();
+
+			if (SentTime.IsValid())
+			{
+				*SentTime = FPlatformTime::Seconds();
+			}
+
+			co_return co_await Http::ProcessAsync(MoveTemp(HttpRequest));
+		}
+
+		TCoroutine<TOptional<TTuple<FHttpResponsePtr, bool>>> SendPlayFabRequest(FString Path, const EPlayFabAuthHeader AuthHeader,
+			TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext, FString Body, const EPlayFabPriority Priority,
+			TSharedPtr<double> SentTime)
+		{
+			FString AuthValue;
+			if (AuthHeader == EPlayFabAuthHeader::EntityToken)
+			{
+				AuthValue = AuthenticationContext.IsValid() ? AuthenticationContext->GetEntityToken()
+					: PlayFab::PlayFabSettings::GetEntityToken();
+			}
+			else
+			{
+				AuthValue = AuthenticationContext.IsValid() ? AuthenticationContext->GetClientSessionTicket()
+					: PlayFab::PlayFabSettings::GetClientSessionTicket();
+			}
+
+			const FHttpRequestPtr HttpRequest = MakePlayFabRequest(Path, AuthHeader, AuthValue, Body);
+			if (!HttpRequest.IsValid())
+			{
+				co_return {};
+			}
+
+			co_return co_await ProcessPlayFabRequest(HttpRequest.ToSharedRef(), Priority, MoveTemp(SentTime));
+		}
+
+		bool ShouldParseOnWorker(const FHttpResponsePtr& HttpResponse)
+		{
+			return HttpResponse.IsValid() && HttpResponse->GetContentLength() >= OffGameThreadParseMinBytes;
+		}
+
+		TSharedPtr<FJsonObject> DecodePlayFabResponse(const FHttpResponsePtr& HttpResponse, const bool bSucceeded,
+			PlayFab::FPlayFabCppError& OutError)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_PlayFabParseResponse);
+			TRACE_CPUPROFILER_EVENT_SCOPE(UE5CoroOSS::DecodePlayFabResponse);
+
+			if (!bSucceeded || !HttpResponse.IsValid())
+			{
+				OutError.HttpCode = 0;
+				OutError.HttpStatus = TEXT("Failed to contact server");
+				OutError.ErrorName = TEXT("ServiceUnavailable");
+				OutError.ErrorMessage = TEXT("Failed to contact server");
+				return nullptr;
+			}
+
+			INC_DWORD_STAT_BY(STAT_PlayFabParsedBytes, HttpResponse->GetContentLength());
+			if (!IsInGameThread())
+			{
+				INC_DWORD_STAT(STAT_PlayFabParsedOffGameThread);
+			}
+
+			TSharedPtr<FJsonObject> JsonObject;
+			if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(HttpResponse->GetContentAsString()), JsonObject)
+				|| !JsonObject.IsValid())
+			{
+				OutError.HttpCode = HttpResponse->GetResponseCode();
+				OutError.HttpStatus = TEXT("Invalid response");
+				OutError.ErrorName = TEXT("JsonParseError");
+				OutError.ErrorMessage = TEXT("The response could not be parsed as JSON");
+				return nullptr;
+			}
+
+			OutError.HttpCode = JsonObject->GetIntegerField(TEXT("code"));
+			if (OutError.HttpCode == 200)
+			{
+				const TSharedPtr<FJsonObject>* Data;
+				return JsonObject->TryGetObjectField(TEXT("data"), Data) ? *Data : MakeShared<FJsonObject>();
+			}
+
+			JsonObject->TryGetStringField(TEXT("status"), OutError.HttpStatus);
+			JsonObject->TryGetNumberField(TEXT("errorCode"), OutError.ErrorCode);
+			JsonObject->TryGetStringField(TEXT("error"), OutError.ErrorName);
+			JsonObject->TryGetStringField(TEXT("errorMessage"), OutError.ErrorMessage);
+
+			const TSharedPtr<FJsonObject>* ErrorDetails;
+			if (JsonObject->TryGetObjectField(TEXT("errorDetails"), ErrorDetails))
+			{
+				for (const TPair<FString, TSharedPtr<FJsonValue>>& Detail : (*ErrorDetails)->Values)
+				{
+					const TArray<TSharedPtr<FJsonValue>>* Messages;
+					if (Detail.Value->TryGetArray(Messages))
+					{
+						for (const TSharedPtr<FJsonValue>& Message : *Messages)
+						{
+							OutError.ErrorDetails.Add(Detail.Key, Message->AsString());
+						}
+					}
+				}
+			}
+
+			return nullptr;
+		}
+	} // namespace Private
+
+	bool IsOffGameThreadParseEnabled()
+	{
+		return Private::bOffGameThreadParse;
+	}
+} // namespace UE5CoroOSS
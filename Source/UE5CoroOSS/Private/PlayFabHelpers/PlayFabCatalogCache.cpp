@@ -0,0 +1,442 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "PlayFabHelpers/PlayFabCatalogCache.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPlayFabCatalogCache, Log, All);
+
+namespace UE5CoroOSS::Private
+{
+	constexpr uint32 CATALOG_CACHE_MAGIC = 0x43435043; // 'CPCC'
+	constexpr int32 CATALOG_CACHE_VERSION = 1;
+
+	/** Smallest serialized entry: two empty strings, the last modified ticks, the payload offset and the payload size. */
+	constexpr int64 MIN_CATALOG_ENTRY_SIZE = sizeof(int32) * 2 + sizeof(int64) * 2 + sizeof(int32);
+} // namespace UE5CoroOSS::Private
+
+FPlayFabCatalogCache::FPlayFabCatalogCache() = default;
+
+FPlayFabCatalogCache::~FPlayFabCatalogCache()
+{
+	// The writer reads payloads out of the mapped file, so it has to finish before the mapping goes away.
+	FinishSave();
+
+	Unmap();
+}
+
+bool FPlayFabCatalogCache::Load(const FString& InFilePath)
+{
+	FinishSave();
+
+	Unmap();
+	Entries.Reset();
+	bDirty = false;
+
+	FilePath = InFilePath;
+
+	if (!FPaths::FileExists(FilePath))
+	{
+		return false;
+	}
+
+	if (!Map())
+	{
+		return false;
+	}
+
+	if (!ReadEntryTable(TConstArrayView64<uint8>(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize())))
+	{
+		UE_LOG(LogPlayFabCatalogCache, Warning, TEXT("Discarding unreadable catalog cache (%s)"), *FilePath);
+
+		Unmap();
+		Entries.Reset();
+		return false;
+	}
+
+	UE_LOG(LogPlayFabCatalogCache, Verbose, TEXT("Mapped %d cached catalog items from (%s)"), Entries.Num(), *FilePath);
+
+	return true;
+}
+
+bool FPlayFabCatalogCache::Save()
+{
+	FinishSave();
+
+	if (!bDirty)
+	{
+		return true;
+	}
+
+	if (FilePath.IsEmpty())
+	{
+		return false;
+	}
+
+	int64 PayloadStart = 0;
+	TMap<FString, FSavedEntry> Saved;
+	const TArray<uint8> Bytes = Serialize(MakeSnapshot(), PayloadStart, Saved);
+
+	const FString TempPath = FilePath + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !ReplaceFile(TempPath, PayloadStart, Saved))
+	{
+		UE_LOG(LogPlayFabCatalogCache, Warning, TEXT("Failed to write catalog cache (%s)"), *FilePath);
+
+		return false;
+	}
+
+	bDirty = false;
+
+	return true;
+}
+
+bool FPlayFabCatalogCache::BeginSave()
+{
+	if (!bDirty || FilePath.IsEmpty() || PendingSave.IsValid())
+	{
+		return false;
+	}
+
+	PendingSave = MakeUnique<FPendingSave>();
+	PendingSave->TempPath = FilePath + TEXT(".tmp");
+
+	// Entries updated while the write runs mark the cache dirty again, and are written by the next save.
+	bDirty = false;
+
+	PendingSave->Task = UE::Tasks::Launch(TEXT("PlayFabSaveCatalogCache"),
+		[Snapshot = MakeSnapshot(), TempPath = PendingSave->TempPath, &PayloadStart = PendingSave->PayloadStart,
+			&Saved = PendingSave->Saved]
+	{
+		return FFileHelper::SaveArrayToFile(Serialize(Snapshot, PayloadStart, Saved), *TempPath);
+	});
+
+	return true;
+}
+
+bool FPlayFabCatalogCache::IsSaving() const
+{
+	return PendingSave.IsValid() && !PendingSave->Task.IsCompleted();
+}
+
+bool FPlayFabCatalogCache::FinishSave()
+{
+	if (!PendingSave.IsValid())
+	{
+		return true;
+	}
+
+	const TUniquePtr<FPendingSave> Finished = MoveTemp(PendingSave);
+
+	if (!Finished->Task.GetResult() || !ReplaceFile(Finished->TempPath, Finished->PayloadStart, Finished->Saved))
+	{
+		UE_LOG(LogPlayFabCatalogCache, Warning, TEXT("Failed to write catalog cache (%s)"), *FilePath);
+
+		bDirty = true;
+		return false;
+	}
+
+	return true;
+}
+
+TArray<FPlayFabCatalogCache::FEntrySnapshot> FPlayFabCatalogCache::MakeSnapshot() const
+{
+	TArray<FEntrySnapshot> Snapshot;
+	Snapshot.Reserve(Entries.Num());
+
+	for (const TPair<FString, FEntry>& Pair : Entries)
+	{
+		FEntrySnapshot& Entry = Snapshot.AddDefaulted_GetRef();
+		Entry.ItemId = Pair.Key;
+		Entry.ETag = Pair.Value.ETag;
+		Entry.Ticks = Pair.Value.LastModified.GetTicks();
+
+		// Items are immutable once cached, so the writer can serialize them without copying.
+		if (Pair.Value.Item.IsValid())
+		{
+			Entry.Item = Pair.Value.Item;
+		}
+		else
+		{
+			Entry.Payload = GetPayload(Pair.Value);
+		}
+	}
+
+	return Snapshot;
+}
+
+TArray<uint8> FPlayFabCatalogCache::Serialize(const TArray<FEntrySnapshot>& Snapshot, int64& OutPayloadStart,
+	TMap<FString, FSavedEntry>& OutSaved)
+{
+	TArray<uint8> Table;
+	TArray<uint8> Payloads;
+
+	FMemoryWriter TableWriter(Table);
+
+	uint32 Magic = UE5CoroOSS::Private::CATALOG_CACHE_MAGIC;
+	int32 Version = UE5CoroOSS::Private::CATALOG_CACHE_VERSION;
+	int32 NumEntries = Snapshot.Num();
+	int64 PayloadStart = 0;
+
+	TableWriter << Magic << Version << NumEntries;
+
+	const int64 PayloadStartPosition = TableWriter.Tell();
+	TableWriter << PayloadStart;
+
+	OutSaved.Reset();
+	OutSaved.Reserve(Snapshot.Num());
+
+	for (const FEntrySnapshot& Entry : Snapshot)
+	{
+		FSavedEntry& Saved = OutSaved.Add(Entry.ItemId);
+		Saved.ETag = Entry.ETag;
+		Saved.Offset = Payloads.Num();
+
+		if (Entry.Item.IsValid())
+		{
+			const FTCHARToUTF8 Utf8(*Entry.Item->toJSONString());
+			Payloads.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+			Saved.Size = Utf8.Length();
+		}
+		else
+		{
+			Payloads.Append(Entry.Payload);
+			Saved.Size = Entry.Payload.Num();
+		}
+
+		FString ItemId = Entry.ItemId;
+		FString ETag = Entry.ETag;
+		int64 Ticks = Entry.Ticks;
+
+		TableWriter << ItemId << ETag << Ticks;
+		TableWriter << Saved.Offset << Saved.Size;
+	}
+
+	PayloadStart = TableWriter.Tell();
+	TableWriter.Seek(PayloadStartPosition);
+	TableWriter << PayloadStart;
+
+	Table.Append(Payloads);
+
+	OutPayloadStart = PayloadStart;
+
+	return Table;
+}
+
+bool FPlayFabCatalogCache::ReplaceFile(const FString& TempPath, const int64 PayloadStart, const TMap<FString, FSavedEntry>& Saved)
+{
+	// The mapped view has to be released before the file can be replaced.
+	Unmap();
+
+	if (!IFileManager::Get().Move(*FilePath, *TempPath, true))
+	{
+		// The previous file is untouched, so the existing payload offsets are still valid.
+		Map();
+		return false;
+	}
+
+	for (TPair<FString, FEntry>& Pair : Entries)
+	{
+		FEntry& Entry = Pair.Value;
+
+		// Entries changed after the snapshot was taken keep their item in memory until the next save.
+		if (const FSavedEntry* SavedEntry = Saved.Find(Pair.Key); SavedEntry && SavedEntry->ETag == Entry.ETag)
+		{
+			Entry.PayloadOffset = PayloadStart + SavedEntry->Offset;
+			Entry.PayloadSize = SavedEntry->Size;
+		}
+		else
+		{
+			Entry.PayloadOffset = INDEX_NONE;
+			Entry.PayloadSize = 0;
+		}
+	}
+
+	Map();
+
+	return true;
+}
+
+TSharedPtr<const PlayFab::EconomyModels::FCatalogItem> FPlayFabCatalogCache::Find(const FString& ItemId)
+{
+	FEntry* Entry = Entries.Find(ItemId);
+	if (!Entry)
+	{
+		return nullptr;
+	}
+
+	if (!Entry->Item.IsValid())
+	{
+		const TConstArrayView64<uint8> Payload = GetPayload(*Entry);
+		if (Payload.IsEmpty())
+		{
+			return nullptr;
+		}
+
+		const FString Json(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Payload.GetData()), Payload.Num()));
+
+		TSharedPtr<FJsonObject> JsonObject;
+		if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), JsonObject) || !JsonObject.IsValid())
+		{
+			return nullptr;
+		}
+
+		Entry->Item = MakeShared<const PlayFab::EconomyModels::FCatalogItem>(JsonObject);
+	}
+
+	return Entry->Item;
+}
+
+bool FPlayFabCatalogCache::FindAll(const TArray<FString>& ItemIds, TArray<PlayFab::EconomyModels::FCatalogItem>& OutItems)
+{
+	OutItems.Reset(ItemIds.Num());
+
+	for (const FString& ItemId : ItemIds)
+	{
+		const TSharedPtr<const PlayFab::EconomyModels::FCatalogItem> Item = Find(ItemId);
+		if (!Item.IsValid())
+		{
+			OutItems.Reset();
+			return false;
+		}
+
+		OutItems.Add(*Item);
+	}
+
+	return true;
+}
+
+TArray<FString> FPlayFabCatalogCache::Update(const TArray<PlayFab::EconomyModels::FCatalogItem>& Items)
+{
+	TArray<FString> Changed;
+
+	for (const PlayFab::EconomyModels::FCatalogItem& Item : Items)
+	{
+		const FEntry* Existing = Entries.Find(Item.Id);
+		if (Existing && Existing->ETag == Item.ETag)
+		{
+			continue;
+		}
+
+		FEntry& Entry = Entries.FindOrAdd(Item.Id);
+
+		Entry.ETag = Item.ETag;
+		Entry.LastModified = Item.LastModifiedDate.notNull() ? Item.LastModifiedDate.mValue : FDateTime::UtcNow();
+		Entry.Item = MakeShared<const PlayFab::EconomyModels::FCatalogItem>(Item);
+		Entry.PayloadOffset = INDEX_NONE;
+		Entry.PayloadSize = 0;
+
+		Changed.Add(Item.Id);
+	}
+
+	bDirty |= !Changed.IsEmpty();
+
+	return Changed;
+}
+
+bool FPlayFabCatalogCache::Contains(const FString& ItemId) const
+{
+	return Entries.Contains(ItemId);
+}
+
+bool FPlayFabCatalogCache::IsDirty() const
+{
+	return bDirty;
+}
+
+int32 FPlayFabCatalogCache::Num() const
+{
+	return Entries.Num();
+}
+
+bool FPlayFabCatalogCache::ReadEntryTable(const TConstArrayView64<uint8> Bytes)
+{
+	FMemoryReaderView Reader(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 NumEntries = 0;
+	int64 PayloadStart = 0;
+
+	Reader << Magic << Version << NumEntries << PayloadStart;
+
+	if (Reader.IsError() || Magic != UE5CoroOSS::Private::CATALOG_CACHE_MAGIC || Version != UE5CoroOSS::Private::CATALOG_CACHE_VERSION
+		|| NumEntries < 0 || PayloadStart > Bytes.Num()
+		|| NumEntries > (Bytes.Num() - Reader.Tell()) / UE5CoroOSS::Private::MIN_CATALOG_ENTRY_SIZE
+		|| PayloadStart < Reader.Tell() + NumEntries * UE5CoroOSS::Private::MIN_CATALOG_ENTRY_SIZE)
+	{
+		return false;
+	}
+
+	Entries.Reserve(NumEntries);
+
+	for (int32 Index = 0; Index < NumEntries; ++Index)
+	{
+		FString ItemId;
+		FEntry Entry;
+		int64 Ticks = 0;
+
+		Reader << ItemId << Entry.ETag << Ticks << Entry.PayloadOffset << Entry.PayloadSize;
+
+		if (Reader.IsError())
+		{
+			return false;
+		}
+
+		Entry.LastModified = FDateTime(Ticks);
+		Entry.PayloadOffset += PayloadStart;
+
+		if (Entry.PayloadOffset < PayloadStart || Entry.PayloadSize <= 0 || Entry.PayloadOffset + Entry.PayloadSize > Bytes.Num())
+		{
+			return false;
+		}
+
+		Entries.Add(MoveTemp(ItemId), MoveTemp(Entry));
+	}
+
+	// The payloads start after the table, so no entry can point back into it.
+	return PayloadStart >= Reader.Tell();
+}
+
+TConstArrayView64<uint8> FPlayFabCatalogCache::GetPayload(const FEntry& Entry) const
+{
+	if (!MappedRegion.IsValid() || Entry.PayloadOffset == INDEX_NONE)
+	{
+		return {};
+	}
+
+	return TConstArrayView64<uint8>(MappedRegion->GetMappedPtr() + Entry.PayloadOffset, Entry.PayloadSize);
+}
+
+bool FPlayFabCatalogCache::Map()
+{
+	Unmap();
+
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath));
+	if (!MappedFile.IsValid() || MappedFile->GetFileSize() <= 0)
+	{
+		Unmap();
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	if (!MappedRegion.IsValid())
+	{
+		Unmap();
+		return false;
+	}
+
+	return true;
+}
+
+void FPlayFabCatalogCache::Unmap()
+{
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
@@ -0,0 +1,414 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "PlayFabHelpers/PlayFabCatalogIndex.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Reverse.h"
+#include "Algo/Sort.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPlayFabCatalogIndex, Log, All);
+
+void FPlayFabCatalogIndex::Add(const TArray<PlayFab::EconomyModels::FCatalogItem>& NewItems)
+{
+	for (const PlayFab::EconomyModels::FCatalogItem& Item : NewItems)
+	{
+		const int32 ItemId = Intern(Item.Id);
+
+		FPlayFabCatalogItemHandle Handle;
+
+		if (const int32* Existing = ItemIdToIndex.Find(ItemId))
+		{
+			Handle.Index = *Existing;
+
+			if (Items[Handle.Index]->ETag == Item.ETag)
+			{
+				continue;
+			}
+
+			Unindex(Handle);
+
+			Items[Handle.Index] = MakeShared<const PlayFab::EconomyModels::FCatalogItem>(Item);
+		}
+		else
+		{
+			Handle.Index = Items.Add(MakeShared<const PlayFab::EconomyModels::FCatalogItem>(Item));
+
+			TypeColumn.AddDefaulted();
+			ContentTypeColumn.AddDefaulted();
+			TagColumn.AddDefaulted();
+			PriceColumn.AddDefaulted();
+
+			ItemIdToIndex.Add(ItemId, Handle.Index);
+		}
+
+		Index(Handle);
+
+		// Removing keeps the order, only appended prices need sorting.
+		for (const TPair<int32, int32>& Price : PriceColumn[Handle.Index])
+		{
+			UnsortedCurrencies.Add(Price.Key);
+		}
+	}
+}
+
+void FPlayFabCatalogIndex::Reset()
+{
+	Strings.Reset();
+	StringIds.Reset();
+	ItemIdToIndex.Reset();
+	TypeColumn.Reset();
+	ContentTypeColumn.Reset();
+	TagColumn.Reset();
+	PriceColumn.Reset();
+	Items.Reset();
+	TagPostings.Reset();
+	TypePostings.Reset();
+	ContentTypePostings.Reset();
+	Prices.Reset();
+	UnsortedCurrencies.Reset();
+}
+
+int32 FPlayFabCatalogIndex::Num() const
+{
+	return Items.Num();
+}
+
+FPlayFabCatalogItemHandle FPlayFabCatalogIndex::FindById(const FString& ItemId) const
+{
+	const int32* Index = ItemIdToIndex.Find(FindString(ItemId));
+
+	return { Index ? *Index : INDEX_NONE };
+}
+
+const PlayFab::EconomyModels::FCatalogItem* FPlayFabCatalogIndex::Get(const FPlayFabCatalogItemHandle Handle) const
+{
+	return Items.IsValidIndex(Handle.Index) ? &Items[Handle.Index].Get() : nullptr;
+}
+
+TOptional<int32> FPlayFabCatalogIndex::GetPrice(const FPlayFabCatalogItemHandle Handle, const FString& CurrencyId) const
+{
+	const int32 Currency = FindString(CurrencyId);
+	if (Currency == INDEX_NONE || !PriceColumn.IsValidIndex(Handle.Index))
+	{
+		return {};
+	}
+
+	for (const TPair<int32, int32>& Price : PriceColumn[Handle.Index])
+	{
+		if (Price.Key == Currency)
+		{
+			return Price.Value;
+		}
+	}
+
+	return {};
+}
+
+TConstArrayView<FPlayFabCatalogItemHandle> FPlayFabCatalogIndex::QueryTag(const FString& Tag) const
+{
+	return FindPostings(TagPostings, Tag);
+}
+
+TConstArrayView<FPlayFabCatalogItemHandle> FPlayFabCatalogIndex::QueryType(const FString& Type) const
+{
+	return FindPostings(TypePostings, Type);
+}
+
+TConstArrayView<FPlayFabCatalogItemHandle> FPlayFabCatalogIndex::QueryContentType(const FString& ContentType) const
+{
+	return FindPostings(ContentTypePostings, ContentType);
+}
+
+TArray<FPlayFabCatalogItemHandle> FPlayFabCatalogIndex::QueryPrice(const FString& CurrencyId, const int32 MinPrice, const int32 MaxPrice) const
+{
+	FPlayFabCatalogQuery PriceQuery;
+	PriceQuery.CurrencyId = CurrencyId;
+	PriceQuery.MinPrice = MinPrice;
+	PriceQuery.MaxPrice = MaxPrice;
+	PriceQuery.Sort = EPlayFabCatalogSort::PriceAscending;
+
+	return Query(PriceQuery);
+}
+
+TArray<FPlayFabCatalogItemHandle> FPlayFabCatalogIndex::Query(const FPlayFabCatalogQuery& Query) const
+{
+	// Items have no single price to sort by without a currency, so silently returning index order would look sorted but not be.
+	if (Query.Sort != EPlayFabCatalogSort::None && Query.CurrencyId.IsEmpty())
+	{
+		UE_LOG(LogPlayFabCatalogIndex, Warning, TEXT("Catalog queries sorted by price need a CurrencyId."));
+
+		return {};
+	}
+
+	TArray<TConstArrayView<FPlayFabCatalogItemHandle>, TInlineAllocator<8>> Filters;
+
+	for (const FString& Tag : Query.Tags)
+	{
+		Filters.Add(QueryTag(Tag));
+	}
+
+	if (!Query.Type.IsEmpty())
+	{
+		Filters.Add(QueryType(Query.Type));
+	}
+
+	if (!Query.ContentType.IsEmpty())
+	{
+		Filters.Add(QueryContentType(Query.ContentType));
+	}
+
+	Algo::SortBy(Filters, &TConstArrayView<FPlayFabCatalogItemHandle>::Num);
+
+	TArray<FPlayFabCatalogItemHandle> Candidates;
+
+	if (!Filters.IsEmpty())
+	{
+		Candidates = TArray<FPlayFabCatalogItemHandle>(Filters[0]);
+
+		for (int32 Index = 1; Index < Filters.Num() && !Candidates.IsEmpty(); ++Index)
+		{
+			Candidates = Intersect(Candidates, Filters[Index]);
+		}
+
+		if (Candidates.IsEmpty())
+		{
+			return {};
+		}
+	}
+
+	if (Query.CurrencyId.IsEmpty())
+	{
+		if (Filters.IsEmpty())
+		{
+			Candidates.Reserve(Items.Num());
+			for (int32 Index = 0; Index < Items.Num(); ++Index)
+			{
+				Candidates.Add({ Index });
+			}
+		}
+
+		return Candidates;
+	}
+
+	const TArray<FPriceEntry>* CurrencyPrices = FindPrices(FindString(Query.CurrencyId));
+	if (!CurrencyPrices)
+	{
+		return {};
+	}
+
+	const int32 First = Algo::LowerBoundBy(*CurrencyPrices, Query.MinPrice, &FPriceEntry::Amount);
+	const int32 Last = Algo::UpperBoundBy(*CurrencyPrices, Query.MaxPrice, &FPriceEntry::Amount);
+
+	TBitArray<> CandidateBits;
+	if (!Filters.IsEmpty())
+	{
+		CandidateBits.Init(false, Items.Num());
+		for (const FPlayFabCatalogItemHandle Handle : Candidates)
+		{
+			CandidateBits[Handle.Index] = true;
+		}
+	}
+
+	TArray<FPlayFabCatalogItemHandle> Result;
+	Result.Reserve(FMath::Max(Last - First, 0));
+
+	for (int32 Index = First; Index < Last; ++Index)
+	{
+		const FPlayFabCatalogItemHandle Handle = (*CurrencyPrices)[Index].Item;
+		if (Filters.IsEmpty() || CandidateBits[Handle.Index])
+		{
+			Result.Add(Handle);
+		}
+	}
+
+	switch (Query.Sort)
+	{
+	case EPlayFabCatalogSort::None:
+		Result.Sort();
+		break;
+	case EPlayFabCatalogSort::PriceDescending:
+		Algo::Reverse(Result);
+		break;
+	default:
+		break;
+	}
+
+	return Result;
+}
+
+TArray<FPlayFabCatalogItemHandle> FPlayFabCatalogIndex::Intersect(TConstArrayView<FPlayFabCatalogItemHandle> A,
+	TConstArrayView<FPlayFabCatalogItemHandle> B)
+{
+	TArray<FPlayFabCatalogItemHandle> Result;
+	Result.Reserve(FMath::Min(A.Num(), B.Num()));
+
+	int32 IndexA = 0;
+	int32 IndexB = 0;
+
+	while (IndexA < A.Num() && IndexB < B.Num())
+	{
+		if (A[IndexA] < B[IndexB])
+		{
+			++IndexA;
+		}
+		else if (B[IndexB] < A[IndexA])
+		{
+			++IndexB;
+		}
+		else
+		{
+			Result.Add(A[IndexA]);
+			++IndexA;
+			++IndexB;
+		}
+	}
+
+	return Result;
+}
+
+int32 FPlayFabCatalogIndex::Intern(const FString& String)
+{
+	if (const int32* Existing = StringIds.Find(String))
+	{
+		return *Existing;
+	}
+
+	const int32 Id = Strings.Add(String);
+	StringIds.Add(String, Id);
+
+	return Id;
+}
+
+int32 FPlayFabCatalogIndex::FindString(const FString& String) const
+{
+	const int32* Id = StringIds.Find(String);
+
+	return Id ? *Id : INDEX_NONE;
+}
+
+void FPlayFabCatalogIndex::Unindex(const FPlayFabCatalogItemHandle Handle)
+{
+	const auto RemoveSorted = [Handle](TArray<FPlayFabCatalogItemHandle>* Postings)
+	{
+		if (!Postings)
+		{
+			return;
+		}
+
+		if (const int32 Found = Algo::BinarySearch(*Postings, Handle); Found != INDEX_NONE)
+		{
+			Postings->RemoveAt(Found, 1, EAllowShrinking::No);
+		}
+	};
+
+	RemoveSorted(TypePostings.Find(TypeColumn[Handle.Index]));
+	RemoveSorted(ContentTypePostings.Find(ContentTypeColumn[Handle.Index]));
+
+	for (const int32 Tag : TagColumn[Handle.Index])
+	{
+		RemoveSorted(TagPostings.Find(Tag));
+	}
+
+	for (const TPair<int32, int32>& Price : PriceColumn[Handle.Index])
+	{
+		if (TArray<FPriceEntry>* CurrencyPrices = Prices.Find(Price.Key))
+		{
+			CurrencyPrices->RemoveAll([Handle](const FPriceEntry& Entry)
+			{
+				return Entry.Item == Handle;
+			});
+		}
+	}
+
+	TypeColumn[Handle.Index] = INDEX_NONE;
+	ContentTypeColumn[Handle.Index] = INDEX_NONE;
+	TagColumn[Handle.Index].Reset();
+	PriceColumn[Handle.Index].Reset();
+}
+
+void FPlayFabCatalogIndex::Index(const FPlayFabCatalogItemHandle Handle)
+{
+	const PlayFab::EconomyModels::FCatalogItem& Item = *Items[Handle.Index];
+
+	TypeColumn[Handle.Index] = Item.Type.IsEmpty() ? INDEX_NONE : Intern(Item.Type);
+	if (TypeColumn[Handle.Index] != INDEX_NONE)
+	{
+		InsertSorted(TypePostings.FindOrAdd(TypeColumn[Handle.Index]), Handle);
+	}
+
+	ContentTypeColumn[Handle.Index] = Item.ContentType.IsEmpty() ? INDEX_NONE : Intern(Item.ContentType);
+	if (ContentTypeColumn[Handle.Index] != INDEX_NONE)
+	{
+		InsertSorted(ContentTypePostings.FindOrAdd(ContentTypeColumn[Handle.Index]), Handle);
+	}
+
+	for (const FString& Tag : Item.Tags)
+	{
+		const int32 TagId = Intern(Tag);
+		TagColumn[Handle.Index].AddUnique(TagId);
+		InsertSorted(TagPostings.FindOrAdd(TagId), Handle);
+	}
+
+	if (!Item.PriceOptions.IsValid())
+	{
+		return;
+	}
+
+	// Keep the lowest amount per currency, an item may be listed under several price options.
+	TArray<TPair<int32, int32>>& ItemPrices = PriceColumn[Handle.Index];
+
+	for (const PlayFab::EconomyModels::FCatalogPrice& Price : Item.PriceOptions->Prices)
+	{
+		for (const PlayFab::EconomyModels::FCatalogPriceAmount& Amount : Price.Amounts)
+		{
+			const int32 Currency = Intern(Amount.ItemId);
+
+			TPair<int32, int32>* Existing = ItemPrices.FindByPredicate([Currency](const TPair<int32, int32>& Pair)
+			{
+				return Pair.Key == Currency;
+			});
+
+			if (!Existing)
+			{
+				ItemPrices.Emplace(Currency, Amount.Amount);
+			}
+			else if (Amount.Amount < Existing->Value)
+			{
+				Existing->Value = Amount.Amount;
+			}
+		}
+	}
+
+	for (const TPair<int32, int32>& Price : ItemPrices)
+	{
+		Prices.FindOrAdd(Price.Key).Add({ Price.Value, Handle });
+	}
+}
+
+void FPlayFabCatalogIndex::InsertSorted(TArray<FPlayFabCatalogItemHandle>& Postings, const FPlayFabCatalogItemHandle Handle)
+{
+	const int32 Position = Algo::LowerBound(Postings, Handle);
+	if (!Postings.IsValidIndex(Position) || Postings[Position] != Handle)
+	{
+		Postings.Insert(Handle, Position);
+	}
+}
+
+const TArray<FPlayFabCatalogIndex::FPriceEntry>* FPlayFabCatalogIndex::FindPrices(const int32 Currency) const
+{
+	TArray<FPriceEntry>* CurrencyPrices = Prices.Find(Currency);
+
+	if (CurrencyPrices && UnsortedCurrencies.Remove(Currency) > 0)
+	{
+		Algo::SortBy(*CurrencyPrices, &FPriceEntry::Amount);
+	}
+
+	return CurrencyPrices;
+}
+
+TConstArrayView<FPlayFabCatalogItemHandle> FPlayFabCatalogIndex::FindPostings(
+	const TMap<int32, TArray<FPlayFabCatalogItemHandle>>& Postings, const FString& Key) const
+{
+	const TArray<FPlayFabCatalogItemHandle>* Found = Postings.Find(FindString(Key));
+
+	return Found ? TConstArrayView<FPlayFabCatalogItemHandle>(*Found) : TConstArrayView<FPlayFabCatalogItemHandle>();
+}
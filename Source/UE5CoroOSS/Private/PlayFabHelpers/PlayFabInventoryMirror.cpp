@@ -0,0 +1,109 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "PlayFabHelpers/PlayFabInventoryMirror.h"
+
+void FPlayFabInventoryMirror::Reset(TArray<PlayFab::EconomyModels::FInventoryItem> NewItems, const FString& NewETag)
+{
+	Items.Reset();
+	Items.Reserve(NewItems.Num());
+
+	for (PlayFab::EconomyModels::FInventoryItem& Item : NewItems)
+	{
+		const FString Key = MakeStackKey(Item.Id, Item.StackId);
+		Items.Add(Key, MoveTemp(Item));
+	}
+
+	ETag = NewETag;
+	bStale = false;
+}
+
+void FPlayFabInventoryMirror::ApplyPurchase(const PlayFab::EconomyModels::FPurchaseInventoryItemsRequest& Request,
+	const PlayFab::EconomyModels::FPurchaseInventoryItemsResponse& Response, const bool bIsBundle)
+{
+	ETag = Response.ETag;
+
+	if (bIsBundle || !Request.Item.IsValid() || Request.Item->Id.IsEmpty())
+	{
+		bStale = true;
+		return;
+	}
+
+	AddAmount(Request.Item->Id, Request.Item->StackId, Request.Amount.notNull() ? Request.Amount.mValue : 1);
+
+	for (const PlayFab::EconomyModels::FPurchasePriceAmount& Price : Request.PriceAmounts)
+	{
+		AddAmount(Price.ItemId, Price.StackId, -Price.Amount);
+	}
+}
+
+const PlayFab::EconomyModels::FInventoryItem* FPlayFabInventoryMirror::FindItem(const FString& ItemId, const FString& StackId) const
+{
+	return Items.Find(MakeStackKey(ItemId, StackId));
+}
+
+int32 FPlayFabInventoryMirror::GetAmount(const FString& ItemId, const FString& StackId) const
+{
+	const PlayFab::EconomyModels::FInventoryItem* Item = FindItem(ItemId, StackId);
+
+	return Item && Item->Amount.notNull() ? Item->Amount.mValue : 0;
+}
+
+const TMap<FString, PlayFab::EconomyModels::FInventoryItem>& FPlayFabInventoryMirror::GetItems() const
+{
+	return Items;
+}
+
+const FString& FPlayFabInventoryMirror::GetETag() const
+{
+	return ETag;
+}
+
+bool FPlayFabInventoryMirror::IsStale() const
+{
+	return bStale;
+}
+
+void FPlayFabInventoryMirror::MarkStale()
+{
+	bStale = true;
+}
+
+FString FPlayFabInventoryMirror::MakeStackKey(const FString& ItemId, const FString& StackId)
+{
+	return ItemId + TEXT("/") + (StackId.IsEmpty() ? TEXT("default") : *StackId);
+}
+
+void FPlayFabInventoryMirror::AddAmount(const FString& ItemId, const FString& StackId, const int32 Amount)
+{
+	const FString Key = MakeStackKey(ItemId, StackId);
+
+	PlayFab::EconomyModels::FInventoryItem* Item = Items.Find(Key);
+	if (!Item)
+	{
+		if (Amount <= 0)
+		{
+			// Paying with something we do not hold means the mirror is already out of date.
+			bStale = true;
+			return;
+		}
+
+		Item = &Items.Add(Key);
+		Item->Id = ItemId;
+		Item->StackId = StackId;
+		Item->Amount = 0;
+	}
+
+	const int32 NewAmount = (Item->Amount.notNull() ? Item->Amount.mValue : 0) + Amount;
+	if (NewAmount < 0)
+	{
+		bStale = true;
+	}
+
+	if (NewAmount <= 0)
+	{
+		Items.Remove(Key);
+		return;
+	}
+
+	Item->Amount = NewAmount;
+}
@@ -0,0 +1,194 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "PlayFabHelpers/PlayFabScheduler.h"
+#include "HAL/IConsoleManager.h"
+#include "PlayFabHelpers/PlayFabCall.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Requests In Flight"), STAT_PlayFabRequestsInFlight, STATGROUP_UE5CoroOSSPlayFab);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Requests Waiting"), STAT_PlayFabRequestsWaiting, STATGROUP_UE5CoroOSSPlayFab);
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		int32 MaxInFlight = 8;
+		FAutoConsoleVariableRef CVarMaxInFlight(
+			TEXT("oss.playfab.maxinflight"),
+			MaxInFlight,
+			TEXT("Maximum number of PlayFab requests in flight at once, across all priority classes."));
+
+		int32 MaxCriticalInFlight = 8;
+		FAutoConsoleVariableRef CVarMaxCriticalInFlight(
+			TEXT("oss.playfab.maxinflight.critical"),
+			MaxCriticalInFlight,
+			TEXT("Maximum number of critical PlayFab requests, such as logins and purchases, in flight at once."));
+
+		int32 MaxInteractiveInFlight = 6;
+		FAutoConsoleVariableRef CVarMaxInteractiveInFlight(
+			TEXT("oss.playfab.maxinflight.interactive"),
+			MaxInteractiveInFlight,
+			TEXT("Maximum number of interactive PlayFab requests in flight at once."));
+
+		int32 MaxBackgroundInFlight = 2;
+		FAutoConsoleVariableRef CVarMaxBackgroundInFlight(
+			TEXT("oss.playfab.maxinflight.background"),
+			MaxBackgroundInFlight,
+			TEXT("Maximum number of background PlayFab requests, such as prefetches, in flight at once."));
+
+		float PriorityAging = 2.0f;
+		FAutoConsoleVariableRef CVarPriorityAging(
+			TEXT("oss.playfab.priorityaging"),
+			PriorityAging,
+			TEXT("Seconds a waiting PlayFab request spends in the queue before it is ranked one priority class higher."));
+
+		thread_local TOptional<EPlayFabPriority> ScopedPriority;
+
+		class FPlayFabScheduler final
+		{
+		public:
+
+			static FPlayFabScheduler& Get()
+			{
+				static FPlayFabScheduler Scheduler;
+				return Scheduler;
+			}
+
+			void Enqueue(const TSharedRef<FPlayFabSlot::FState>& State)
+			{
+				check(IsInGameThread());
+
+				State->QueuedTime = FPlatformTime::Seconds();
+				Waiting.Add(State);
+				INC_DWORD_STAT(STAT_PlayFabRequestsWaiting);
+
+				Dispatch();
+			}
+
+			void Release(const TSharedRef<FPlayFabSlot::FState>& State)
+			{
+				check(IsInGameThread());
+
+				if (!State->bGranted)
+				{
+					if (Waiting.Remove(State) > 0)
+					{
+						DEC_DWORD_STAT(STAT_PlayFabRequestsWaiting);
+					}
+					return;
+				}
+
+				--InFlight[static_cast<uint8>(State->Priority)];
+				--TotalInFlight;
+				DEC_DWORD_STAT(STAT_PlayFabRequestsInFlight);
+
+				Dispatch();
+			}
+
+		private:
+
+			static int32 GetClassLimit(const EPlayFabPriority Priority)
+			{
+				switch (Priority)
+				{
+				case EPlayFabPriority::Critical:
+					return MaxCriticalInFlight;
+				case EPlayFabPriority::Interactive:
+					return MaxInteractiveInFlight;
+				default:
+					return MaxBackgroundInFlight;
+				}
+			}
+
+			bool HasCapacity(const EPlayFabPriority Priority) const
+			{
+				return TotalInFlight < FMath::Max(1, MaxInFlight) && InFlight[static_cast<uint8>(Priority)] < FMath::Max(1, GetClassLimit(Priority));
+			}
+
+			static int32 GetRank(const FPlayFabSlot::FState& State, const double Now)
+			{
+				const int32 Promotions = PriorityAging > 0.0f ? FMath::FloorToInt32((Now - State.QueuedTime) / PriorityAging) : 0;
+
+				return FMath::Max(0, static_cast<int32>(State.Priority) - Promotions);
+			}
+
+			void Dispatch()
+			{
+				const double Now = FPlatformTime::Seconds();
+
+				while (!Waiting.IsEmpty())
+				{
+					// Waiting is in arrival order, so the first of the best rank is also the oldest.
+					int32 BestIndex = INDEX_NONE;
+					int32 BestRank = MAX_int32;
+
+					for (int32 Index = 0; Index < Waiting.Num(); ++Index)
+					{
+						const FPlayFabSlot::FState& State = *Waiting[Index];
+
+						if (const int32 Rank = GetRank(State, Now); Rank < BestRank && HasCapacity(State.Priority))
+						{
+							BestIndex = Index;
+							BestRank = Rank;
+						}
+					}
+
+					if (BestIndex == INDEX_NONE)
+					{
+						return;
+					}
+
+					const TSharedRef<FPlayFabSlot::FState> State = Waiting[BestIndex];
+					Waiting.RemoveAt(BestIndex);
+					DEC_DWORD_STAT(STAT_PlayFabRequestsWaiting);
+
+					++InFlight[static_cast<uint8>(State->Priority)];
+					++TotalInFlight;
+					INC_DWORD_STAT(STAT_PlayFabRequestsInFlight);
+
+					State->bGranted = true;
+					State->Granted.Trigger();
+				}
+			}
+
+			TArray<TSharedRef<FPlayFabSlot::FState>> Waiting;
+
+			int32 InFlight[3] = {};
+
+			int32 TotalInFlight = 0;
+		};
+	} // namespace Private
+
+	EPlayFabPriority GetPlayFabPriority(const EPlayFabPriority Default)
+	{
+		return Private::ScopedPriority.Get(Default);
+	}
+
+	FScopedPlayFabPriority::FScopedPlayFabPriority(const EPlayFabPriority Priority)
+		: PreviousPriority(Private::ScopedPriority)
+	{
+		Private::ScopedPriority = Priority;
+	}
+
+	FScopedPlayFabPriority::~FScopedPlayFabPriority()
+	{
+		Private::ScopedPriority = PreviousPriority;
+	}
+
+	FPlayFabSlot::FPlayFabSlot(const EPlayFabPriority Priority)
+		: State(MakeShared<FState>())
+	{
+		State->Priority = Priority;
+
+		Private::FPlayFabScheduler::Get().Enqueue(State);
+	}
+
+	FPlayFabSlot::~FPlayFabSlot()
+	{
+		Private::FPlayFabScheduler::Get().Release(State);
+	}
+
+	FAwaitableEvent& FPlayFabSlot::WhenGranted() const
+	{
+		return State->Granted;
+	}
+} // namespace UE5CoroOSS
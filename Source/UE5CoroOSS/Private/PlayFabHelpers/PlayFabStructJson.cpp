@@ -0,0 +1,316 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "PlayFabHelpers/PlayFabStructJson.h"
+#include "JsonObjectConverter.h"
+#include "Misc/ScopeExit.h"
+#include "UObject/EnumProperty.h"
+#include "UObject/TextProperty.h"
+#include "UObject/UnrealType.h"
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		void WriteStructBody(FCondensedJsonWriter& Writer, const UStruct* Struct, const void* Data);
+
+		void WriteValueJson(FCondensedJsonWriter& Writer, const FProperty* Property, const void* Value)
+		{
+			if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+			{
+				Writer.WriteObjectStart();
+				WriteStructBody(Writer, StructProperty->Struct, Value);
+				Writer.WriteObjectEnd();
+			}
+			else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+			{
+				FScriptArrayHelper Helper(ArrayProperty, Value);
+
+				Writer.WriteArrayStart();
+				for (int32 Index = 0; Index < Helper.Num(); ++Index)
+				{
+					WriteValueJson(Writer, ArrayProperty->Inner, Helper.GetRawPtr(Index));
+				}
+				Writer.WriteArrayEnd();
+			}
+			else if (const FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+			{
+				FScriptMapHelper Helper(MapProperty, Value);
+
+				Writer.WriteObjectStart();
+				for (FScriptMapHelper::FIterator It(Helper); It; ++It)
+				{
+					FString Key;
+					MapProperty->KeyProp->ExportTextItem_Direct(Key, Helper.GetKeyPtr(It), nullptr, nullptr, PPF_None);
+
+					Writer.WriteIdentifierPrefix(Key);
+					WriteValueJson(Writer, MapProperty->ValueProp, Helper.GetValuePtr(It));
+				}
+				Writer.WriteObjectEnd();
+			}
+			else if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+			{
+				const int64 EnumValue = EnumProperty->GetUnderlyingProperty()->GetSignedIntPropertyValue(Value);
+				Writer.WriteValue(EnumProperty->GetEnum()->GetNameStringByValue(EnumValue));
+			}
+			else if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+			{
+				if (const UEnum* Enum = NumericProperty->GetIntPropertyEnum())
+				{
+					Writer.WriteValue(Enum->GetNameStringByValue(NumericProperty->GetSignedIntPropertyValue(Value)));
+				}
+				else if (NumericProperty->IsFloatingPoint())
+				{
+					Writer.WriteValue(NumericProperty->GetFloatingPointPropertyValue(Value));
+				}
+				else
+				{
+					Writer.WriteValue(NumericProperty->GetSignedIntPropertyValue(Value));
+				}
+			}
+			else if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+			{
+				Writer.WriteValue(BoolProperty->GetPropertyValue(Value));
+			}
+			else if (CastField<FStrProperty>(Property))
+			{
+				Writer.WriteValue(*static_cast<const FString*>(Value));
+			}
+			else if (CastField<FNameProperty>(Property))
+			{
+				Writer.WriteValue(static_cast<const FName*>(Value)->ToString());
+			}
+			else if (CastField<FTextProperty>(Property))
+			{
+				Writer.WriteValue(static_cast<const FText*>(Value)->ToString());
+			}
+			else
+			{
+				Writer.WriteNull();
+			}
+		}
+
+		void WriteStructBody(FCondensedJsonWriter& Writer, const UStruct* Struct, const void* Data)
+		{
+			for (TFieldIterator<FProperty> It(Struct); It; ++It)
+			{
+				Writer.WriteIdentifierPrefix(FJsonObjectConverter::StandardizeCase(It->GetAuthoredName()));
+				WriteValueJson(Writer, *It, It->ContainerPtrToValuePtr<void>(Data));
+			}
+		}
+
+		bool ReadStructBody(TJsonReader<>& Reader, const UStruct* Struct, void* Data);
+
+		bool ReadValueJson(TJsonReader<>& Reader, const EJsonNotation Notation, const FProperty* Property, void* Value)
+		{
+			if (Notation == EJsonNotation::Null)
+			{
+				return true;
+			}
+
+			if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+			{
+				return Notation == EJsonNotation::ObjectStart
+					? ReadStructBody(Reader, StructProperty->Struct, Value) : SkipJsonValue(Reader, Notation);
+			}
+
+			if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+			{
+				if (Notation != EJsonNotation::ArrayStart)
+				{
+					return SkipJsonValue(Reader, Notation);
+				}
+
+				FScriptArrayHelper Helper(ArrayProperty, Value);
+				Helper.EmptyValues();
+
+				EJsonNotation ElementNotation;
+				while (Reader.ReadNext(ElementNotation))
+				{
+					if (ElementNotation == EJsonNotation::ArrayEnd)
+					{
+						return true;
+					}
+
+					const int32 Index = Helper.AddValue();
+					if (!ReadValueJson(Reader, ElementNotation, ArrayProperty->Inner, Helper.GetRawPtr(Index)))
+					{
+						return false;
+					}
+				}
+
+				return false;
+			}
+
+			if (const FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+			{
+				if (Notation != EJsonNotation::ObjectStart)
+				{
+					return SkipJsonValue(Reader, Notation);
+				}
+
+				FScriptMapHelper Helper(MapProperty, Value);
+				Helper.EmptyValues();
+
+				ON_SCOPE_EXIT
+				{
+					Helper.Rehash();
+				};
+
+				EJsonNotation PairNotation;
+				while (Reader.ReadNext(PairNotation))
+				{
+					if (PairNotation == EJsonNotation::ObjectEnd)
+					{
+						return true;
+					}
+
+					const int32 Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+					MapProperty->KeyProp->ImportText_Direct(*Reader.GetIdentifier(), Helper.GetKeyPtr(Index), nullptr, PPF_None);
+
+					if (!ReadValueJson(Reader, PairNotation, MapProperty->ValueProp, Helper.GetValuePtr(Index)))
+					{
+						return false;
+					}
+				}
+
+				return false;
+			}
+
+			if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+			{
+				if (Notation == EJsonNotation::String)
+				{
+					if (const int64 EnumValue = EnumProperty->GetEnum()->GetValueByNameString(Reader.GetValueAsString());
+						EnumValue != INDEX_NONE)
+					{
+						EnumProperty->GetUnderlyingProperty()->SetIntPropertyValue(Value, EnumValue);
+					}
+				}
+				else if (Notation == EJsonNotation::Number)
+				{
+					EnumProperty->GetUnderlyingProperty()->SetIntPropertyValue(Value, static_cast<int64>(Reader.GetValueAsNumber()));
+				}
+
+				return true;
+			}
+
+			if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+			{
+				if (Notation == EJsonNotation::String)
+				{
+					if (const UEnum* Enum = NumericProperty->GetIntPropertyEnum())
+					{
+						if (const int64 EnumValue = Enum->GetValueByNameString(Reader.GetValueAsString()); EnumValue != INDEX_NONE)
+						{
+							NumericProperty->SetIntPropertyValue(Value, EnumValue);
+						}
+					}
+				}
+				else if (Notation == EJsonNotation::Number)
+				{
+					if (NumericProperty->IsFloatingPoint())
+					{
+						NumericProperty->SetFloatingPointPropertyValue(Value, Reader.GetValueAsNumber());
+					}
+					else
+					{
+						// Parsed from the literal so 64 bit ids do not lose precision through double.
+						NumericProperty->SetNumericPropertyValueFromString(Value, *Reader.GetValueAsNumberString());
+					}
+				}
+
+				return true;
+			}
+
+			if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+			{
+				if (Notation == EJsonNotation::Boolean)
+				{
+					BoolProperty->SetPropertyValue(Value, Reader.GetValueAsBoolean());
+				}
+
+				return true;
+			}
+
+			if (Notation == EJsonNotation::String || Notation == EJsonNotation::Number || Notation == EJsonNotation::Boolean)
+			{
+				const FString String = Notation == EJsonNotation::String ? Reader.GetValueAsString()
+					: Notation == EJsonNotation::Number ? Reader.GetValueAsNumberString()
+					: LexToString(Reader.GetValueAsBoolean());
+
+				if (CastField<FStrProperty>(Property))
+				{
+					*static_cast<FString*>(Value) = String;
+				}
+				else if (CastField<FNameProperty>(Property))
+				{
+					*static_cast<FName*>(Value) = FName(String);
+				}
+				else if (CastField<FTextProperty>(Property))
+				{
+					*static_cast<FText*>(Value) = FText::FromString(String);
+				}
+
+				return true;
+			}
+
+			return SkipJsonValue(Reader, Notation);
+		}
+
+		bool ReadStructBody(TJsonReader<>& Reader, const UStruct* Struct, void* Data)
+		{
+			EJsonNotation Notation;
+			while (Reader.ReadNext(Notation))
+			{
+				if (Notation == EJsonNotation::ObjectEnd)
+				{
+					return true;
+				}
+
+				if (Notation == EJsonNotation::Error)
+				{
+					return false;
+				}
+
+				// FName comparison is case-insensitive, and FNAME_Find avoids adding names for unknown fields.
+				const FName FieldName(Reader.GetIdentifier(), FNAME_Find);
+				const FProperty* Property = FieldName.IsNone() ? nullptr : Struct->FindPropertyByName(FieldName);
+
+				if (!(Property ? ReadValueJson(Reader, Notation, Property, Property->ContainerPtrToValuePtr<void>(Data))
+					: SkipJsonValue(Reader, Notation)))
+				{
+					return false;
+				}
+			}
+
+			return false;
+		}
+	} // namespace Private
+
+	void WriteStructJson(FCondensedJsonWriter& Writer, const UScriptStruct* Struct, const void* Data)
+	{
+		Writer.WriteObjectStart();
+		Private::WriteStructBody(Writer, Struct, Data);
+		Writer.WriteObjectEnd();
+	}
+
+	bool ReadStructJson(TJsonReader<>& Reader, const EJsonNotation Notation, const UScriptStruct* Struct, void* Data)
+	{
+		return Notation == EJsonNotation::ObjectStart ? Private::ReadStructBody(Reader, Struct, Data) : SkipJsonValue(Reader, Notation);
+	}
+
+	bool SkipJsonValue(TJsonReader<>& Reader, const EJsonNotation Notation)
+	{
+		switch (Notation)
+		{
+		case EJsonNotation::ObjectStart:
+			return Reader.SkipObject();
+		case EJsonNotation::ArrayStart:
+			return Reader.SkipArray();
+		case EJsonNotation::Error:
+			return false;
+		default:
+			return true;
+		}
+	}
+} // namespace UE5CoroOSS
@@ -0,0 +1,197 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "PlayFabHelpers/PlayFabTitleNewsCache.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPlayFabTitleNewsCache, Log, All);
+
+namespace UE5CoroOSS::Private
+{
+	constexpr uint32 TITLE_NEWS_CACHE_MAGIC = 0x434E5450; // 'PTNC'
+	constexpr int32 TITLE_NEWS_CACHE_VERSION = 1;
+
+	// Three empty strings, serialized as their length, and the timestamp ticks.
+	constexpr int64 MIN_TITLE_NEWS_ITEM_SIZE = sizeof(int32) * 3 + sizeof(int64);
+} // namespace UE5CoroOSS::Private
+
+bool FPlayFabTitleNewsCache::Load(const FString& InFilePath)
+{
+	Items.Reset();
+	LastChecked = FDateTime::MinValue();
+	bDirty = false;
+
+	FilePath = InFilePath;
+
+	TArray<uint8> Bytes;
+	if (!FPaths::FileExists(FilePath) || !FFileHelper::LoadFileToArray(Bytes, *FilePath))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int64 CheckedTicks = 0;
+	int32 NumItems = 0;
+
+	Reader << Magic << Version << CheckedTicks << NumItems;
+
+	if (Reader.IsError() || Magic != UE5CoroOSS::Private::TITLE_NEWS_CACHE_MAGIC || Version != UE5CoroOSS::Private::TITLE_NEWS_CACHE_VERSION
+		|| NumItems < 0 || NumItems > (Reader.TotalSize() - Reader.Tell()) / UE5CoroOSS::Private::MIN_TITLE_NEWS_ITEM_SIZE)
+	{
+		UE_LOG(LogPlayFabTitleNewsCache, Warning, TEXT("Discarding unreadable title news cache (%s)"), *FilePath);
+		return false;
+	}
+
+	Items.Reserve(NumItems);
+
+	for (int32 Index = 0; Index < NumItems; ++Index)
+	{
+		PlayFab::ClientModels::FTitleNewsItem& Item = Items.AddDefaulted_GetRef();
+		int64 Ticks = 0;
+
+		Reader << Item.NewsId << Item.Title << Item.Body << Ticks;
+
+		Item.Timestamp = FDateTime(Ticks);
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogPlayFabTitleNewsCache, Warning, TEXT("Discarding unreadable title news cache (%s)"), *FilePath);
+
+		Items.Reset();
+		return false;
+	}
+
+	LastChecked = FDateTime(CheckedTicks);
+
+	return true;
+}
+
+bool FPlayFabTitleNewsCache::Save()
+{
+	if (!bDirty)
+	{
+		return true;
+	}
+
+	if (FilePath.IsEmpty())
+	{
+		return false;
+	}
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = UE5CoroOSS::Private::TITLE_NEWS_CACHE_MAGIC;
+	int32 Version = UE5CoroOSS::Private::TITLE_NEWS_CACHE_VERSION;
+	int64 CheckedTicks = LastChecked.GetTicks();
+	int32 NumItems = Items.Num();
+
+	Writer << Magic << Version << CheckedTicks << NumItems;
+
+	for (PlayFab::ClientModels::FTitleNewsItem& Item : Items)
+	{
+		int64 Ticks = Item.Timestamp.GetTicks();
+
+		Writer << Item.NewsId << Item.Title << Item.Body << Ticks;
+	}
+
+	const FString TempPath = FilePath + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*FilePath, *TempPath, true))
+	{
+		UE_LOG(LogPlayFabTitleNewsCache, Warning, TEXT("Failed to write title news cache (%s)"), *FilePath);
+		return false;
+	}
+
+	bDirty = false;
+
+	return true;
+}
+
+bool FPlayFabTitleNewsCache::Contains(const PlayFab::ClientModels::FTitleNewsItem& Item) const
+{
+	return Items.ContainsByPredicate([&Item](const PlayFab::ClientModels::FTitleNewsItem& Cached)
+	{
+		return Cached.NewsId == Item.NewsId && Cached.Timestamp == Item.Timestamp;
+	});
+}
+
+bool FPlayFabTitleNewsCache::Merge(const TArray<PlayFab::ClientModels::FTitleNewsItem>& NewItems, const bool bComplete,
+	const int32 MaxItems)
+{
+	bool bChanged = false;
+
+	if (bComplete)
+	{
+		bChanged = Items.RemoveAll([&NewItems](const PlayFab::ClientModels::FTitleNewsItem& Cached)
+		{
+			return !NewItems.ContainsByPredicate([&Cached](const PlayFab::ClientModels::FTitleNewsItem& Item)
+			{
+				return Item.NewsId == Cached.NewsId;
+			});
+		}) > 0;
+	}
+
+	for (const PlayFab::ClientModels::FTitleNewsItem& Item : NewItems)
+	{
+		if (Contains(Item))
+		{
+			continue;
+		}
+
+		PlayFab::ClientModels::FTitleNewsItem* Cached = Items.FindByPredicate([&Item](const PlayFab::ClientModels::FTitleNewsItem& Existing)
+		{
+			return Existing.NewsId == Item.NewsId;
+		});
+
+		if (Cached)
+		{
+			*Cached = Item;
+		}
+		else
+		{
+			Items.Add(Item);
+		}
+
+		bChanged = true;
+	}
+
+	if (bChanged)
+	{
+		Items.StableSort([](const PlayFab::ClientModels::FTitleNewsItem& A, const PlayFab::ClientModels::FTitleNewsItem& B)
+		{
+			return A.Timestamp > B.Timestamp;
+		});
+
+		if (Items.Num() > MaxItems)
+		{
+			Items.SetNum(FMath::Max(0, MaxItems));
+		}
+	}
+
+	bDirty |= bChanged;
+
+	return bChanged;
+}
+
+void FPlayFabTitleNewsCache::MarkChecked()
+{
+	LastChecked = FDateTime::UtcNow();
+	bDirty = true;
+}
+
+const TArray<PlayFab::ClientModels::FTitleNewsItem>& FPlayFabTitleNewsCache::GetItems() const
+{
+	return Items;
+}
+
+FDateTime FPlayFabTitleNewsCache::GetLastChecked() const
+{
+	return LastChecked;
+}
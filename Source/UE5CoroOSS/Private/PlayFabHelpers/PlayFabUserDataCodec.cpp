@@ -0,0 +1,138 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "PlayFabHelpers/PlayFabUserDataCodec.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Base64.h"
+#include "Misc/Compression.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPlayFabUserDataCodec, Log, All);
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		FString UserDataCodec = TEXT("Oodle");
+		FAutoConsoleVariableRef CVarUserDataCodec(
+			TEXT("oss.playfab.userdatacodec"),
+			UserDataCodec,
+			TEXT("Compression format of user data keys marked as compressed: Oodle or Zlib."));
+
+		/** Followed by <format>:<uncompressed size>:<base64 payload>. */
+		const TCHAR* USER_DATA_CODEC_MARKER = TEXT("~ue5cz1:");
+
+		/** PlayFab rejects user data values longer than this, so no stored payload is larger. */
+		constexpr int64 MAX_USER_DATA_VALUE_SIZE = 10000;
+
+		/** Best ratio a value is compressed at. Encoding keeps to it, so a value claiming more is corrupt. */
+		constexpr int64 MAX_USER_DATA_COMPRESSION_RATIO = 1032;
+	} // namespace Private
+
+	bool IsEncodedUserData(const FString& Value)
+	{
+		return Value.StartsWith(Private::USER_DATA_CODEC_MARKER, ESearchCase::CaseSensitive);
+	}
+
+	bool EncodeUserData(const FString& Value, FString& OutEncoded)
+	{
+		const FName Format = Private::UserDataCodec == TEXT("Zlib") ? NAME_Zlib : NAME_Oodle;
+
+		const FTCHARToUTF8 Utf8(*Value);
+		const int32 UncompressedSize = Utf8.Length();
+
+		int32 CompressedSize = FCompression::CompressMemoryBound(Format, UncompressedSize);
+
+		TArray<uint8> Compressed;
+		Compressed.SetNumUninitialized(CompressedSize);
+
+		if (!FCompression::CompressMemory(Format, Compressed.GetData(), CompressedSize, Utf8.Get(), UncompressedSize))
+		{
+			UE_LOG(LogPlayFabUserDataCodec, Warning, TEXT("Failed to compress a user data value with %s"), *Format.ToString());
+			return false;
+		}
+
+		Compressed.SetNum(CompressedSize, EAllowShrinking::No);
+
+		if (UncompressedSize > CompressedSize * Private::MAX_USER_DATA_COMPRESSION_RATIO)
+		{
+			// Decoding would reject the value as corrupt.
+			return false;
+		}
+
+		OutEncoded = FString::Printf(TEXT("%s%s:%d:%s"), Private::USER_DATA_CODEC_MARKER, *Format.ToString(), UncompressedSize,
+			*FBase64::Encode(Compressed));
+
+		return OutEncoded.Len() < Value.Len();
+	}
+
+	bool DecodeUserData(const FString& Value, FString& OutDecoded)
+	{
+		if (!IsEncodedUserData(Value))
+		{
+			return false;
+		}
+
+		TArray<FString> Parts;
+		if (Value.RightChop(FCString::Strlen(Private::USER_DATA_CODEC_MARKER)).ParseIntoArray(Parts, TEXT(":"), false) != 3)
+		{
+			return false;
+		}
+
+		const FName Format(*Parts[0]);
+		const int32 UncompressedSize = FCString::Atoi(*Parts[1]);
+
+		TArray<uint8> Compressed;
+		if (UncompressedSize < 0 || !FBase64::Decode(Parts[2], Compressed))
+		{
+			return false;
+		}
+
+		// The size is read from the value, so it is checked before it is allocated.
+		const int64 MaxUncompressedSize = FMath::Min<int64>(Compressed.Num(), Private::MAX_USER_DATA_VALUE_SIZE)
+			* Private::MAX_USER_DATA_COMPRESSION_RATIO;
+
+		if (UncompressedSize > MaxUncompressedSize)
+		{
+			UE_LOG(LogPlayFabUserDataCodec, Warning, TEXT("Rejecting a user data value claiming %d bytes from %d compressed"),
+				UncompressedSize, Compressed.Num());
+			return false;
+		}
+
+		TArray<uint8> Uncompressed;
+		Uncompressed.SetNumUninitialized(UncompressedSize);
+
+		if (!FCompression::UncompressMemory(Format, Uncompressed.GetData(), UncompressedSize, Compressed.GetData(), Compressed.Num()))
+		{
+			UE_LOG(LogPlayFabUserDataCodec, Warning, TEXT("Failed to decompress a user data value with %s"), *Format.ToString());
+			return false;
+		}
+
+		OutDecoded = FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Uncompressed.GetData()), Uncompressed.Num()));
+
+		return true;
+	}
+
+	bool HasEncodedUserData(const TMap<FString, PlayFab::ClientModels::FUserDataRecord>& Data)
+	{
+		for (const TPair<FString, PlayFab::ClientModels::FUserDataRecord>& Record : Data)
+		{
+			if (IsEncodedUserData(Record.Value.Value))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void DecodeUserDataRecords(TMap<FString, PlayFab::ClientModels::FUserDataRecord>& Data)
+	{
+		for (TPair<FString, PlayFab::ClientModels::FUserDataRecord>& Record : Data)
+		{
+			FString Decoded;
+			if (DecodeUserData(Record.Value.Value, Decoded))
+			{
+				Record.Value.Value = MoveTemp(Decoded);
+			}
+		}
+	}
+} // namespace UE5CoroOSS
@@ -1,6 +1,8 @@
 ﻿// Copyright No Bright Shadows. All Rights Reserved.
 
 #include "UE5CoroOSS_Shared.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
 
 namespace UE5CoroOSS
 {
@@ -21,6 +23,67 @@ namespace UE5CoroOSS
 			TEXT("oss.asynclogintimeout"),
 			AsyncLoginTimeout,
 			TEXT("Time to wait before abandoning an async AutoLogin operation."));
+
+		/**
+		 * Default subsystems resolved by GetGameInstanceSubsystem, indexed by the slot each subsystem type allocates.
+		 * Only filled while a single game instance runs, as a lookup without a world context is ambiguous otherwise.
+		 */
+		TArray<TWeakObjectPtr<USubsystem>> CachedSubsystems;
+
+		/** The game instance owning the game or PIE world, and how many such game instances are running. */
+		UGameInstance* FindDefaultGameInstance(int32& OutNumGameInstances)
+		{
+			UGameInstance* Found = nullptr;
+			OutNumGameInstances = 0;
+
+			for (const FWorldContext& Context : GEngine->GetWorldContexts())
+			{
+				if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.OwningGameInstance)
+				{
+					Found = Found ? Found : Context.OwningGameInstance.Get();
+					++OutNumGameInstances;
+				}
+			}
+
+			return Found;
+		}
+
+		/** A new game instance makes every cached subsystem a guess, so they are resolved again from then on. */
+		void ForgetCachedSubsystems(UGameInstance*)
+		{
+			for (TWeakObjectPtr<USubsystem>& Cached : CachedSubsystems)
+			{
+				Cached.Reset();
+			}
+		}
+
+		int32 AllocateSubsystemSlot()
+		{
+			check(IsInGameThread());
+
+			if (CachedSubsystems.IsEmpty())
+			{
+				FWorldDelegates::OnStartGameInstance.AddStatic(&ForgetCachedSubsystems);
+			}
+
+			return CachedSubsystems.AddDefaulted();
+		}
+
+		USubsystem* GetCachedSubsystem(const int32 Slot)
+		{
+			return CachedSubsystems.IsValidIndex(Slot) ? CachedSubsystems[Slot].Get() : nullptr;
+		}
+
+		void CacheSubsystem(const int32 Slot, USubsystem* Subsystem)
+		{
+			int32 NumGameInstances = 0;
+
+			if (CachedSubsystems.IsValidIndex(Slot) && GEngine && FindDefaultGameInstance(NumGameInstances)
+				&& NumGameInstances == 1)
+			{
+				CachedSubsystems[Slot] = Subsystem;
+			}
+		}
 	} // namespace Private
 
 	double GetTimeout()
@@ -32,4 +95,40 @@ namespace UE5CoroOSS
 	{
 		return Private::CVarAsyncLoginTimeout->IsVariableFloat() ? Private::CVarAsyncLoginTimeout->GetFloat() : Private::DEFAULT_ASYNC_LOGIN_TIMEOUT;
 	}
+
+	UGameInstance* FindGameInstance(const UObject* WorldContext)
+	{
+		if (!GEngine)
+		{
+			return nullptr;
+		}
+
+		if (const UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull))
+		{
+			if (UGameInstance* GameInstance = World->GetGameInstance())
+			{
+				return GameInstance;
+			}
+		}
+
+		int32 NumFound = 0;
+		UGameInstance* Found = Private::FindDefaultGameInstance(NumFound);
+
+		ensureMsgf(NumFound <= 1, TEXT("%d game instances are running, pass a world context to pick one."), NumFound);
+
+		return Found;
+	}
+
+	void ForgetSubsystem(const USubsystem* Subsystem)
+	{
+		check(IsInGameThread());
+
+		for (TWeakObjectPtr<USubsystem>& Cached : Private::CachedSubsystems)
+		{
+			if (Cached.Get(true) == Subsystem)
+			{
+				Cached.Reset();
+			}
+		}
+	}
 } // namespace UE5CoroOSS
\ No newline at end of file
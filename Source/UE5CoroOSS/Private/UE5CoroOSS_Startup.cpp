@@ -0,0 +1,192 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "UE5CoroOSS_Startup.h"
+#include "PlayFab.h"
+#include "InterfaceTasks/UE5Coro_Achievements.h"
+#include "InterfaceTasks/UE5Coro_Friends.h"
+#include "InterfaceTasks/UE5Coro_Identity.h"
+#include "InterfaceTasks/UE5Coro_Presence.h"
+#include "InterfaceTasks/UE5Coro_Session.h"
+#include "InterfaceTasks/UE5Coro_Stats.h"
+#include "PlayFabHelpers/AsyncPlayFabClient.h"
+#include "PlayFabHelpers/AsyncPlayFabEconomy.h"
+#include "UE5CoroOSS_Shared.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUE5CoroOSSStartup, Log, All);
+
+namespace UE5CoroOSS
+{
+	namespace Private
+	{
+		/** Most catalog items PlayFab returns for one GetItems request. */
+		constexpr int32 MAX_ITEMS_PER_REQUEST = 50;
+
+		float StartupPrefetchTimeout = 120.0f;
+		FAutoConsoleVariableRef CVarStartupPrefetchTimeout(
+			TEXT("oss.startupprefetchtimeout"),
+			StartupPrefetchTimeout,
+			TEXT("Time the startup prefetches wait for the local user to log in before they are skipped."));
+
+		/** Completes once the startup prefetches have waited long enough for a login. */
+		TCoroutine<> WaitForPrefetchTimeout()
+		{
+			co_await Async::PlatformSeconds(StartupPrefetchTimeout);
+		}
+
+		TCoroutine<> WaitForPlayFabLogin(const FForceLatentCoroutine = {})
+		{
+			co_await Latent::Until([]
+			{
+				return IPlayFabModuleInterface::Get().GetClientAPI()->IsClientLoggedIn();
+			});
+		}
+	} // namespace Private
+} // namespace UE5CoroOSS
+
+UAsyncOSSStartup::UAsyncOSSStartup() = default;
+
+void UAsyncOSSStartup::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Every interface subsystem resolves its interface in Initialize, so initializing them here resolves them all at once.
+	Identity = Collection.InitializeDependency<UAsyncIdentity>();
+	Achievements = Collection.InitializeDependency<UAsyncAchievements>();
+	Friends = Collection.InitializeDependency<UAsyncFriends>();
+	Collection.InitializeDependency<UAsyncPresence>();
+	Collection.InitializeDependency<UAsyncSession>();
+	Collection.InitializeDependency<UAsyncStats>();
+	Client = Collection.InitializeDependency<UAsyncPlayFabClient>();
+	Economy = Collection.InitializeDependency<UAsyncPlayFabEconomy>();
+
+	Prefetch.Emplace(RunPrefetch());
+}
+
+void UAsyncOSSStartup::Deinitialize()
+{
+	if (Prefetch.IsSet())
+	{
+		Prefetch->Cancel();
+		Prefetch.Reset();
+	}
+
+	TitleData.Reset();
+
+	UE5CoroOSS::ForgetSubsystem(this);
+
+	Super::Deinitialize();
+}
+
+UAsyncOSSStartup* UAsyncOSSStartup::Get(const UObject* WorldContext)
+{
+	return UE5CoroOSS::GetGameInstanceSubsystem<UAsyncOSSStartup>(WorldContext);
+}
+
+TCoroutine<> UAsyncOSSStartup::WaitForPrefetch() const
+{
+	check(Prefetch.IsSet());
+
+	return *Prefetch;
+}
+
+const TMap<FString, FString>& UAsyncOSSStartup::GetTitleData() const
+{
+	return TitleData;
+}
+
+TCoroutine<> UAsyncOSSStartup::RunPrefetch(const FForceLatentCoroutine)
+{
+	if (IsRunningDedicatedServer())
+	{
+		co_return;
+	}
+
+	TArray<TCoroutine<>> Prefetches;
+
+	// PlayFab has its own login, so its prefetches do not wait for the online subsystem.
+	if (bPrefetchTitleData || !CatalogItemIds.IsEmpty())
+	{
+		Prefetches.Add(PrefetchPlayFab());
+	}
+
+	FUniqueNetIdPtr UserId;
+	if (bPrefetchAchievementDescriptions || bPrefetchFriendsList)
+	{
+		const TCoroutine<FUniqueNetIdPtr> Login = Identity->WaitForLogin(LocalUserNum);
+
+		if (co_await Race(Login, UE5CoroOSS::Private::WaitForPrefetchTimeout()) == 0)
+		{
+			UserId = Login.GetResult();
+		}
+		else
+		{
+			UE_LOG(LogUE5CoroOSSStartup, Warning, TEXT("Local user %d did not log in in time, skipping their prefetches."),
+				LocalUserNum);
+		}
+	}
+
+	if (UserId.IsValid())
+	{
+		if (bPrefetchAchievementDescriptions)
+		{
+			Prefetches.Add(Achievements->QueryAchievementDescriptions(*UserId));
+		}
+
+		if (bPrefetchFriendsList)
+		{
+			Prefetches.Add(Friends->ReadFriendsList(LocalUserNum, FriendsListName));
+		}
+	}
+
+	for (TCoroutine<>& Coroutine : Prefetches)
+	{
+		co_await Coroutine;
+	}
+
+	UE_LOG(LogUE5CoroOSSStartup, Verbose, TEXT("Startup prefetch finished (%d prefetches)."), Prefetches.Num());
+}
+
+TCoroutine<> UAsyncOSSStartup::PrefetchPlayFab(const FForceLatentCoroutine)
+{
+	if (co_await Race(UE5CoroOSS::Private::WaitForPlayFabLogin(), UE5CoroOSS::Private::WaitForPrefetchTimeout()) != 0)
+	{
+		UE_LOG(LogUE5CoroOSSStartup, Warning, TEXT("PlayFab did not log in in time, skipping the PlayFab prefetches."));
+		co_return;
+	}
+
+	// Every request starts before any is awaited, so they run side by side.
+	TOptional<TCoroutine<TOptional<FTitleDataOutcome>>> TitleDataFetch;
+	if (bPrefetchTitleData)
+	{
+		PlayFab::ClientModels::FGetTitleDataRequest Request;
+		Request.Keys = TitleDataKeys;
+
+		TitleDataFetch.Emplace(Client->GetTitleData(MoveTemp(Request)));
+	}
+
+	TArray<TCoroutine<TOptional<FItemsOutcome>>> CatalogFetches;
+	for (int32 Index = 0; Index < CatalogItemIds.Num(); Index += UE5CoroOSS::Private::MAX_ITEMS_PER_REQUEST)
+	{
+		PlayFab::EconomyModels::FGetItemsRequest Request;
+		Request.Ids.Append(&CatalogItemIds[Index], FMath::Min(UE5CoroOSS::Private::MAX_ITEMS_PER_REQUEST, CatalogItemIds.Num() - Index));
+
+		CatalogFetches.Add(Economy->GetItemsCached(MoveTemp(Request)));
+	}
+
+	if (TitleDataFetch.IsSet())
+	{
+		if (TOptional<FTitleDataOutcome> Result = co_await *TitleDataFetch; Result.IsSet() && Result->HasValue())
+		{
+			TitleData = MoveTemp(Result->StealValue().Data);
+		}
+		else
+		{
+			UE_LOG(LogUE5CoroOSSStartup, Warning, TEXT("Failed to prefetch title data."));
+		}
+	}
+
+	for (TCoroutine<TOptional<FItemsOutcome>>& Coroutine : CatalogFetches)
+	{
+		co_await Coroutine;
+	}
+}
@@ -0,0 +1,648 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#include "UE5CoroOSS_WriteJournal.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Interfaces/OnlineStatsInterface.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogOfflineWriteJournal, Log, All);
+
+namespace UE5CoroOSS::Private
+{
+	constexpr uint32 WRITE_JOURNAL_MAGIC = 0x4A57464F; // 'OFWJ'
+	constexpr int32 WRITE_JOURNAL_VERSION = 2;
+	constexpr int64 WRITE_JOURNAL_HEADER_SIZE = sizeof(uint32) + sizeof(int32);
+
+	/** Records in the file beyond this many times the pending writes make the journal worth compacting. */
+	constexpr int32 WRITE_JOURNAL_COMPACT_RATIO = 4;
+	constexpr int32 WRITE_JOURNAL_COMPACT_MIN_RECORDS = 256;
+
+	void SerializeVariant(FArchive& Ar, FVariantData& Value)
+	{
+		uint8 Type = static_cast<uint8>(Value.GetType());
+		Ar << Type;
+
+		switch (static_cast<EOnlineKeyValuePairDataType::Type>(Type))
+		{
+		case EOnlineKeyValuePairDataType::Int32:
+			{
+				int32 Data = 0;
+				Value.GetValue(Data);
+				Ar << Data;
+				Value.SetValue(Data);
+				break;
+			}
+		case EOnlineKeyValuePairDataType::UInt32:
+			{
+				uint32 Data = 0;
+				Value.GetValue(Data);
+				Ar << Data;
+				Value.SetValue(Data);
+				break;
+			}
+		case EOnlineKeyValuePairDataType::Int64:
+			{
+				int64 Data = 0;
+				Value.GetValue(Data);
+				Ar << Data;
+				Value.SetValue(Data);
+				break;
+			}
+		case EOnlineKeyValuePairDataType::UInt64:
+			{
+				uint64 Data = 0;
+				Value.GetValue(Data);
+				Ar << Data;
+				Value.SetValue(Data);
+				break;
+			}
+		case EOnlineKeyValuePairDataType::Float:
+			{
+				float Data = 0.0f;
+				Value.GetValue(Data);
+				Ar << Data;
+				Value.SetValue(Data);
+				break;
+			}
+		case EOnlineKeyValuePairDataType::Double:
+			{
+				double Data = 0.0;
+				Value.GetValue(Data);
+				Ar << Data;
+				Value.SetValue(Data);
+				break;
+			}
+		case EOnlineKeyValuePairDataType::Bool:
+			{
+				bool Data = false;
+				Value.GetValue(Data);
+				Ar << Data;
+				Value.SetValue(Data);
+				break;
+			}
+		case EOnlineKeyValuePairDataType::String:
+			{
+				FString Data;
+				Value.GetValue(Data);
+				Ar << Data;
+				Value.SetValue(Data);
+				break;
+			}
+		default:
+			Value.Empty();
+			break;
+		}
+	}
+
+	bool IsIntegerVariant(const FVariantData& Value)
+	{
+		switch (Value.GetType())
+		{
+		case EOnlineKeyValuePairDataType::Int32:
+		case EOnlineKeyValuePairDataType::UInt32:
+		case EOnlineKeyValuePairDataType::Int64:
+		case EOnlineKeyValuePairDataType::UInt64:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	/** Build a floating point variant of Like's type from a number. */
+	FVariantData MakeVariantLike(const FVariantData& Like, const double Number)
+	{
+		FVariantData Result;
+
+		if (Like.GetType() == EOnlineKeyValuePairDataType::Float)
+		{
+			Result.SetValue(static_cast<float>(Number));
+		}
+		else
+		{
+			Result.SetValue(Number);
+		}
+
+		return Result;
+	}
+
+	FVariantData MakeIntegerVariantLike(const FVariantData& Like, const int64 Number)
+	{
+		FVariantData Result;
+
+		switch (Like.GetType())
+		{
+		case EOnlineKeyValuePairDataType::Int32:
+			Result.SetValue(static_cast<int32>(Number));
+			break;
+		case EOnlineKeyValuePairDataType::UInt32:
+			Result.SetValue(static_cast<uint32>(Number));
+			break;
+		case EOnlineKeyValuePairDataType::UInt64:
+			Result.SetValue(static_cast<uint64>(Number));
+			break;
+		default:
+			Result.SetValue(Number);
+			break;
+		}
+
+		return Result;
+	}
+
+	double GetVariantNumber(const FVariantData& Value)
+	{
+		if (Value.GetType() == EOnlineKeyValuePairDataType::Float)
+		{
+			float Data = 0.0f;
+			Value.GetValue(Data);
+			return Data;
+		}
+
+		double Data = 0.0;
+		Value.GetValue(Data);
+		return Data;
+	}
+
+	int64 GetVariantInteger(const FVariantData& Value)
+	{
+		switch (Value.GetType())
+		{
+		case EOnlineKeyValuePairDataType::Int32:
+			{
+				int32 Data = 0;
+				Value.GetValue(Data);
+				return Data;
+			}
+		case EOnlineKeyValuePairDataType::UInt32:
+			{
+				uint32 Data = 0;
+				Value.GetValue(Data);
+				return Data;
+			}
+		case EOnlineKeyValuePairDataType::Int64:
+			{
+				int64 Data = 0;
+				Value.GetValue(Data);
+				return Data;
+			}
+		case EOnlineKeyValuePairDataType::UInt64:
+			{
+				uint64 Data = 0;
+				Value.GetValue(Data);
+				return static_cast<int64>(Data);
+			}
+		default:
+			return 0;
+		}
+	}
+
+	/** Combine two values of a numeric stat. Integers are combined as integers, so large counters stay exact. */
+	FVariantData CombineStatValues(const FVariantData& Old, const FVariantData& New, const EOnlineStatModificationType Method)
+	{
+		if (Old.GetType() != New.GetType() || !Old.IsNumeric())
+		{
+			return New;
+		}
+
+		if (IsIntegerVariant(Old))
+		{
+			const int64 OldNumber = GetVariantInteger(Old);
+			const int64 NewNumber = GetVariantInteger(New);
+
+			switch (Method)
+			{
+			case EOnlineStatModificationType::Sum:
+				return MakeIntegerVariantLike(Old, OldNumber + NewNumber);
+			case EOnlineStatModificationType::Largest:
+				return OldNumber >= NewNumber ? Old : New;
+			case EOnlineStatModificationType::Smallest:
+				return OldNumber <= NewNumber ? Old : New;
+			default:
+				return New;
+			}
+		}
+
+		const double OldNumber = GetVariantNumber(Old);
+		const double NewNumber = GetVariantNumber(New);
+
+		switch (Method)
+		{
+		case EOnlineStatModificationType::Sum:
+			return MakeVariantLike(Old, OldNumber + NewNumber);
+		case EOnlineStatModificationType::Largest:
+			return OldNumber >= NewNumber ? Old : New;
+		case EOnlineStatModificationType::Smallest:
+			return OldNumber <= NewNumber ? Old : New;
+		default:
+			return New;
+		}
+	}
+} // namespace UE5CoroOSS::Private
+
+FOfflineWriteJournal::FOfflineWriteJournal() = default;
+
+FOfflineWriteJournal::~FOfflineWriteJournal()
+{
+	Close();
+}
+
+int32 FOfflineWriteJournal::Open(const FString& InFilePath)
+{
+	Close();
+	Pending.Reset();
+	Buffered.Reset();
+	BufferedRecords = 0;
+	RecordsInFile = 0;
+
+	FilePath = InFilePath;
+
+	TArray<uint8> Bytes;
+	if (FPaths::FileExists(FilePath) && FFileHelper::LoadFileToArray(Bytes, *FilePath))
+	{
+		FMemoryReader Reader(Bytes);
+
+		uint32 Magic = 0;
+		int32 Version = 0;
+		Reader << Magic << Version;
+
+		if (Reader.IsError() || Magic != UE5CoroOSS::Private::WRITE_JOURNAL_MAGIC || Version != UE5CoroOSS::Private::WRITE_JOURNAL_VERSION)
+		{
+			UE_LOG(LogOfflineWriteJournal, Warning, TEXT("Discarding unreadable write journal (%s)"), *FilePath);
+		}
+		else
+		{
+			while (Reader.Tell() + static_cast<int64>(sizeof(int32)) <= Reader.TotalSize())
+			{
+				int32 RecordSize = 0;
+				Reader << RecordSize;
+
+				if (RecordSize <= 0 || Reader.Tell() + RecordSize > Reader.TotalSize())
+				{
+					// The last record was cut short by a crash before it was synced.
+					UE_LOG(LogOfflineWriteJournal, Log, TEXT("Ignoring truncated record at the end of (%s)"), *FilePath);
+					break;
+				}
+
+				FMemoryReaderView RecordReader(MakeArrayView(Bytes.GetData() + Reader.Tell(), RecordSize));
+				Reader.Seek(Reader.Tell() + RecordSize);
+
+				uint8 Kind = 0;
+				RecordReader << Kind;
+
+				FOfflineWrite Write;
+				SerializeWrite(RecordReader, Write);
+
+				if (RecordReader.IsError() || Kind > static_cast<uint8>(ERecordKind::Remove))
+				{
+					UE_LOG(LogOfflineWriteJournal, Warning, TEXT("Skipping unreadable record in (%s)"), *FilePath);
+					continue;
+				}
+
+				ApplyRecord(static_cast<ERecordKind>(Kind), MoveTemp(Write));
+			}
+		}
+	}
+
+	// Start from a file holding just the coalesced writes, which also drops anything unreadable.
+	Compact();
+
+	UE_LOG(LogOfflineWriteJournal, Verbose, TEXT("Read %d pending writes from (%s)"), Pending.Num(), *FilePath);
+
+	return Pending.Num();
+}
+
+void FOfflineWriteJournal::Close()
+{
+	FinishCompact();
+
+	if (FileHandle.IsValid() || !Buffered.IsEmpty())
+	{
+		Sync();
+		FileHandle.Reset();
+	}
+}
+
+void FOfflineWriteJournal::Append(FOfflineWrite Write)
+{
+	BufferRecord(Write);
+
+	Coalesce(MoveTemp(Write));
+}
+
+bool FOfflineWriteJournal::Sync()
+{
+	// The file is being replaced, so appending has to wait for the rewrite.
+	if (IsCompacting())
+	{
+		return false;
+	}
+
+	FinishCompact();
+
+	if (Buffered.IsEmpty())
+	{
+		return true;
+	}
+
+	if (!FileHandle.IsValid() && !OpenForAppend())
+	{
+		return false;
+	}
+
+	if (!FileHandle->Write(Buffered.GetData(), Buffered.Num()) || !FileHandle->Flush(true))
+	{
+		UE_LOG(LogOfflineWriteJournal, Warning, TEXT("Failed to sync write journal (%s)"), *FilePath);
+		return false;
+	}
+
+	RecordsInFile += BufferedRecords;
+
+	Buffered.Reset();
+	BufferedRecords = 0;
+
+	return true;
+}
+
+bool FOfflineWriteJournal::Compact()
+{
+	if (FilePath.IsEmpty())
+	{
+		return false;
+	}
+
+	FinishCompact();
+
+	FileHandle.Reset();
+
+	const bool bReplaced = Pending.IsEmpty() ? IFileManager::Get().Delete(*FilePath, false, false, true)
+		: ReplaceFile(FilePath, SerializeJournal(GetPending()));
+
+	if (!bReplaced)
+	{
+		// The previous file is untouched, so the buffered records are appended to it with the next sync instead.
+		UE_LOG(LogOfflineWriteJournal, Warning, TEXT("Failed to compact write journal (%s)"), *FilePath);
+		return false;
+	}
+
+	Buffered.Reset();
+	BufferedRecords = 0;
+	RecordsInFile = Pending.Num();
+
+	return true;
+}
+
+bool FOfflineWriteJournal::BeginCompact()
+{
+	if (FilePath.IsEmpty() || PendingCompaction.IsValid())
+	{
+		return false;
+	}
+
+	// The file is replaced underneath the append handle, so it is reopened by the first sync afterwards.
+	FileHandle.Reset();
+
+	PendingCompaction = MakeUnique<FPendingCompaction>();
+	PendingCompaction->BufferedBytes = Buffered.Num();
+	PendingCompaction->BufferedRecords = BufferedRecords;
+	PendingCompaction->Records = Pending.Num();
+
+	PendingCompaction->Task = UE::Tasks::Launch(TEXT("CompactOfflineWriteJournal"), [Path = FilePath, Writes = GetPending()]() mutable
+	{
+		return Writes.IsEmpty() ? IFileManager::Get().Delete(*Path, false, false, true)
+			: ReplaceFile(Path, SerializeJournal(MoveTemp(Writes)));
+	});
+
+	return true;
+}
+
+bool FOfflineWriteJournal::IsCompacting() const
+{
+	return PendingCompaction.IsValid() && !PendingCompaction->Task.IsCompleted();
+}
+
+bool FOfflineWriteJournal::FinishCompact()
+{
+	if (!PendingCompaction.IsValid())
+	{
+		return true;
+	}
+
+	const TUniquePtr<FPendingCompaction> Finished = MoveTemp(PendingCompaction);
+
+	if (!Finished->Task.GetResult())
+	{
+		// The previous file is untouched, so the buffered records are appended to it with the next sync instead.
+		UE_LOG(LogOfflineWriteJournal, Warning, TEXT("Failed to compact write journal (%s)"), *FilePath);
+		return false;
+	}
+
+	// The rewritten file already holds what was buffered when the rewrite started.
+	Buffered.RemoveAt(0, Finished->BufferedBytes);
+	BufferedRecords -= Finished->BufferedRecords;
+	RecordsInFile = Finished->Records;
+
+	return true;
+}
+
+void FOfflineWriteJournal::Acknowledge(const FOfflineWrite& Sent)
+{
+	const FString Key = MakeKey(Sent);
+
+	FOfflineWrite* Current = Pending.Find(Key);
+	if (!Current)
+	{
+		return;
+	}
+
+	if (Current->Sequence == Sent.Sequence)
+	{
+		BufferRecord(*Current, ERecordKind::Remove);
+		Pending.Remove(Key);
+		return;
+	}
+
+	if (Sent.Kind == EOfflineWriteKind::Stat && static_cast<EOnlineStatModificationType>(Sent.Method) == EOnlineStatModificationType::Sum
+		&& Current->Value.GetType() == Sent.Value.GetType() && Current->Value.IsNumeric())
+	{
+		// Only what was added after the write was sent is still owed.
+		if (UE5CoroOSS::Private::IsIntegerVariant(Current->Value))
+		{
+			const int64 Remaining = UE5CoroOSS::Private::GetVariantInteger(Current->Value) - UE5CoroOSS::Private::GetVariantInteger(Sent.Value);
+			Current->Value = UE5CoroOSS::Private::MakeIntegerVariantLike(Current->Value, Remaining);
+		}
+		else
+		{
+			const double Remaining = UE5CoroOSS::Private::GetVariantNumber(Current->Value) - UE5CoroOSS::Private::GetVariantNumber(Sent.Value);
+			Current->Value = UE5CoroOSS::Private::MakeVariantLike(Current->Value, Remaining);
+		}
+
+		Current->Sequence = NextSequence++;
+		BufferRecord(*Current, ERecordKind::Replace);
+	}
+}
+
+TArray<FOfflineWrite> FOfflineWriteJournal::GetPending() const
+{
+	TArray<FOfflineWrite> Writes;
+	Pending.GenerateValueArray(Writes);
+
+	return Writes;
+}
+
+int32 FOfflineWriteJournal::Num() const
+{
+	return Pending.Num();
+}
+
+bool FOfflineWriteJournal::NeedsSync() const
+{
+	return !Buffered.IsEmpty();
+}
+
+bool FOfflineWriteJournal::NeedsCompaction() const
+{
+	return !PendingCompaction.IsValid() && RecordsInFile >= UE5CoroOSS::Private::WRITE_JOURNAL_COMPACT_MIN_RECORDS
+		&& RecordsInFile > Pending.Num() * UE5CoroOSS::Private::WRITE_JOURNAL_COMPACT_RATIO;
+}
+
+FString FOfflineWriteJournal::MakeKey(const FOfflineWrite& Write)
+{
+	switch (Write.Kind)
+	{
+	case EOfflineWriteKind::Stat:
+		// Writes with different modification types can not be merged, so each gets its own entry.
+		return FString::Printf(TEXT("Stat/%s/%s/%s/%d"), *Write.LocalUserId.ToString(), *Write.UserId.ToString(), *Write.Key, Write.Method);
+	case EOfflineWriteKind::Achievement:
+		return FString::Printf(TEXT("Achievement/%s/%s"), *Write.UserId.ToString(), *Write.Key);
+	default:
+		return FString::Printf(TEXT("UserData/%s/%s"), *Write.Owner, *Write.Key);
+	}
+}
+
+void FOfflineWriteJournal::SerializeWrite(FArchive& Ar, FOfflineWrite& Write)
+{
+	uint8 Kind = static_cast<uint8>(Write.Kind);
+
+	Ar << Kind << Write.LocalUserId << Write.UserId << Write.Owner << Write.Key << Write.Method;
+	UE5CoroOSS::Private::SerializeVariant(Ar, Write.Value);
+
+	Write.Kind = static_cast<EOfflineWriteKind>(Kind);
+}
+
+TArray<uint8> FOfflineWriteJournal::SerializeJournal(TArray<FOfflineWrite> Writes)
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = UE5CoroOSS::Private::WRITE_JOURNAL_MAGIC;
+	int32 Version = UE5CoroOSS::Private::WRITE_JOURNAL_VERSION;
+	Writer << Magic << Version;
+
+	for (FOfflineWrite& Write : Writes)
+	{
+		WriteRecord(Writer, Write, ERecordKind::Append);
+	}
+
+	return Bytes;
+}
+
+void FOfflineWriteJournal::WriteRecord(FArchive& Ar, FOfflineWrite& Write, const ERecordKind Kind)
+{
+	TArray<uint8> Record;
+	FMemoryWriter RecordWriter(Record);
+
+	uint8 RecordKind = static_cast<uint8>(Kind);
+	RecordWriter << RecordKind;
+	SerializeWrite(RecordWriter, Write);
+
+	int32 RecordSize = Record.Num();
+	Ar << RecordSize;
+	Ar.Serialize(Record.GetData(), Record.Num());
+}
+
+bool FOfflineWriteJournal::ReplaceFile(const FString& Path, const TArray<uint8>& Bytes)
+{
+	const FString TempPath = Path + TEXT(".tmp");
+
+	return FFileHelper::SaveArrayToFile(Bytes, *TempPath) && IFileManager::Get().Move(*Path, *TempPath, true);
+}
+
+void FOfflineWriteJournal::Coalesce(FOfflineWrite Write)
+{
+	FOfflineWrite& Current = Pending.FindOrAdd(MakeKey(Write));
+	const bool bExisting = Current.Sequence != 0;
+
+	if (bExisting && Write.Kind == EOfflineWriteKind::Stat)
+	{
+		Write.Value = UE5CoroOSS::Private::CombineStatValues(Current.Value, Write.Value,
+			static_cast<EOnlineStatModificationType>(Write.Method));
+	}
+	else if (bExisting && Write.Kind == EOfflineWriteKind::Achievement)
+	{
+		Write.Value = UE5CoroOSS::Private::CombineStatValues(Current.Value, Write.Value, EOnlineStatModificationType::Largest);
+	}
+
+	Write.Sequence = NextSequence++;
+	Current = MoveTemp(Write);
+}
+
+void FOfflineWriteJournal::ApplyRecord(const ERecordKind Kind, FOfflineWrite Write)
+{
+	switch (Kind)
+	{
+	case ERecordKind::Replace:
+		{
+			FString Key = MakeKey(Write);
+			Write.Sequence = NextSequence++;
+			Pending.Add(MoveTemp(Key), MoveTemp(Write));
+			break;
+		}
+	case ERecordKind::Remove:
+		Pending.Remove(MakeKey(Write));
+		break;
+	default:
+		Coalesce(MoveTemp(Write));
+		break;
+	}
+}
+
+void FOfflineWriteJournal::BufferRecord(FOfflineWrite& Write, const ERecordKind Kind)
+{
+	FMemoryWriter BufferWriter(Buffered, false, true);
+	WriteRecord(BufferWriter, Write, Kind);
+
+	++BufferedRecords;
+}
+
+bool FOfflineWriteJournal::OpenForAppend()
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+	const bool bNewFile = !PlatformFile.FileExists(*FilePath);
+
+	FileHandle.Reset(PlatformFile.OpenWrite(*FilePath, true));
+	if (!FileHandle.IsValid())
+	{
+		UE_LOG(LogOfflineWriteJournal, Warning, TEXT("Failed to open write journal (%s)"), *FilePath);
+		return false;
+	}
+
+	if (bNewFile || FileHandle->Size() < UE5CoroOSS::Private::WRITE_JOURNAL_HEADER_SIZE)
+	{
+		TArray<uint8> Header;
+		FMemoryWriter Writer(Header);
+
+		uint32 Magic = UE5CoroOSS::Private::WRITE_JOURNAL_MAGIC;
+		int32 Version = UE5CoroOSS::Private::WRITE_JOURNAL_VERSION;
+		Writer << Magic << Version;
+
+		FileHandle->Write(Header.GetData(), Header.Num());
+	}
+
+	return true;
+}
@@ -19,11 +19,13 @@ public:
 	
 	//~UGameInstanceSubsystem Interface Begin
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
 	//~UGameInstanceSubsystem Interface End
 	
-	static UAsyncAchievements* Get();
+	static UAsyncAchievements* Get(const UObject* WorldContext = nullptr);
 
-	static void SetInterfaceName(const FName& Name = FName(TEXT("RedpointEOS")));
+	void SetInterfaceName(const FName& Name = FName(TEXT("RedpointEOS")));
 
 	template <typename T = TTuple<FUniqueNetIdRepl /*PlayerId*/, bool /*bWasSuccessful*/>>
 	TCoroutine<TOptional<T>> WriteAchievements(const FUniqueNetId& PlayerId, FOnlineAchievementsWriteRef& WriteObject);
@@ -59,29 +61,29 @@ public:
 
 private:
 
-	static inline TWeakPtr<IOnlineAchievements> Achievements;
+	TWeakPtr<IOnlineAchievements> Achievements;
 };
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncAchievements::WriteAchievements(const FUniqueNetId& PlayerId, FOnlineAchievementsWriteRef& WriteObject)
 {
-	static FUniqueNetIdRepl StaticLocalUserId;
-	static bool bStaticWasSuccessful;
+	FUniqueNetIdRepl LocalUserId;
+	bool bWasSuccessful = false;
 
 	FOnAchievementsWrittenDelegate AchievementsWrittenDelegate;
 
 	const TCoroutine<> DoWriteAchievements = []
 		(const FLatentLambda, FOnAchievementsWrittenDelegate& ThisAchievementsWrittenDelegate,
-			const FUniqueNetId& ThisLocalUserId, FOnlineAchievementsWriteRef& ThisWriteObject) -> TCoroutine<>
+			FUniqueNetIdRepl& OutPlayerId, bool& bOutWasSuccessful) -> TCoroutine<>
 	{
 		auto [InnerPlayerId, bInnerWasSuccessful] = co_await ThisAchievementsWrittenDelegate;
 
-		StaticLocalUserId = InnerPlayerId;
-		bStaticWasSuccessful = bInnerWasSuccessful;
-	}(FLambdaParam(this), AchievementsWrittenDelegate, PlayerId, WriteObject);
+		OutPlayerId = InnerPlayerId;
+		bOutWasSuccessful = bInnerWasSuccessful;
+	}(FLambdaParam(this), AchievementsWrittenDelegate, LocalUserId, bWasSuccessful);
 
 	const TCoroutine<> WriteAchievementsCoroutine = []
-		(const FLatentLambda, FOnAchievementsWrittenDelegate& ThisAchievementsWrittenDelegate,
+		(const FLatentLambda, const TSharedPtr<IOnlineAchievements> ThisAchievements, FOnAchievementsWrittenDelegate& ThisAchievementsWrittenDelegate,
 			const FUniqueNetId& ThisLocalUserId, FOnlineAchievementsWriteRef& ThisWriteObject) -> TCoroutine<>
 	{
 		co_await Latent::Until([ThisAchievementsWrittenDelegate]
@@ -89,97 +91,97 @@ TCoroutine<TOptional<T>> UAsyncAchievements::WriteAchievements(const FUniqueNetI
 			return ThisAchievementsWrittenDelegate.IsBound();
 		});
 
-		if (!Achievements.IsValid())
+		if (!ThisAchievements.IsValid())
 		{
 			co_return;
 		}
 
-		Achievements.Pin()->WriteAchievements(ThisLocalUserId, ThisWriteObject, ThisAchievementsWrittenDelegate);
+		ThisAchievements->WriteAchievements(ThisLocalUserId, ThisWriteObject, ThisAchievementsWrittenDelegate);
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
-	}(FLambdaParam(this), AchievementsWrittenDelegate, PlayerId, WriteObject);
+	}(FLambdaParam(this), Achievements.Pin(), AchievementsWrittenDelegate, PlayerId, WriteObject);
 
-	co_return !co_await Race(WriteAchievementsCoroutine, DoWriteAchievements) ? T() : T(StaticLocalUserId, bStaticWasSuccessful);
+	co_return !co_await Race(WriteAchievementsCoroutine, DoWriteAchievements) ? T() : T(LocalUserId, bWasSuccessful);
 }
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncAchievements::QueryAchievementDescriptions(const FUniqueNetId& PlayerId)
 {
-	static FUniqueNetIdRepl StaticLocalUserId;
-	static bool bStaticWasSuccessful;
+	FUniqueNetIdRepl LocalUserId;
+	bool bWasSuccessful = false;
 
 	FOnQueryAchievementsCompleteDelegate QueryAchievementDescriptionsDelegate;
 
 	const TCoroutine<> DoQueryAchievementDescriptions = []
 		(const FLatentLambda, FOnQueryAchievementsCompleteDelegate& ThisQueryAchievementDescriptionsDelegate,
-			const FUniqueNetId& ThisLocalUserId) -> TCoroutine<>
+			FUniqueNetIdRepl& OutPlayerId, bool& bOutWasSuccessful) -> TCoroutine<>
 	{
 		auto [InnerPlayerId, bInnerWasSuccessful] = co_await ThisQueryAchievementDescriptionsDelegate;
 
-		StaticLocalUserId = InnerPlayerId;
-		bStaticWasSuccessful = bInnerWasSuccessful;
-	}(FLambdaParam(this), QueryAchievementDescriptionsDelegate, PlayerId);
+		OutPlayerId = InnerPlayerId;
+		bOutWasSuccessful = bInnerWasSuccessful;
+	}(FLambdaParam(this), QueryAchievementDescriptionsDelegate, LocalUserId, bWasSuccessful);
 
 	const TCoroutine<> QueryAchievementDescriptionsCoroutine = []
-		(const FLatentLambda, FOnQueryAchievementsCompleteDelegate& ThisQueryAchievementDescriptionsDelegate,
-			const FUniqueNetId& ThisLocalUserId) -> TCoroutine<>
+		(const FLatentLambda, const TSharedPtr<IOnlineAchievements> ThisAchievements,
+			FOnQueryAchievementsCompleteDelegate& ThisQueryAchievementDescriptionsDelegate, const FUniqueNetId& ThisLocalUserId) -> TCoroutine<>
 	{
 		co_await Latent::Until([ThisQueryAchievementDescriptionsDelegate]
 		{
 			return ThisQueryAchievementDescriptionsDelegate.IsBound();
 		});
 
-		if (!Achievements.IsValid())
+		if (!ThisAchievements.IsValid())
 		{
 			co_return;
 		}
 
-		Achievements.Pin()->QueryAchievementDescriptions(ThisLocalUserId, ThisQueryAchievementDescriptionsDelegate);
+		ThisAchievements->QueryAchievementDescriptions(ThisLocalUserId, ThisQueryAchievementDescriptionsDelegate);
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
-	}(FLambdaParam(this), QueryAchievementDescriptionsDelegate, PlayerId);
+	}(FLambdaParam(this), Achievements.Pin(), QueryAchievementDescriptionsDelegate, PlayerId);
 
 	co_return !co_await Race(QueryAchievementDescriptionsCoroutine, DoQueryAchievementDescriptions)
-		? T() : T(StaticLocalUserId, bStaticWasSuccessful);
+		? T() : T(LocalUserId, bWasSuccessful);
 }
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncAchievements::QueryAchievements(const FUniqueNetId& PlayerId)
 {
-	static FUniqueNetIdRepl StaticLocalUserId;
-	static bool bStaticWasSuccessful;
+	FUniqueNetIdRepl LocalUserId;
+	bool bWasSuccessful = false;
 
 	FOnQueryAchievementsCompleteDelegate QueryAchievementsDelegate;
 
 	const TCoroutine<> DoQueryAchievements = []
 		(const FLatentLambda, FOnQueryAchievementsCompleteDelegate& ThisQueryAchievementsDelegate,
-			const FUniqueNetId& ThisLocalUserId) -> TCoroutine<>
+			FUniqueNetIdRepl& OutPlayerId, bool& bOutWasSuccessful) -> TCoroutine<>
 	{
 		auto [InnerPlayerId, bInnerWasSuccessful] = co_await ThisQueryAchievementsDelegate;
 
-		StaticLocalUserId = InnerPlayerId;
-		bStaticWasSuccessful = bInnerWasSuccessful;
-	}(FLambdaParam(this), QueryAchievementsDelegate, PlayerId);
+		OutPlayerId = InnerPlayerId;
+		bOutWasSuccessful = bInnerWasSuccessful;
+	}(FLambdaParam(this), QueryAchievementsDelegate, LocalUserId, bWasSuccessful);
 
 	const TCoroutine<> QueryAchievementsCoroutine = []
-		(const FLatentLambda, FOnQueryAchievementsCompleteDelegate& ThisQueryAchievementsDelegate,
-			const FUniqueNetId& ThisLocalUserId) -> TCoroutine<>
+		(const FLatentLambda, const TSharedPtr<IOnlineAchievements> ThisAchievements,
+			FOnQueryAchievementsCompleteDelegate& ThisQueryAchievementsDelegate, const FUniqueNetId& ThisLocalUserId) -> TCoroutine<>
 	{
 		co_await Latent::Until([ThisQueryAchievementsDelegate]
 		{
 			return ThisQueryAchievementsDelegate.IsBound();
 		});
 
-		if (!Achievements.IsValid())
+		if (!ThisAchievements.IsValid())
 		{
 			co_return;
 		}
 
-		Achievements.Pin()->QueryAchievements(ThisLocalUserId, ThisQueryAchievementsDelegate);
+		ThisAchievements->QueryAchievements(ThisLocalUserId, ThisQueryAchievementsDelegate);
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
-	}(FLambdaParam(this), QueryAchievementsDelegate, PlayerId);
+	}(FLambdaParam(this), Achievements.Pin(), QueryAchievementsDelegate, PlayerId);
 
 	co_return !co_await Race(QueryAchievementsCoroutine, DoQueryAchievements)
-		? T() : T(StaticLocalUserId, bStaticWasSuccessful);
+		? T() : T(LocalUserId, bWasSuccessful);
 }
@@ -27,9 +27,9 @@ public:
 	virtual void Deinitialize() override;
 	//~UGameInstanceSubsystem Interface End
 	
-	static UAsyncFriends* Get();
+	static UAsyncFriends* Get(const UObject* WorldContext = nullptr);
 
-	static void SetInterfaceName(const FName& Name = FName(TEXT("RedpointEOS")));
+	void SetInterfaceName(const FName& Name = FName(TEXT("RedpointEOS")));
 	
 	/**
 	 * @brief	Starts an async task that reads the named friends list for the player 
@@ -39,29 +39,30 @@ public:
 	 *
 	 * @return 	See: FOnReadFriendsListComplete
 	 */
-	template <typename T = TTuple<int32 /*LocalUserNum*/, bool /*bWasSuccessful*/, const FString& /*ListName*/, const FString& /*ErrorStr*/>>
-	static TCoroutine<TOptional<T>> ReadFriendsList(const int32 LocalUserNum, const FString& ListName);
+	template <typename T = TTuple<int32 /*LocalUserNum*/, bool /*bWasSuccessful*/, FString /*ListName*/, FString /*ErrorStr*/>>
+	TCoroutine<TOptional<T>> ReadFriendsList(const int32 LocalUserNum, const FString& ListName);
 	
 private:
 	
-	static inline TWeakPtr<IOnlineFriends> Friends;
-
-	static inline FOnReadFriendsListComplete ReadFriendsListDelegate;
+	TWeakPtr<IOnlineFriends> Friends;
 };
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncFriends::ReadFriendsList(const int32 LocalUserNum, const FString& ListName)
 {
+	FOnReadFriendsListComplete ReadFriendsListDelegate;
+
 	const TCoroutine<> ReadFriendsListCoroutine = []
-		(const FLatentLambda This, const int32 ThisLocalUserNum, const FString& ThisListName) -> TCoroutine<>
+		(const FLatentLambda This, const TSharedPtr<IOnlineFriends> ThisFriends, const int32 ThisLocalUserNum, const FString& ThisListName,
+			FOnReadFriendsListComplete& ThisReadFriendsListDelegate) -> TCoroutine<>
 	{
-		co_await Latent::Until([This]
+		co_await Latent::Until([This, &ThisReadFriendsListDelegate]
 			() -> bool
 		{
-			return ReadFriendsListDelegate.IsBound();
+			return ThisReadFriendsListDelegate.IsBound();
 		});
-		
-		if (!Friends.Pin()->ReadFriendsList(ThisLocalUserNum, ThisListName, ReadFriendsListDelegate))
+
+		if (!ThisFriends.IsValid() || !ThisFriends->ReadFriendsList(ThisLocalUserNum, ThisListName, ThisReadFriendsListDelegate))
 		{
 			UE_LOG(LogUE5CoroFriends, Error, TEXT("Failed to read friends list for (%d)"), ThisLocalUserNum);
 		
@@ -71,30 +72,29 @@ TCoroutine<TOptional<T>> UAsyncFriends::ReadFriendsList(const int32 LocalUserNum
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
 
 		co_return;
-	}(FLambdaParam(Get()), LocalUserNum, ListName);
+	}(FLambdaParam(this), Friends.Pin(), LocalUserNum, ListName, ReadFriendsListDelegate);
 
-	static int32 LocalUserNum2;
-	static bool bWasSuccessful;
-	static FString ListName2;
-	static FString ErrorStr;
+	int32 LocalUserNum2 = LocalUserNum;
+	bool bWasSuccessful = false;
+	FString ListName2;
+	FString ErrorStr;
 
 	const TCoroutine<> DoReadFriendsList = []
-		(int32& OutLocalUserNum, bool& bOutWasSuccessful, FString& OutListName, FString& OutErrorStr) -> TCoroutine<>
+		(int32& OutLocalUserNum, bool& bOutWasSuccessful, FString& OutListName, FString& OutErrorStr,
+			FOnReadFriendsListComplete& ThisReadFriendsListDelegate) -> TCoroutine<>
 	{
-		auto [InnerLocalUserNum, bInnerWasSuccessful, bInnerListName, bInnerErrorStr] = co_await ReadFriendsListDelegate;
+		auto [InnerLocalUserNum, bInnerWasSuccessful, bInnerListName, bInnerErrorStr] = co_await ThisReadFriendsListDelegate;
 
 		OutLocalUserNum = InnerLocalUserNum;
 		bOutWasSuccessful = bInnerWasSuccessful;
 		OutListName = bInnerListName;
 		OutErrorStr = bInnerErrorStr;
-	}(LocalUserNum2, bWasSuccessful, ListName2, ErrorStr);
+	}(LocalUserNum2, bWasSuccessful, ListName2, ErrorStr, ReadFriendsListDelegate);
 
 	if (const int32 Success = co_await Race(ReadFriendsListCoroutine, DoReadFriendsList); !Success)
 	{
 		co_return {};
 	}
 
-	T&& Return = ForwardAsTuple(LocalUserNum2, bWasSuccessful, ListName2, ErrorStr);
-	
-	co_return Return;
+	co_return T(LocalUserNum2, bWasSuccessful, MoveTemp(ListName2), MoveTemp(ErrorStr));
 }
@@ -5,9 +5,22 @@
 #include "CoreMinimal.h"
 #include "UE5Coro.h"
 #include "UE5CoroOSS_Shared.h"
+#include "GameFramework/OnlineReplStructs.h"
 #include "Interfaces/OnlineIdentityInterface.h"
 #include "UE5Coro_Identity.generated.h"
 
+/** The outcome of logging in one local user. */
+struct FAutoLoginResult
+{
+	FPlatformUserId PlatformUser;
+
+	bool bWasSuccessful = false;
+
+	FUniqueNetIdRepl UserId;
+
+	FString Error;
+};
+
 UCLASS()
 class UE5COROOSS_API UAsyncIdentity final : public UGameInstanceSubsystem
 {
@@ -25,9 +38,9 @@ public:
 	virtual void Deinitialize() override;
 	//~ UGameInstanceSubsystem Interface End
 
-	static UAsyncIdentity* Get();
+	static UAsyncIdentity* Get(const UObject* WorldContext = nullptr);
 
-	static void SetInterfaceName(const FName& Name = FName(TEXT("RedpointEOS")));
+	void SetInterfaceName(const FName& Name = FName(TEXT("RedpointEOS")));
 
 	/**
 	 * @brief	Logs the player into the online service using parameters passed on the
@@ -39,10 +52,22 @@ public:
 	 *
 	 * @return See: FOnLoginCompleteDelegate
 	 */
-	template <typename T = TTuple<const FPlatformUserId& /*PlatformUser*/, bool /*bWasSuccessful*/, const FUniqueNetId& /*LocalUserId*/,
-		const FString& /*Error*/>>
+	template <typename T = TTuple<FPlatformUserId /*PlatformUser*/, bool /*bWasSuccessful*/, FUniqueNetIdRepl /*LocalUserId*/,
+		FString /*Error*/>>
 	TCoroutine<TOptional<T>> AutoLogin(const FPlatformUserId& PlatformUser, const FForceLatentCoroutine ForceLatentCoroutine = {});
 
+	/**
+	 * @brief	Logs several local users in at once, such as every controller of a split-screen session. Each login
+	 *			has its own state, so users only wait for their own login rather than for each other.
+	 *
+	 * @param PlatformUsers		The Platform Users to login.
+	 * @param OnUserLoggedIn	Called with each user's result as soon as that user's login completes. May be unset.
+	 *
+	 * @return	One result per Platform User, in the order given. A login that timed out or did not start is unsuccessful.
+	 */
+	TCoroutine<TArray<FAutoLoginResult>> AutoLoginAll(TArray<FPlatformUserId> PlatformUsers,
+		TFunction<void(const FAutoLoginResult& /*Result*/)> OnUserLoggedIn = nullptr);
+
 	/**
 	 * @brief	Signs the player out of the online service.
 	 *
@@ -65,116 +90,86 @@ public:
 	 */
 	template <typename T = TTuple<const FUniqueNetId& /*LocalUserId*/, EUserPrivileges::Type /*Privilege*/,
 		uint32 /*PrivilegeResult*/>>
-	static TCoroutine<TOptional<T>> GetUserPrivilege(const FUniqueNetId& LocalUserId, const EUserPrivileges::Type Privilege,
+	TCoroutine<TOptional<T>> GetUserPrivilege(const FUniqueNetId& LocalUserId, const EUserPrivileges::Type Privilege,
 		const EShowPrivilegeResolveUI ShowResolveUI = EShowPrivilegeResolveUI::Default);
 
+	/**
+	 * @brief	Waits until a local user is logged in, without starting a login.
+	 *
+	 * @param LocalUserNum			The local user to wait for.
+	 * @param ForceLatentCoroutine	Forces a latent coroutine. Do not set.
+	 *
+	 * @return	The unique id of the user, or nullptr if there is no identity interface.
+	 */
+	TCoroutine<FUniqueNetIdPtr> WaitForLogin(const int32 LocalUserNum, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
 private:
 
-	static inline TWeakPtr<IOnlineIdentity> Identity;
+	TCoroutine<TOptional<FAutoLoginResult>> AutoLoginUser(const FPlatformUserId PlatformUser,
+		const FForceLatentCoroutine ForceLatentCoroutine = {});
 
-	static inline IOnlineIdentity::FOnGetUserPrivilegeCompleteDelegate GetUserPrivilegeDelegate;
+	TCoroutine<FAutoLoginResult> AutoLoginAndReport(const FPlatformUserId PlatformUser,
+		TFunction<void(const FAutoLoginResult& /*Result*/)> OnUserLoggedIn);
 
-	static inline FOnLogoutCompleteDelegate LogoutDelegate;
+	TWeakPtr<IOnlineIdentity> Identity;
 };
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncIdentity::AutoLogin(const FPlatformUserId& PlatformUser, const FForceLatentCoroutine)
 {
-	FOnLoginCompleteDelegate AutoLoginDelegate;
+	TOptional<FAutoLoginResult> Result = co_await AutoLoginUser(PlatformUser);
 
-	static int LocalUserNum = 0;
-	static bool bWasSuccessful = false;
-	static FUniqueNetIdRepl UserId;
-	static FString Error;
-
-	const TCoroutine<> DoAutoLogin = []
-		(const FLatentLambda, int& OutLocalUserNum, bool& bOutWasSuccessful, FUniqueNetIdRepl& OutUserId, FString& OutError,
-			FOnLoginCompleteDelegate& ThisAutoLoginDelegate) -> TCoroutine<>
-	{
-		auto [InnerLocalUserNum, bInnerWasSuccesful, InnerUserId, InnerError] = co_await ThisAutoLoginDelegate;
-
-		Identity.Pin()->OnLoginCompleteDelegates->Clear();
-
-		OutLocalUserNum = InnerLocalUserNum;
-		bOutWasSuccessful = bInnerWasSuccesful;
-		OutUserId = InnerUserId;
-		OutError = InnerError;
-	}(FLambdaParam(this), LocalUserNum, bWasSuccessful, UserId, Error, AutoLoginDelegate);
-	
-	const TCoroutine<> AutoLoginCoroutine = []
-		(const FLatentLambda This, const FPlatformUserId& ThisPlatformUser, 
-			FOnLoginCompleteDelegate& ThisAutoLoginDelegate) -> TCoroutine<>
-	{
-		co_await Latent::Until([This, ThisAutoLoginDelegate]
-			() -> bool
-		{
-			return ThisAutoLoginDelegate.IsBound();
-		});
-
-		if (!Identity.IsValid())
-		{
-			co_return;
-		}
-
-		Identity.Pin()->AddOnLoginCompleteDelegate_Handle(ThisPlatformUser.GetInternalId(), ThisAutoLoginDelegate);
-	
-		if (!Identity.Pin()->AutoLogin(ThisPlatformUser.GetInternalId()))
-		{
-			co_return;
-		}
-
-		co_await Latent::RealSeconds(UE5CoroOSS::GetLoginTimeout());
-
-		co_return;
-	}(FLambdaParam(this), PlatformUser, AutoLoginDelegate);
-
-	if (const int32 Success = co_await Race(AutoLoginCoroutine, DoAutoLogin); !Success)
+	if (!Result.IsSet())
 	{
 		co_return {};
 	}
 
-	T&& Return = ForwardAsTuple(FPlatformUserId::CreateFromInternalId(LocalUserNum), bWasSuccessful, *UserId, Error);
-
-	co_return Return;
+	co_return T(Result->PlatformUser, Result->bWasSuccessful, MoveTemp(Result->UserId), MoveTemp(Result->Error));
 }
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncIdentity::Logout(const FPlatformUserId& PlatformUser, const FForceLatentCoroutine)
 {
+	FOnLogoutCompleteDelegate LogoutDelegate;
+
 	const TCoroutine<> LogoutCoroutine = []
-		(const FLatentLambda This, const FPlatformUserId& ThisPlatformUser) -> TCoroutine<>
+		(const FLatentLambda This, const TSharedPtr<IOnlineIdentity> ThisIdentity, const FPlatformUserId& ThisPlatformUser,
+			FOnLogoutCompleteDelegate& ThisLogoutDelegate) -> TCoroutine<>
 	{
-		co_await Latent::Until([This]
+		co_await Latent::Until([This, &ThisLogoutDelegate]
 			() -> bool
 		{
-			return LogoutDelegate.IsBound();
+			return ThisLogoutDelegate.IsBound();
 		});
 
-		if (!Identity.IsValid())
+		if (!ThisIdentity.IsValid())
 		{
 			co_return;
 		}
 
-		Identity.Pin()->AddOnLogoutCompleteDelegate_Handle(ThisPlatformUser.GetInternalId(), LogoutDelegate);
+		FDelegateHandle LogoutHandle = ThisIdentity->AddOnLogoutCompleteDelegate_Handle(ThisPlatformUser.GetInternalId(),
+			ThisLogoutDelegate);
 
-		if (!Identity.Pin()->Logout(ThisPlatformUser.GetInternalId()))
+		if (!ThisIdentity->Logout(ThisPlatformUser.GetInternalId()))
 		{
+			ThisIdentity->ClearOnLogoutCompleteDelegate_Handle(ThisPlatformUser.GetInternalId(), LogoutHandle);
 			co_return;
 		}
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
-	}(FLambdaParam(this), PlatformUser);
+	}(FLambdaParam(this), Identity.Pin(), PlatformUser, LogoutDelegate);
 
 	int32 LocalUserNum;
 	bool bWasSuccessful = false;
 
-	const TCoroutine<> DoLogout = [](const FLatentLambda, int32& OutLocalUserNum, bool& bOutWasSuccessful) -> TCoroutine<>
+	const TCoroutine<> DoLogout = []
+		(const FLatentLambda, int32& OutLocalUserNum, bool& bOutWasSuccessful, FOnLogoutCompleteDelegate& ThisLogoutDelegate) -> TCoroutine<>
 	{
-		auto [InnerLocalUserNum, InnerWasSuccessful] = co_await LogoutDelegate;
+		auto [InnerLocalUserNum, InnerWasSuccessful] = co_await ThisLogoutDelegate;
 
 		OutLocalUserNum = InnerLocalUserNum;
 		bOutWasSuccessful = InnerWasSuccessful;
-	}(FLambdaParam(this), LocalUserNum, bWasSuccessful);
+	}(FLambdaParam(this), LocalUserNum, bWasSuccessful, LogoutDelegate);
 
 	co_return !co_await Race(LogoutCoroutine, DoLogout) ? TOptional<T>{} : TOptional<T>(ForwardAsTuple(LocalUserNum, bWasSuccessful));
 }
@@ -183,17 +178,23 @@ template <typename T>
 TCoroutine<TOptional<T>> UAsyncIdentity::GetUserPrivilege(const FUniqueNetId& LocalUserId, const EUserPrivileges::Type Privilege,
 	const EShowPrivilegeResolveUI ShowResolveUI)
 {
-	[](const FLatentLambda This, const FUniqueNetId& ThisLocalUserId, const EUserPrivileges::Type ThisPrivilege,
-		const EShowPrivilegeResolveUI ThisShowResolveUI) -> TCoroutine<>
+	IOnlineIdentity::FOnGetUserPrivilegeCompleteDelegate GetUserPrivilegeDelegate;
+
+	[](const FLatentLambda This, const TSharedPtr<IOnlineIdentity> ThisIdentity, const FUniqueNetId& ThisLocalUserId,
+		const EUserPrivileges::Type ThisPrivilege, const EShowPrivilegeResolveUI ThisShowResolveUI,
+		IOnlineIdentity::FOnGetUserPrivilegeCompleteDelegate& ThisGetUserPrivilegeDelegate) -> TCoroutine<>
 	{
-		co_await Latent::Until([This]
+		co_await Latent::Until([This, &ThisGetUserPrivilegeDelegate]
 			() -> bool
 		{
-			return GetUserPrivilegeDelegate.IsBound();
+			return ThisGetUserPrivilegeDelegate.IsBound();
 		});
-		
-		Identity.Pin()->GetUserPrivilege(ThisLocalUserId, ThisPrivilege, GetUserPrivilegeDelegate, ThisShowResolveUI);
-	}(FLambdaParam(Get()), LocalUserId, Privilege, ShowResolveUI);
+
+		if (ThisIdentity.IsValid())
+		{
+			ThisIdentity->GetUserPrivilege(ThisLocalUserId, ThisPrivilege, ThisGetUserPrivilegeDelegate, ThisShowResolveUI);
+		}
+	}(FLambdaParam(this), Identity.Pin(), LocalUserId, Privilege, ShowResolveUI, GetUserPrivilegeDelegate);
 
 	T Return = co_await GetUserPrivilegeDelegate;
 	co_return Return;
@@ -1,4 +1,4 @@
-// Copyright No Bright Shadows. All Rights Reserved.
+﻿// Copyright No Bright Shadows. All Rights Reserved.
 
 #pragma once
 
@@ -79,7 +79,14 @@ TCoroutine<TOptional<T>> UAsyncMessageSanitizer::SanitizeDisplayNames(const TArr
 			return This->SanitizeDisplayNamesDelegate.IsBound();
 		});
 		
-		This->MessageSanitizer.Pin()->SanitizeDisplayNames(ThisDisplayNames, This->SanitizeDisplayNamesDelegate);
+		const TSharedPtr<IMessageSanitizer> ThisMessageSanitizer = This->MessageSanitizer.Pin();
+
+		if (!ThisMessageSanitizer.IsValid())
+		{
+			co_return;
+		}
+
+		ThisMessageSanitizer->SanitizeDisplayNames(ThisDisplayNames, This->SanitizeDisplayNamesDelegate);
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
 	}(FLambdaParam(this), DisplayNames);
@@ -112,8 +119,14 @@ TCoroutine<TOptional<T>> UAsyncMessageSanitizer::QueryBlockedUser(const FPlatfor
 			return This->QueryBlockedUserDelegate.IsBound();
 		});
 		
-		This->MessageSanitizer.Pin()->QueryBlockedUser(ThisLocalUserNum, ThisFromUserId, ThisFromPlatform,
-			This->QueryBlockedUserDelegate);
+		const TSharedPtr<IMessageSanitizer> ThisMessageSanitizer = This->MessageSanitizer.Pin();
+
+		if (!ThisMessageSanitizer.IsValid())
+		{
+			co_return;
+		}
+
+		ThisMessageSanitizer->QueryBlockedUser(ThisLocalUserNum, ThisFromUserId, ThisFromPlatform, This->QueryBlockedUserDelegate);
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
 	}(FLambdaParam(this), LocalUserNum, FromUserId, FromPlatform);
@@ -0,0 +1,106 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Interfaces/OnlineAchievementsInterface.h"
+#include "Interfaces/OnlineStatsInterface.h"
+#include "PlayFabClientDataModels.h"
+#include "UE5Coro.h"
+#include "UE5CoroOSS_Shared.h"
+#include "UE5CoroOSS_WriteJournal.h"
+#include "UE5Coro_OfflineWrites.generated.h"
+
+/**
+ * @brief	Writes stats, achievements and PlayFab user data through a durable journal, so they survive lost connections
+ *			and crashes.
+ *
+ *	Every write is appended to the journal and replayed as soon as possible. Writes to the same key are coalesced while
+ *	they wait, so a reconnect sends one request per user and backend rather than one per write. A replay that fails is
+ *	retried after an exponential, jittered delay between oss.offlinewrites.retrydelay and oss.offlinewrites.maxretrydelay
+ *	seconds.
+ *
+ * @note	A summed stat the backend accepted is added twice if the game crashes before its acknowledgement is synced,
+ *			at most oss.offlinewrites.syncinterval seconds later. Every other write is safe to send again.
+ */
+UCLASS()
+class UE5COROOSS_API UAsyncOfflineWrites final : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UAsyncOfflineWrites();
+
+	//~UGameInstanceSubsystem Interface Begin
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+	//~UGameInstanceSubsystem Interface End
+
+	static UAsyncOfflineWrites* Get(const UObject* WorldContext = nullptr);
+
+	/**
+	 * @brief	Journal a stats update, to be written with UAsyncStats::UpdateStats.
+	 *
+	 * @param LocalUserId	The user to update the stats as (if applicable).
+	 * @param UpdatedStats	The array of user to stats pairs to update the backend with.
+	 */
+	void UpdateStats(const FUniqueNetIdRef LocalUserId, const TArray<FOnlineStatsUserUpdatedStats>& UpdatedStats);
+
+	/**
+	 * @brief	Journal achievement progress, to be written with UAsyncAchievements::WriteAchievements.
+	 *
+	 * @param PlayerId		The id of the player who is making progress.
+	 * @param WriteObject	The stats holding the progress of each achievement.
+	 */
+	void WriteAchievements(const FUniqueNetId& PlayerId, const FOnlineAchievementsWriteRef& WriteObject);
+
+	/**
+	 * @brief	Journal a user data update, to be written with UAsyncPlayFabClient::UpdateUserData as the logged in player.
+	 *
+	 *	The write belongs to the PlayFab player logged in now, and is only replayed while that player is logged in.
+	 *
+	 * @param Request	PlayFab::ClientModels::FUpdateUserDataRequest
+	 *
+	 * @return	False if no PlayFab player is logged in, so the update was not journaled.
+	 */
+	bool UpdateUserData(const PlayFab::ClientModels::FUpdateUserDataRequest& Request);
+
+	/**
+	 * @brief	Replay pending writes now instead of waiting out the retry delay, for example once connectivity returns.
+	 */
+	void ReplayNow();
+
+	int32 GetPendingWriteCount() const;
+
+private:
+
+	bool Tick(float DeltaTime);
+
+	bool IsReplayInFlight() const;
+
+	TCoroutine<> Replay(const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	TCoroutine<bool> ReplayStats(const FUniqueNetIdRepl LocalUserId, TArray<FOfflineWrite> Writes,
+		const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	TCoroutine<bool> ReplayAchievements(const FUniqueNetIdRepl UserId, TArray<FOfflineWrite> Writes,
+		const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/** Replay user data written as the logged in PlayFab player. Replay leaves writes of other players pending. */
+	TCoroutine<bool> ReplayUserData(TArray<FOfflineWrite> Writes, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	FOfflineWriteJournal WriteJournal;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	TOptional<TCoroutine<>> CurrentReplay;
+
+	double LastSyncTime = 0.0;
+
+	double NextReplayTime = 0.0;
+
+	int32 FailedReplays = 0;
+};
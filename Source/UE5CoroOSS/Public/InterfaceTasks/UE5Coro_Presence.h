@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "UE5Coro.h"
+#include "UE5CoroOSS_Shared.h"
 #include "Interfaces/OnlinePresenceInterface.h"
 #include "UE5Coro_Presence.generated.h"
 
@@ -22,7 +23,7 @@ public:
 	virtual void Deinitialize() override;
 	//~UGameInstanceSubsystem Interface End
 
-	static UAsyncPresence* Get();
+	static UAsyncPresence* Get(const UObject* WorldContext = nullptr);
 
 	/**
 	 * @brief	Starts an async operation that will update the cache with presence data from all users in the Users array.
@@ -35,28 +36,32 @@ public:
 	 * @return	See: FOnPresenceTaskCompleteDelegate
 	 */
 	template <typename T = TTuple<const FUniqueNetId& /*UserId*/, bool /*bWasSuccessful*/>>
-	static TCoroutine<TOptional<T>> QueryPresence(const FUniqueNetId& LocalUserId, const TArray<FUniqueNetIdRef>& UserIds);
+	TCoroutine<TOptional<T>> QueryPresence(const FUniqueNetId& LocalUserId, const TArray<FUniqueNetIdRef>& UserIds);
 
 private:
 
-	static inline TWeakPtr<IOnlinePresence> Presence;
-
-	static inline IOnlinePresence::FOnPresenceTaskCompleteDelegate QueryPresenceDelegate;
+	TWeakPtr<IOnlinePresence> Presence;
 };
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncPresence::QueryPresence(const FUniqueNetId& LocalUserId, const TArray<FUniqueNetIdRef>& UserIds)
 {
-	[](const FLatentLambda This, const FUniqueNetId& ThisLocalUserId, const TArray<FUniqueNetIdRef>& ThisUserIds) -> TCoroutine<>
+	IOnlinePresence::FOnPresenceTaskCompleteDelegate QueryPresenceDelegate;
+
+	[](const FLatentLambda This, const TSharedPtr<IOnlinePresence> ThisPresence, const FUniqueNetId& ThisLocalUserId,
+		const TArray<FUniqueNetIdRef>& ThisUserIds, IOnlinePresence::FOnPresenceTaskCompleteDelegate& ThisQueryPresenceDelegate) -> TCoroutine<>
 	{
-		co_await Latent::Until([This]
+		co_await Latent::Until([This, &ThisQueryPresenceDelegate]
 			() -> bool
 		{
-			return QueryPresenceDelegate.IsBound();
+			return ThisQueryPresenceDelegate.IsBound();
 		});
-		
-		Presence.Pin()->QueryPresence(ThisLocalUserId, ThisUserIds, QueryPresenceDelegate);
-	}(FLambdaParam(Get()), LocalUserId, UserIds);
+
+		if (ThisPresence.IsValid())
+		{
+			ThisPresence->QueryPresence(ThisLocalUserId, ThisUserIds, ThisQueryPresenceDelegate);
+		}
+	}(FLambdaParam(this), Presence.Pin(), LocalUserId, UserIds, QueryPresenceDelegate);
 
 	T&& Return = co_await QueryPresenceDelegate;
 	co_return Return;
@@ -24,7 +24,7 @@ public:
 	virtual void Deinitialize() override;
 	//~UGameInstanceSubsystem Interface End
 
-	static UAsyncSession* Get(const UObject* WorldContext = GEngine->GameViewport.Get());
+	static UAsyncSession* Get(const UObject* WorldContext = nullptr);
 
 	/**
 	 * @brief	Create a new session.
@@ -95,41 +95,40 @@ public:
 
 private:
 
-	static inline TWeakPtr<IOnlineSession> Session;
-
-	static inline FOnSingleSessionResultComplete::FDelegate FindSessionByIdDelegate;
+	TWeakPtr<IOnlineSession> Session;
 };
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncSession::CreateSession(const FPlatformUserId LocalUserNum, const FName SessionName,
 	const FOnlineSessionSettings& Settings, const FForceLatentCoroutine)
 {
-	if (!ensureMsgf(Session.Pin()->GetSessionState(SessionName) != EOnlineSessionState::InProgress,
+	const TSharedPtr<IOnlineSession> PinnedSession = Session.Pin();
+
+	if (!PinnedSession.IsValid() || !ensureMsgf(PinnedSession->GetSessionState(SessionName) != EOnlineSessionState::InProgress,
 		TEXT("Attempted to create session while session already in progress!")))
 	{
 		co_return {};
 	}
 	
-	static FName SessionName2;
-	static bool bWasSuccessful;
+	FName SessionName2;
+	bool bWasSuccessful = false;
 
 	FOnCreateSessionCompleteDelegate CreateSessionCompleteDelegate;
+	FDelegateHandle CreateSessionCompleteHandle;
 
 	const TCoroutine<> DoCreateSession = []
-		(const FLatentLambda, FOnCreateSessionCompleteDelegate& ThisCreateSessionCompleteDelegate,
+		(const FLatentLambda, const TSharedPtr<IOnlineSession> ThisSession, FOnCreateSessionCompleteDelegate& ThisCreateSessionCompleteDelegate,
 			FName& OutSessionName, bool& OutbWasSuccessful) -> TCoroutine<>
 	{
 		auto [InnerSessionName, bInnerWasSuccessful] = co_await ThisCreateSessionCompleteDelegate;
 
-		Session.Pin()->OnCreateSessionCompleteDelegates.Clear();
-
 		OutSessionName = InnerSessionName;
 		OutbWasSuccessful = bInnerWasSuccessful;
-	}(FLambdaParam(this), CreateSessionCompleteDelegate, SessionName2, bWasSuccessful);
+	}(FLambdaParam(this), PinnedSession, CreateSessionCompleteDelegate, SessionName2, bWasSuccessful);
 	
 	const TCoroutine<> CreateSessionCoroutine = []
-		(const FLatentLambda, FOnCreateSessionCompleteDelegate& ThisCreateSessionCompleteDelegate, const FPlatformUserId ThisLocalUserNum,
-			const FName ThisSessionName, const FOnlineSessionSettings ThisSettings) -> TCoroutine<>
+		(const FLatentLambda, const TSharedPtr<IOnlineSession> ThisSession, FOnCreateSessionCompleteDelegate& ThisCreateSessionCompleteDelegate,
+			FDelegateHandle& OutCreateSessionCompleteHandle, const FPlatformUserId ThisLocalUserNum, const FName ThisSessionName, const FOnlineSessionSettings ThisSettings) -> TCoroutine<>
 	{
 		co_await Latent::Until(std::function([ThisCreateSessionCompleteDelegate]
 			() -> bool
@@ -137,65 +136,75 @@ TCoroutine<TOptional<T>> UAsyncSession::CreateSession(const FPlatformUserId Loca
 			return ThisCreateSessionCompleteDelegate.IsBound();
 		}));
 
-		if (!Session.IsValid())
+		if (!ThisSession.IsValid())
 		{
 			co_return;
 		}
 	
-		Session.Pin()->AddOnCreateSessionCompleteDelegate_Handle(ThisCreateSessionCompleteDelegate);
+		OutCreateSessionCompleteHandle = ThisSession->AddOnCreateSessionCompleteDelegate_Handle(ThisCreateSessionCompleteDelegate);
 		
-		if (!Session.Pin()->CreateSession(ThisLocalUserNum, ThisSessionName, ThisSettings))
+		if (!ThisSession->CreateSession(ThisLocalUserNum, ThisSessionName, ThisSettings))
 		{
 			co_return;
 		}
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
-	}(FLambdaParam(this), CreateSessionCompleteDelegate, LocalUserNum, SessionName, Settings);
+	}(FLambdaParam(this), PinnedSession, CreateSessionCompleteDelegate, CreateSessionCompleteHandle, LocalUserNum, SessionName, Settings);
+
+	const int32 Completed = co_await Race(CreateSessionCoroutine, DoCreateSession);
+
+	// Only this operation's delegate is removed, so concurrent callers keep theirs.
+	if (PinnedSession.IsValid())
+	{
+		PinnedSession->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteHandle);
+	}
 
-	co_return !co_await Race(CreateSessionCoroutine, DoCreateSession) ? Session.Pin()->OnCreateSessionCompleteDelegates.Clear(), TOptional<T>()
-		: T(SessionName2, bWasSuccessful);
+	co_return !Completed ? TOptional<T>() : T(SessionName2, bWasSuccessful);
 }
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncSession::FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId,
 	const FUniqueNetId& FriendId, const FForceLatentCoroutine)
 {
-	static int32 LocalUserNum;
-	static bool bWasSuccessful;
-	static FOnlineSessionSearchResult SearchResult;
+	int32 LocalUserNum = 0;
+	bool bWasSuccessful = false;
+	FOnlineSessionSearchResult SearchResult;
+
+	FOnSingleSessionResultComplete::FDelegate FindSessionByIdDelegate;
 
 	const TCoroutine<> DoFindSessionById = []
-		(const FLatentLambda, int32& OutLocalUserNum, bool& OutbWasSuccessful, FOnlineSessionSearchResult& OutSearchResult) -> TCoroutine<>
+		(const FLatentLambda, FOnSingleSessionResultComplete::FDelegate& ThisFindSessionByIdDelegate, int32& OutLocalUserNum,
+			bool& OutbWasSuccessful, FOnlineSessionSearchResult& OutSearchResult) -> TCoroutine<>
 	{
-		auto [InnerLocalUserNum, InnerbWasSuccessful, InnerSearchResult] = co_await FindSessionByIdDelegate;
+		auto [InnerLocalUserNum, InnerbWasSuccessful, InnerSearchResult] = co_await ThisFindSessionByIdDelegate;
 
 		OutLocalUserNum = InnerLocalUserNum;
 		OutbWasSuccessful = InnerbWasSuccessful;
 		OutSearchResult = InnerSearchResult;
-	}(FLambdaParam(this), LocalUserNum, bWasSuccessful, SearchResult);
+	}(FLambdaParam(this), FindSessionByIdDelegate, LocalUserNum, bWasSuccessful, SearchResult);
 	
 	const TCoroutine<> FindSessionCoroutine = []
-		(const FLatentLambda, const FUniqueNetId& ThisSearchingUserId, const FUniqueNetId& ThisSessionId, const FUniqueNetId& ThisFriendId)
-			-> TCoroutine<>
+		(const FLatentLambda, const TSharedPtr<IOnlineSession> ThisSession, FOnSingleSessionResultComplete::FDelegate& ThisFindSessionByIdDelegate,
+			const FUniqueNetId& ThisSearchingUserId, const FUniqueNetId& ThisSessionId, const FUniqueNetId& ThisFriendId) -> TCoroutine<>
 	{
-		co_await Latent::Until(std::function([]
+		co_await Latent::Until(std::function([&ThisFindSessionByIdDelegate]
 			() -> bool
 		{
-			return FindSessionByIdDelegate.IsBound();
+			return ThisFindSessionByIdDelegate.IsBound();
 		}));
 
-		if (!Session.IsValid())
+		if (!ThisSession.IsValid())
 		{
 			co_return;
 		}
 	
-		if (!Session.Pin()->FindSessionById(ThisSearchingUserId, ThisSessionId, ThisFriendId, FindSessionByIdDelegate))
+		if (!ThisSession->FindSessionById(ThisSearchingUserId, ThisSessionId, ThisFriendId, ThisFindSessionByIdDelegate))
 		{
 			co_return;
 		}
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
-	}(FLambdaParam(this), SearchingUserId, SessionId, FriendId);
+	}(FLambdaParam(this), Session.Pin(), FindSessionByIdDelegate, SearchingUserId, SessionId, FriendId);
 	
 	co_return !co_await Race(FindSessionCoroutine, DoFindSessionById) ? TOptional<T>()
 		: T(LocalUserNum, bWasSuccessful, FOnlineSessionSearchResultBP::FromNative(SearchResult));
@@ -205,10 +214,13 @@ template <typename T>
 TCoroutine<TOptional<T>> UAsyncSession::JoinSession(const FUniqueNetId& LocalUserId, const FName SessionName,
 	const FOnlineSessionSearchResult& DesiredSession, const FForceLatentCoroutine)
 {
-	static FName SessionName2;
-	static EOnJoinSessionCompleteResult::Type JoinSessionCompleteResult;
+	const TSharedPtr<IOnlineSession> PinnedSession = Session.Pin();
+
+	FName SessionName2;
+	EOnJoinSessionCompleteResult::Type JoinSessionCompleteResult = EOnJoinSessionCompleteResult::UnknownError;
 
 	FOnJoinSessionCompleteDelegate JoinSessionCompleteDelegate;
+	FDelegateHandle JoinSessionCompleteHandle;
 
 	const TCoroutine<> DoJoinSession = []
 		(const FLatentLambda, FOnJoinSessionCompleteDelegate& ThisJoinSessionCompleteDelegate, FName& OutSessionName,
@@ -221,8 +233,8 @@ TCoroutine<TOptional<T>> UAsyncSession::JoinSession(const FUniqueNetId& LocalUse
 	}(FLambdaParam(this), JoinSessionCompleteDelegate, SessionName2, JoinSessionCompleteResult);
 	
 	const TCoroutine<> JoinSessionCoroutine = []
-		(const FLatentLambda, FOnJoinSessionCompleteDelegate& ThisJoinSessionCompleteDelegate, const FUniqueNetId& ThisLocalUserId,
-			const FName ThisSessionName, const FOnlineSessionSearchResult& ThisDesiredSession) -> TCoroutine<>
+		(const FLatentLambda, const TSharedPtr<IOnlineSession> ThisSession, FOnJoinSessionCompleteDelegate& ThisJoinSessionCompleteDelegate,
+			FDelegateHandle& OutJoinSessionCompleteHandle, const FUniqueNetId& ThisLocalUserId, const FName ThisSessionName, const FOnlineSessionSearchResult& ThisDesiredSession) -> TCoroutine<>
 	{
 		co_await Latent::Until(std::function([ThisJoinSessionCompleteDelegate]
 			() -> bool
@@ -230,31 +242,41 @@ TCoroutine<TOptional<T>> UAsyncSession::JoinSession(const FUniqueNetId& LocalUse
 			return ThisJoinSessionCompleteDelegate.IsBound();
 		}));
 
-		if (!Session.IsValid())
+		if (!ThisSession.IsValid())
 		{
 			co_return;
 		}
 	
-		Session.Pin()->AddOnJoinSessionCompleteDelegate_Handle(ThisJoinSessionCompleteDelegate);
+		OutJoinSessionCompleteHandle = ThisSession->AddOnJoinSessionCompleteDelegate_Handle(ThisJoinSessionCompleteDelegate);
 		
-		if (!Session.Pin()->JoinSession(ThisLocalUserId, ThisSessionName, ThisDesiredSession))
+		if (!ThisSession->JoinSession(ThisLocalUserId, ThisSessionName, ThisDesiredSession))
 		{
 			co_return;
 		}
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
-	}(FLambdaParam(this), JoinSessionCompleteDelegate, LocalUserId, SessionName, DesiredSession);
+	}(FLambdaParam(this), PinnedSession, JoinSessionCompleteDelegate, JoinSessionCompleteHandle, LocalUserId, SessionName, DesiredSession);
+
+	const int32 Completed = co_await Race(JoinSessionCoroutine, DoJoinSession);
+
+	if (PinnedSession.IsValid())
+	{
+		PinnedSession->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteHandle);
+	}
 
-	co_return !co_await Race(JoinSessionCoroutine, DoJoinSession) ? TOptional<T>() : T(SessionName2, JoinSessionCompleteResult);
+	co_return !Completed ? TOptional<T>() : T(SessionName2, JoinSessionCompleteResult);
 }
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncSession::EndSession(const FName SessionName, const FForceLatentCoroutine)
 {
-	static FName SessionName2;
-	static bool bWasSuccessful;
+	const TSharedPtr<IOnlineSession> PinnedSession = Session.Pin();
+
+	FName SessionName2;
+	bool bWasSuccessful = false;
 
 	FOnEndSessionCompleteDelegate EndSessionCompleteDelegate;
+	FDelegateHandle EndSessionCompleteHandle;
 
 	const TCoroutine<> DoEndSession = []
 		(const FLatentLambda, FOnEndSessionCompleteDelegate& ThisEndSessionCompleteDelegate, FName& OutSessionName, bool& OutbWasSuccessful)
@@ -267,7 +289,8 @@ TCoroutine<TOptional<T>> UAsyncSession::EndSession(const FName SessionName, cons
 	}(FLambdaParam(this), EndSessionCompleteDelegate, SessionName2, bWasSuccessful);
 	
 	const TCoroutine<> EndSessionCoroutine = []
-		(const FLatentLambda, FOnEndSessionCompleteDelegate& ThisEndSessionCompleteDelegate, const FName ThisSessionName) -> TCoroutine<>
+		(const FLatentLambda, const TSharedPtr<IOnlineSession> ThisSession, FOnEndSessionCompleteDelegate& ThisEndSessionCompleteDelegate,
+			FDelegateHandle& OutEndSessionCompleteHandle, const FName ThisSessionName) -> TCoroutine<>
 	{
 		co_await Latent::Until(std::function([ThisEndSessionCompleteDelegate]
 			() -> bool
@@ -275,31 +298,41 @@ TCoroutine<TOptional<T>> UAsyncSession::EndSession(const FName SessionName, cons
 			return ThisEndSessionCompleteDelegate.IsBound();
 		}));
 
-		if (!Session.IsValid())
+		if (!ThisSession.IsValid())
 		{
 			co_return;
 		}
 	
-		Session.Pin()->AddOnEndSessionCompleteDelegate_Handle(ThisEndSessionCompleteDelegate);
+		OutEndSessionCompleteHandle = ThisSession->AddOnEndSessionCompleteDelegate_Handle(ThisEndSessionCompleteDelegate);
 		
-		if (!Session.Pin()->EndSession(ThisSessionName))
+		if (!ThisSession->EndSession(ThisSessionName))
 		{
 			co_return;
 		}
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
-	}(FLambdaParam(this), EndSessionCompleteDelegate, SessionName);
+	}(FLambdaParam(this), PinnedSession, EndSessionCompleteDelegate, EndSessionCompleteHandle, SessionName);
+
+	const int32 Completed = co_await Race(EndSessionCoroutine, DoEndSession);
+
+	if (PinnedSession.IsValid())
+	{
+		PinnedSession->ClearOnEndSessionCompleteDelegate_Handle(EndSessionCompleteHandle);
+	}
 
-	co_return !co_await Race(EndSessionCoroutine, DoEndSession) ? TOptional<T>() : T(SessionName2, bWasSuccessful);
+	co_return !Completed ? TOptional<T>() : T(SessionName2, bWasSuccessful);
 }
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncSession::DestroySession(const FName SessionName, const FForceLatentCoroutine)
 {
-	static FName SessionName2;
-	static bool bWasSuccessful;
+	const TSharedPtr<IOnlineSession> PinnedSession = Session.Pin();
+
+	FName SessionName2;
+	bool bWasSuccessful = false;
 
 	const FOnDestroySessionCompleteDelegate DestroySessionCompleteDelegate;
+	FDelegateHandle DestroySessionCompleteHandle;
 
 	const TCoroutine<> DoDestroySession = []
 		(const FLatentLambda, FOnDestroySessionCompleteDelegate ThisDestroySessionCompleteDelegate, FName& OutSessionName, bool& OutbWasSuccessful)
@@ -312,7 +345,8 @@ TCoroutine<TOptional<T>> UAsyncSession::DestroySession(const FName SessionName,
 	}(FLambdaParam(this), DestroySessionCompleteDelegate, SessionName2, bWasSuccessful);
 	
 	const TCoroutine<> DestroySessionCoroutine = []
-		(const FLatentLambda, FOnDestroySessionCompleteDelegate ThisDestroySessionCompleteDelegate, const FName ThisSessionName) -> TCoroutine<>
+		(const FLatentLambda, const TSharedPtr<IOnlineSession> ThisSession, FOnDestroySessionCompleteDelegate ThisDestroySessionCompleteDelegate,
+			FDelegateHandle& OutDestroySessionCompleteHandle, const FName ThisSessionName) -> TCoroutine<>
 	{
 		co_await Latent::Until(std::function([ThisDestroySessionCompleteDelegate]
 			() -> bool
@@ -320,20 +354,27 @@ TCoroutine<TOptional<T>> UAsyncSession::DestroySession(const FName SessionName,
 			return ThisDestroySessionCompleteDelegate.IsBound();
 		}));
 
-		if (!Session.IsValid())
+		if (!ThisSession.IsValid())
 		{
 			co_return;
 		}
 	
-		Session.Pin()->AddOnDestroySessionCompleteDelegate_Handle(ThisDestroySessionCompleteDelegate);
+		OutDestroySessionCompleteHandle = ThisSession->AddOnDestroySessionCompleteDelegate_Handle(ThisDestroySessionCompleteDelegate);
 		
-		if (!Session.Pin()->DestroySession(ThisSessionName))
+		if (!ThisSession->DestroySession(ThisSessionName))
 		{
 			co_return;
 		}
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
-	}(FLambdaParam(Get()), DestroySessionCompleteDelegate, SessionName);
+	}(FLambdaParam(this), PinnedSession, DestroySessionCompleteDelegate, DestroySessionCompleteHandle, SessionName);
+
+	const int32 Completed = co_await Race(DestroySessionCoroutine, DoDestroySession);
+
+	if (PinnedSession.IsValid())
+	{
+		PinnedSession->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteHandle);
+	}
 
-	co_return !co_await Race(DestroySessionCoroutine, DoDestroySession) ? TOptional<T>() : T(SessionName2, bWasSuccessful);
+	co_return !Completed ? TOptional<T>() : T(SessionName2, bWasSuccessful);
 }
\ No newline at end of file
@@ -20,11 +20,13 @@ public:
 
 	//~UGameInstanceSubsystem Interface Begin
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
 	//~UGameInstanceSubsystem Interface End
 
-	static UAsyncStats* Get();
+	static UAsyncStats* Get(const UObject* WorldContext = nullptr);
 	
-	static void SetInterfaceName(FName Name);
+	void SetInterfaceName(FName Name);
 
 	/**
 	 * @brief	Query one or more users' stats.
@@ -52,15 +54,15 @@ public:
 
 private:
 
-	static inline TWeakPtr<IOnlineStats> Stats;
+	TWeakPtr<IOnlineStats> Stats;
 };
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncStats::QueryStats(const FUniqueNetIdRef LocalUserId, const TArray<FUniqueNetIdRef>& StatUsers,
 	const TArray<FString>& StatNames)
 {
-	static FOnlineError StaticResultError;
-	static TArray<TSharedRef<const FOnlineStatsUserStats>> StaticUsersStatsResult;
+	FOnlineError ResultError;
+	TArray<TSharedRef<const FOnlineStatsUserStats>> UsersStatsResult;
 
 	FOnlineStatsQueryUsersStatsComplete QueryUsersStatsComplete;
 
@@ -72,32 +74,32 @@ TCoroutine<TOptional<T>> UAsyncStats::QueryStats(const FUniqueNetIdRef LocalUser
 		
 		ThisResultError = InnerResultError;
 		ThisUsersStatsResult = InnerUsersStatsResult;
-	}(FLambdaParam(this), QueryUsersStatsComplete, StaticResultError, StaticUsersStatsResult);
+	}(FLambdaParam(this), QueryUsersStatsComplete, ResultError, UsersStatsResult);
 
 	const TCoroutine<> QueryStatsCoroutine = []
-		(const FLatentLambda, FOnlineStatsQueryUsersStatsComplete& ThisQueryUsersStatsComplete, const FUniqueNetIdRef& ThisLocalUserId,
-			const TArray<FUniqueNetIdRef>& ThisStatUsers, const TArray<FString>& ThisStatNames) -> TCoroutine<>
+		(const FLatentLambda, const TSharedPtr<IOnlineStats> ThisStats, FOnlineStatsQueryUsersStatsComplete& ThisQueryUsersStatsComplete,
+			const FUniqueNetIdRef& ThisLocalUserId, const TArray<FUniqueNetIdRef>& ThisStatUsers, const TArray<FString>& ThisStatNames) -> TCoroutine<>
 	{
 		co_await Latent::Until([ThisQueryUsersStatsComplete]
 		{
 			return ThisQueryUsersStatsComplete.IsBound();
 		});
 
-		if (!Stats.IsValid())
+		if (!ThisStats.IsValid())
 		{
 			co_return;
 		}
 
-		Stats.Pin()->QueryStats(ThisLocalUserId, ThisStatUsers, ThisStatNames, ThisQueryUsersStatsComplete);
-	}(FLambdaParam(this), QueryUsersStatsComplete, LocalUserId, StatUsers, StatNames);
+		ThisStats->QueryStats(ThisLocalUserId, ThisStatUsers, ThisStatNames, ThisQueryUsersStatsComplete);
+	}(FLambdaParam(this), Stats.Pin(), QueryUsersStatsComplete, LocalUserId, StatUsers, StatNames);
 
-	co_return !co_await Race(DoQueryStats, QueryStatsCoroutine) ? T() : T(StaticResultError, StaticUsersStatsResult);
+	co_return !co_await Race(DoQueryStats, QueryStatsCoroutine) ? T() : T(ResultError, UsersStatsResult);
 }
 
 template <typename T>
 TCoroutine<TOptional<T>> UAsyncStats::UpdateStats(const FUniqueNetIdRef LocalUserId, const TArray<FOnlineStatsUserUpdatedStats>& UpdatedStats)
 {
-	static FOnlineError StaticResultError;
+	FOnlineError ResultError;
 
 	FOnlineStatsUpdateStatsComplete UpdateUserStatsComplete;
 
@@ -107,26 +109,26 @@ TCoroutine<TOptional<T>> UAsyncStats::UpdateStats(const FUniqueNetIdRef LocalUse
 		auto [InnerResultError] = co_await ThisUpdateUserStatsComplete;
 		
 		ThisResultError = InnerResultError;
-	}(FLambdaParam(this), UpdateUserStatsComplete, StaticResultError);
+	}(FLambdaParam(this), UpdateUserStatsComplete, ResultError);
 
 	const TCoroutine<> UpdateStatsCoroutine = []
-		(const FLatentLambda, FOnlineStatsUpdateStatsComplete& ThisUpdateUserStatsComplete, const FUniqueNetIdRef& ThisLocalUserId,
-			const TArray<FOnlineStatsUserUpdatedStats>& ThisUpdatedStats) -> TCoroutine<>
+		(const FLatentLambda, const TSharedPtr<IOnlineStats> ThisStats, FOnlineStatsUpdateStatsComplete& ThisUpdateUserStatsComplete,
+			const FUniqueNetIdRef& ThisLocalUserId, const TArray<FOnlineStatsUserUpdatedStats>& ThisUpdatedStats) -> TCoroutine<>
 	{
 		co_await Latent::Until([ThisUpdateUserStatsComplete]
 		{
 			return ThisUpdateUserStatsComplete.IsBound();
 		});
 
-		if (!Stats.IsValid())
+		if (!ThisStats.IsValid())
 		{
 			co_return;
 		}
 
-		Stats.Pin()->UpdateStats(ThisLocalUserId, ThisUpdatedStats, ThisUpdateUserStatsComplete);
+		ThisStats->UpdateStats(ThisLocalUserId, ThisUpdatedStats, ThisUpdateUserStatsComplete);
 
 		co_await Async::PlatformSeconds(UE5CoroOSS::GetTimeout());
-	}(FLambdaParam(this), UpdateUserStatsComplete, LocalUserId, UpdatedStats);
+	}(FLambdaParam(this), Stats.Pin(), UpdateUserStatsComplete, LocalUserId, UpdatedStats);
 
-	co_return !co_await Race(DoUpdateStats, UpdateStatsCoroutine) ? T() : T(StaticResultError);
+	co_return !co_await Race(DoUpdateStats, UpdateStatsCoroutine) ? T() : T(ResultError);
 }
@@ -6,12 +6,14 @@
 #include "UE5Coro.h"
 #include "PlayFabAuthenticationDataModels.h"
 #include "PlayFabError.h"
-#include "Containers/Union.h"
 #include "Core/PlayFabAuthenticationAPI.h"
+#include "PlayFabHelpers/PlayFabCall.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "AsyncPlayFabAuthentication.generated.h"
 
-typedef TUnion<PlayFab::AuthenticationModels::FGetEntityTokenResponse, PlayFab::FPlayFabCppError> FGetEntityTokenUnion;
+typedef TPlayFabOutcome<PlayFab::AuthenticationModels::FGetEntityTokenResponse> FGetEntityTokenOutcome;
+
+using FGetEntityTokenUnion UE_DEPRECATED(5.4, "Use FGetEntityTokenOutcome instead.") = FGetEntityTokenOutcome;
 
 UCLASS()
 class UE5COROOSS_API UAsyncPlayFabAuthentication final : public UGameInstanceSubsystem
@@ -24,9 +26,27 @@ public:
 
 	//~USubsystem Interface Begin
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
 	//~USubsystem Interface End
 
-	static UAsyncPlayFabAuthentication* Get(const UObject* WorldContext = GEngine->GameViewport);
+	static UAsyncPlayFabAuthentication* Get(const UObject* WorldContext = nullptr);
+
+	/**
+	 * @brief	Call any endpoint of the PlayFab Authentication API.
+	 *
+	 * @param Method	The endpoint, for example &PlayFab::UPlayFabAuthenticationAPI::GetEntityToken.
+	 * @param Request	The request to send.
+	 * @param Priority	Priority class of the request. The scoped priority, or interactive, if not given.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	template <typename TRequest, typename TResponse>
+	TCoroutine<TOptional<TPlayFabOutcome<TResponse>>> Call(const TPlayFabMethod<PlayFab::UPlayFabAuthenticationAPI, TRequest, TResponse> Method,
+		std::remove_const_t<TRequest> Request, const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority())
+	{
+		return UE5CoroOSS::CallPlayFab(AuthenticationAPI, Method, MoveTemp(Request), Priority);
+	}
 
 	/**
 	 * @brief	Method to exchange a legacy AuthenticationTicket or title SecretKey for an Entity Token or to refresh a still valid
@@ -37,15 +57,85 @@ public:
 	 *			freshly logged in and will issue a new token. If using X-Authentication or X-EntityToken the header must still be
 	 *			valid and cannot be expired or revoked.
 	 *
+	 * @note	The token is stored in and tracked for Request.AuthenticationContext, or the global session if it is null.
+	 *
 	 * @param	Request					PlayFab::AuthenticationModels::FGetEntityTokenRequest
 	 * @param	ForceLatentCoroutine	Do not set. Forces latent coroutine.
 	 *
-	 * @return	When awaited, return a union structure containing either the FGetEntityTokenResponse or FPlayFabCppError.
+	 * @return	When awaited, return an optional outcome containing either the FGetEntityTokenResponse or FPlayFabCppError.
 	 */
-	TCoroutine<TOptional<FGetEntityTokenUnion>> GetEntityToken(PlayFab::AuthenticationModels::FGetEntityTokenRequest Request,
+	TCoroutine<TOptional<FGetEntityTokenOutcome>> GetEntityToken(PlayFab::AuthenticationModels::FGetEntityTokenRequest Request,
 		const FForceLatentCoroutine ForceLatentCoroutine = {});
 
+	/**
+	 * @brief	Start managing the entity token PlayFab issued, refreshing it before it expires.
+	 *
+	 *	Called for every login made through UAsyncPlayFabClient and every successful GetEntityToken. The token is
+	 *	refreshed in the background oss.playfab.tokenrefreshahead seconds before TokenExpiration. Every player's token
+	 *	is managed on its own.
+	 *
+	 * @param TokenExpiration		When the current entity token expires, in UTC.
+	 * @param AuthenticationContext	The player the token belongs to. The player of the global session if null.
+	 */
+	void TrackEntityToken(const FDateTime& TokenExpiration, TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext = nullptr);
+
+	/**
+	 * @brief	Stop managing the entity token of a player, for example once they sign out.
+	 *
+	 * @param AuthenticationContext	The player the token belongs to. The player of the global session if null.
+	 */
+	void ForgetEntityToken(const TSharedPtr<UPlayFabAuthenticationContext>& AuthenticationContext);
+
+	/**
+	 * @brief	Wait until the entity token of a player can be used.
+	 *
+	 *	Completes right away while the token is valid, starting a background refresh if it is due. Only once the token
+	 *	is within oss.playfab.tokenexpirymargin seconds of expiring does this wait for the refresh, which is shared
+	 *	with every other caller for the same player. Completes right away if no token is tracked for the player.
+	 *
+	 * @param AuthenticationContext	The player the call is made as. The player of the global session if null.
+	 *
+	 * @return	When awaited, returns false if the token expired and could not be refreshed.
+	 */
+	TCoroutine<bool> WaitForEntityToken(TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext = nullptr);
+
+	/**
+	 * @brief	Refresh the entity token of a player now, or join the refresh already in flight.
+	 *
+	 * @param AuthenticationContext	The player the token belongs to. The player of the global session if null.
+	 *
+	 * @return	When awaited, returns true if the token was refreshed.
+	 */
+	TCoroutine<bool> RefreshEntityToken(TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext = nullptr);
+
+	bool HasValidEntityToken(const TSharedPtr<UPlayFabAuthenticationContext>& AuthenticationContext = nullptr) const;
+
+	/** The error calls complete with when WaitForEntityToken fails, instead of being sent with an expired token. */
+	static PlayFab::FPlayFabCppError MakeEntityTokenExpiredError();
+
 private:
-	
+
+	struct FEntityToken
+	{
+		TOptional<FDateTime> Expiration;
+
+		TOptional<TCoroutine<bool>> Refresh;
+
+		/** Bumped on every tracked token, so the refresh loop of a replaced token knows to stop. */
+		uint32 Generation = 0;
+	};
+
+	TCoroutine<bool> SendEntityTokenRefresh(TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext,
+		const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	TCoroutine<> KeepEntityTokenFresh(TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext, const uint32 Generation,
+		const FForceLatentCoroutine ForceLatentCoroutine = {});
+
 	TSharedPtr<PlayFab::UPlayFabAuthenticationAPI> AuthenticationAPI;
+
+	/** The tracked entity token of every player. The null key is the player of the global session. */
+	TMap<TSharedPtr<UPlayFabAuthenticationContext>, FEntityToken> EntityTokens;
+
+	/** Never reused, so a loop whose token was forgotten and tracked again still knows to stop. */
+	uint32 NextEntityTokenGeneration = 1;
 };
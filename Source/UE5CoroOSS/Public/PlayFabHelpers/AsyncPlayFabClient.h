@@ -3,17 +3,86 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Containers/Union.h"
 #include "UE5Coro.h"
 #include "Core/PlayFabClientAPI.h"
+#include "Core/PlayFabClientInstanceAPI.h"
+#include "PlayFabHelpers/AsyncPlayFabAuthentication.h"
+#include "PlayFabHelpers/AsyncPlayFabEconomy.h"
+#include "PlayFabHelpers/AsyncPlayFabProfiles.h"
+#include "PlayFabHelpers/PlayFabCall.h"
+#include "PlayFabHelpers/PlayFabTitleNewsCache.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "AsyncPlayFabClient.generated.h"
 
-typedef TUnion<PlayFab::ClientModels::FLoginResult, PlayFab::FPlayFabCppError> FLoginUnion;
-typedef TUnion<PlayFab::ClientModels::FGetUserDataResult, PlayFab::FPlayFabCppError> FGetUserDataUnion;
-typedef TUnion<PlayFab::ClientModels::FGetTitleDataResult, PlayFab::FPlayFabCppError> FTitleDataUnion;
-typedef TUnion<PlayFab::ClientModels::FGetTitleNewsResult, PlayFab::FPlayFabCppError> FTitleNewsUnion;
-typedef TUnion<PlayFab::ClientModels::FUpdateUserDataResult, PlayFab::FPlayFabCppError> FUpdateUserDataUnion;
+typedef TPlayFabOutcome<PlayFab::ClientModels::FLoginResult> FLoginOutcome;
+typedef TPlayFabOutcome<PlayFab::ClientModels::FGetUserDataResult> FGetUserDataOutcome;
+typedef TPlayFabOutcome<PlayFab::ClientModels::FGetTitleDataResult> FTitleDataOutcome;
+typedef TPlayFabOutcome<PlayFab::ClientModels::FGetTitleNewsResult> FTitleNewsOutcome;
+typedef TPlayFabOutcome<PlayFab::ClientModels::FUpdateUserDataResult> FUpdateUserDataOutcome;
+
+using FLoginUnion UE_DEPRECATED(5.4, "Use FLoginOutcome instead.") = FLoginOutcome;
+using FGetUserDataUnion UE_DEPRECATED(5.4, "Use FGetUserDataOutcome instead.") = FGetUserDataOutcome;
+using FTitleDataUnion UE_DEPRECATED(5.4, "Use FTitleDataOutcome instead.") = FTitleDataOutcome;
+using FTitleNewsUnion UE_DEPRECATED(5.4, "Use FTitleNewsOutcome instead.") = FTitleNewsOutcome;
+using FUpdateUserDataUnion UE_DEPRECATED(5.4, "Use FUpdateUserDataOutcome instead.") = FUpdateUserDataOutcome;
+
+DECLARE_MULTICAST_DELEGATE(FOnTitleNewsChanged);
+
+/** Data a login pipeline fetches for the first screen after login. */
+enum class EPlayFabLoginData : uint8
+{
+	None = 0,
+
+	/** Returned with the login, in InfoResultPayload. */
+	UserData = 1 << 0,
+
+	/** Returned with the login, in InfoResultPayload. */
+	TitleData = 1 << 1,
+
+	/** Returned with the login, in InfoResultPayload. */
+	Profile = 1 << 2,
+
+	/** Fetched in parallel once logged in. */
+	Inventory = 1 << 3,
+
+	/** Fetched in parallel once logged in. */
+	TitlePlayers = 1 << 4,
+
+	All = UserData | TitleData | Profile | Inventory | TitlePlayers
+};
+ENUM_CLASS_FLAGS(EPlayFabLoginData);
+
+struct FPlayFabLoginOptions
+{
+	/** What to fetch. */
+	EPlayFabLoginData Fetch = EPlayFabLoginData::All;
+
+	/** What must be ready before the pipeline completes. Whatever else is fetched can be awaited afterwards. */
+	EPlayFabLoginData Required = EPlayFabLoginData::UserData | EPlayFabLoginData::TitleData | EPlayFabLoginData::Profile;
+
+	/** User data keys to return with the login. All keys if empty. */
+	TArray<FString> UserDataKeys;
+
+	/** Title data keys to return with the login. All keys if empty. */
+	TArray<FString> TitleDataKeys;
+
+	/** Inventory collection to fetch. The default collection if empty. */
+	FString InventoryCollectionId;
+};
+
+struct FPlayFabLoginData
+{
+	/** The login result. User data, title data and the profile are in its InfoResultPayload. */
+	PlayFab::ClientModels::FLoginResult Login;
+
+	/** Set if the inventory is fetched. Completed before the pipeline if required. */
+	TOptional<TCoroutine<TOptional<FInventoryItemsOutcome>>> Inventory;
+
+	/** Set if the title players are fetched. Completed before the pipeline if required. */
+	TOptional<TCoroutine<TOptional<FTitlePlayersOutcome>>> TitlePlayers;
+};
+
+typedef TPlayFabOutcome<FPlayFabLoginData> FLoginPipelineOutcome;
 
 UCLASS()
 class UE5COROOSS_API UAsyncPlayFabClient final : public UGameInstanceSubsystem
@@ -26,22 +95,100 @@ public:
 	
 	//~USubsystem Interface Begin
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
 	//~USubsystem Interface End
 
-	static UAsyncPlayFabClient* Get(const UObject* WorldContext = GEngine->GameViewport);
+	static UAsyncPlayFabClient* Get(const UObject* WorldContext = nullptr);
+
+	/**
+	 * @brief	Call any endpoint of the PlayFab Client API.
+	 *
+	 * @param Method	The endpoint, for example &PlayFab::UPlayFabClientAPI::LoginWithOpenIdConnect.
+	 * @param Request	The request to send.
+	 * @param Priority	Priority class of the request. The scoped priority, or interactive, if not given.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	template <typename TRequest, typename TResponse>
+	TCoroutine<TOptional<TPlayFabOutcome<TResponse>>> Call(const TPlayFabMethod<PlayFab::UPlayFabClientAPI, TRequest, TResponse> Method,
+		std::remove_const_t<TRequest> Request, const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority())
+	{
+		return UE5CoroOSS::CallPlayFab(ClientAPI, Method, MoveTemp(Request), Priority);
+	}
+
+	/**
+	 * @brief	Call any endpoint of the PlayFab Client API as one local player.
+	 *
+	 *	Each player gets their own client instance, so their session tickets are kept apart and their calls run in
+	 *	parallel with those of other players and with calls made through Call.
+	 *
+	 * @param PlatformUserId	The local player the call is made for.
+	 * @param Method			The endpoint, for example &PlayFab::UPlayFabClientInstanceAPI::LoginWithSteam.
+	 * @param Request			The request to send.
+	 * @param Priority			Priority class of the request. The scoped priority, or interactive, if not given.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	template <typename TRequest, typename TResponse>
+	TCoroutine<TOptional<TPlayFabOutcome<TResponse>>> CallAs(const FPlatformUserId PlatformUserId,
+		const TPlayFabMethod<PlayFab::UPlayFabClientInstanceAPI, TRequest, TResponse> Method, std::remove_const_t<TRequest> Request,
+		const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority())
+	{
+		return UE5CoroOSS::CallPlayFab(GetClientAPI(PlatformUserId), Method, MoveTemp(Request), Priority);
+	}
+
+	/**
+	 * @brief	Get the client instance of a local player, creating it on first use.
+	 *
+	 *	The instance keeps the session ticket and entity token of the player's last login. Pass its authentication
+	 *	context with entity API requests to make them as that player.
+	 */
+	TSharedPtr<PlayFab::UPlayFabClientInstanceAPI> GetClientAPI(const FPlatformUserId PlatformUserId);
+
+	/**
+	 * @brief	Get the authentication context of a local player, to make calls through any wrapper as them.
+	 *
+	 *	Set it as Request.AuthenticationContext. The wrappers then send the player's session ticket or entity token,
+	 *	and wait for the token manager to refresh that player's entity token.
+	 *
+	 * @param PlatformUserId	The local player. PLATFORMUSERID_NONE for the player of the global session.
+	 *
+	 * @return	The context of the player's client instance, or null for the player of the global session.
+	 */
+	TSharedPtr<UPlayFabAuthenticationContext> GetAuthenticationContext(const FPlatformUserId PlatformUserId);
+
+	/**
+	 * @brief	Drop the client instance of a local player, for example once they sign out.
+	 *
+	 *	Calls already in flight complete. The next call for the player starts from a new, logged out instance. Their
+	 *	entity token is no longer refreshed.
+	 */
+	void ReleaseClientAPI(const FPlatformUserId PlatformUserId);
+
+	/**
+	 * @brief	Get the PlayFab id of a player logged in through this subsystem.
+	 *
+	 * @param PlatformUserId	The local player. PLATFORMUSERID_NONE for the player of the global session.
+	 *
+	 * @return	The PlayFab id of the player's last login, or empty if there was none.
+	 */
+	FString GetPlayFabId(const FPlatformUserId PlatformUserId = PLATFORMUSERID_NONE) const;
 
 	/**
 	 * @brief	Logs in a user with an Open ID Connect JWT created by an existing relationship between a title and
 	 *			an Open ID Connect provider.
 	 *
-	 * @param Request				PlayFab::ClientModels::FLoginWithOpenIdConnectRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @param Request			PlayFab::ClientModels::FLoginWithOpenIdConnectRequest
+	 * @param PlatformUserId	The local player to log in, through their client instance. The global session if none.
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FLoginUnion>> LoginWithOpenIdConnect(PlayFab::ClientModels::FLoginWithOpenIdConnectRequest Request,
-		const TLatentContext<> ForceLatentCoroutine = {GWorld, GWorld});
+	TCoroutine<TOptional<FLoginOutcome>> LoginWithOpenIdConnect(PlayFab::ClientModels::FLoginWithOpenIdConnectRequest Request,
+		const FPlatformUserId PlatformUserId = PLATFORMUSERID_NONE);
 
 	/**
 	 * @brief	Signs the user in using a Steam authentication ticket, returning a session identifier that can
@@ -60,14 +207,14 @@ public:
 	 *	account, an error indicating this will be returned, so that the title can guide the user through creation of
 	 *	a PlayFab account.
 	 *
-	 * @param Request				PlayFab::ClientModels::FLoginWithSteamRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @param Request			PlayFab::ClientModels::FLoginWithSteamRequest
+	 * @param PlatformUserId	The local player to log in, through their client instance. The global session if none.
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FLoginUnion>> LoginWithSteam(PlayFab::ClientModels::FLoginWithSteamRequest Request,
-		const FForceLatentCoroutine ForceLatentCoroutine = {});
+	TCoroutine<TOptional<FLoginOutcome>> LoginWithSteam(PlayFab::ClientModels::FLoginWithSteamRequest Request,
+		const FPlatformUserId PlatformUserId = PLATFORMUSERID_NONE);
 
 	/**
 	 * @brief	Signs the user in using a PlayStation :tm: Network authentication code, returning a session identifier
@@ -79,14 +226,14 @@ public:
 	 *	linked to the PlayStation :tm: Network account, an error indicating this will be returned, so that the title
 	 *	can guide the user through creation of a PlayFab account.
 	 *
-	 * @param Request				PlayFab::ClientModels::FLoginWithPSNRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @param Request			PlayFab::ClientModels::FLoginWithPSNRequest
+	 * @param PlatformUserId	The local player to log in, through their client instance. The global session if none.
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FLoginUnion>> LoginWithPSN(PlayFab::ClientModels::FLoginWithPSNRequest Request,
-		const FForceLatentCoroutine ForceLatentCoroutine = {});
+	TCoroutine<TOptional<FLoginOutcome>> LoginWithPSN(PlayFab::ClientModels::FLoginWithPSNRequest Request,
+		const FPlatformUserId PlatformUserId = PLATFORMUSERID_NONE);
 
 	/**
 	 * @brief	Retrieves the title-specific custom data for the user which is readable and writable by the client.
@@ -97,14 +244,16 @@ public:
 	 *	returned will only contain the data specific to the indicated Keys. Otherwise, the full set of custom user
 	 *	data will be returned.
 	 *
-	 * @param Request				PlayFab::ClientModels::FGetUserDataRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @note	While oss.playfab.offgamethreadparse is set, large responses are deserialized on a worker thread.
+	 * @note	Values written compressed by UpdateUserData are decompressed on a worker thread.
+	 * @note	Set Request.AuthenticationContext to GetAuthenticationContext to make the call as a local player.
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @param Request	PlayFab::ClientModels::FGetUserDataRequest
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FGetUserDataUnion>> GetUserData(PlayFab::ClientModels::FGetUserDataRequest Request,
-		const FForceLatentCoroutine ForceLatentCoroutine = {});
+	TCoroutine<TOptional<FGetUserDataOutcome>> GetUserData(PlayFab::ClientModels::FGetUserDataRequest Request);
 
 	/**
 	 * @brief	Retrieves the key-value store of custom title settings
@@ -116,26 +265,54 @@ public:
 	 *	overrides, the overrides are applied automatically and returned with the title data. Note that there may up
 	 *	to a minute delay in between updating title data and this API call returning the newest value.
 	 *
-	 * @param Request				PlayFab::ClientModels::FGetTitleDataRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @note	Always makes a round trip. Title data prefetched at startup is read from UAsyncOSSStartup::GetTitleData.
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @param Request	PlayFab::ClientModels::FGetTitleDataRequest
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FTitleDataUnion>> GetTitleData(PlayFab::ClientModels::FGetTitleDataRequest Request,
-		const FForceLatentCoroutine ForceLatentCoroutine = {});
+	TCoroutine<TOptional<FTitleDataOutcome>> GetTitleData(PlayFab::ClientModels::FGetTitleDataRequest Request);
 
 	/**
 	 * @brief	Retrieves the title news feed, as configured in the PlayFab developer portal.
 	 * 
-	 * @param Request				PlayFab::ClientModels::FGetTitleNewsRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @param Request	PlayFab::ClientModels::FGetTitleNewsRequest
 	 * 
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FTitleNewsUnion>> GetTitleNews(PlayFab::ClientModels::FGetTitleNewsRequest Request,
-		const FForceLatentCoroutine ForceLatentCoroutine = {});
+	TCoroutine<TOptional<FTitleNewsOutcome>> GetTitleNews(PlayFab::ClientModels::FGetTitleNewsRequest Request);
+
+	/**
+	 * @brief	Get the title news feed cached on disk, newest first.
+	 *
+	 *	Returns immediately, so the feed can be shown as soon as a menu opens. If the feed was last checked more than
+	 *	oss.playfab.titlenewsrefreshinterval seconds ago, a refresh is started in the background and
+	 *	OnTitleNewsChanged is broadcast if it finds anything new. After a failed refresh, the next one waits
+	 *	oss.playfab.titlenewsretrydelay seconds, doubling with every further failure.
+	 *
+	 *	The feed is cached per title id, and the cache of the current title is loaded whenever it changes.
+	 *
+	 * @return	The cached items. Empty until the first refresh completes on a fresh install.
+	 */
+	const TArray<PlayFab::ClientModels::FTitleNewsItem>& GetCachedTitleNews();
+
+	/**
+	 * @brief	Check the title news feed for new or changed items and merge them into the cache.
+	 *
+	 *	Only the newest oss.playfab.titlenewsprobecount items are requested. The feed is fetched up to
+	 *	oss.playfab.titlenewsmaxitems only if every probed item is new, since older ones may have been missed.
+	 *	Concurrent callers share one refresh.
+	 *
+	 * @note	Items removed from the feed are only dropped from the cache once a response covers the whole feed.
+	 *
+	 * @return	When awaited, returns true if the feed was checked.
+	 */
+	TCoroutine<bool> RefreshTitleNews();
+
+	/** Broadcast when a refresh adds, changes or removes cached title news items. */
+	FOnTitleNewsChanged OnTitleNewsChanged;
 
 	/**
 	 * @brief	Creates and updates the title-specific custom data for the user which is readable and writable by
@@ -146,16 +323,116 @@ public:
 	 *	while keys with null values will be removed. New keys will be added, with the given values. No other key-value
 	 *	pairs will be changed apart from those specified in the call.
 	 *
-	 * @param Request				PlayFab::ClientModels::FUpdateUserDataRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @note	Values of keys marked with SetUserDataCompressed are compressed on a worker thread before sending.
+	 * @note	Set Request.AuthenticationContext to GetAuthenticationContext to make the call as a local player.
+	 *
+	 * @param Request	PlayFab::ClientModels::FUpdateUserDataRequest
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FUpdateUserDataUnion>> UpdateUserData(PlayFab::ClientModels::FUpdateUserDataRequest Request,
-		const FForceLatentCoroutine ForceLatentCoroutine = {});
+	TCoroutine<TOptional<FUpdateUserDataOutcome>> UpdateUserData(PlayFab::ClientModels::FUpdateUserDataRequest Request);
+
+	/**
+	 * @brief	Opt a user data key in or out of compression.
+	 *
+	 *	Values of a compressed key are compressed with oss.playfab.userdatacodec and base64 encoded when written, unless
+	 *	that would not make them smaller. Compressed values are decoded on read whether or not their key is still
+	 *	marked, and values stored before a key was marked are read as they are.
+	 *
+	 * @param Key			The user data key.
+	 * @param bCompressed	Whether values written to the key are compressed.
+	 */
+	void SetUserDataCompressed(const FString& Key, const bool bCompressed);
+
+	/**
+	 * @brief	Log in with Steam and fetch everything the first screen needs in about two round trips.
+	 *
+	 *	User data, title data and the profile are requested through the login's InfoRequestParameters, so they arrive
+	 *	with the login response. The entity token comes with it too. The inventory and title players are then fetched
+	 *	in parallel, and the pipeline completes once everything in Options.Required is ready. If the inventory is
+	 *	required but the login returned no entity, the pipeline fails.
+	 *
+	 * @param Request			PlayFab::ClientModels::FLoginWithSteamRequest. InfoRequestParameters is overwritten.
+	 * @param Options			What to fetch, and what to wait for.
+	 * @param PlatformUserId	The local player to log in and fetch for. The global session if none.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the login data or the login error. If unset, the
+	 *			login failed to start.
+	 */
+	TCoroutine<TOptional<FLoginPipelineOutcome>> LoginPipeline(PlayFab::ClientModels::FLoginWithSteamRequest Request,
+		FPlayFabLoginOptions Options = {}, const FPlatformUserId PlatformUserId = PLATFORMUSERID_NONE);
+
+	/**
+	 * @brief	Log in with PSN and fetch everything the first screen needs in about two round trips.
+	 *
+	 * @param Request			PlayFab::ClientModels::FLoginWithPSNRequest. InfoRequestParameters is overwritten.
+	 * @param Options			What to fetch, and what to wait for.
+	 * @param PlatformUserId	The local player to log in and fetch for. The global session if none.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the login data or the login error. If unset, the
+	 *			login failed to start.
+	 */
+	TCoroutine<TOptional<FLoginPipelineOutcome>> LoginPipeline(PlayFab::ClientModels::FLoginWithPSNRequest Request,
+		FPlayFabLoginOptions Options = {}, const FPlatformUserId PlatformUserId = PLATFORMUSERID_NONE);
+
+	/**
+	 * @brief	Log in with OpenID Connect and fetch everything the first screen needs in about two round trips.
+	 *
+	 * @param Request			PlayFab::ClientModels::FLoginWithOpenIdConnectRequest. InfoRequestParameters is overwritten.
+	 * @param Options			What to fetch, and what to wait for.
+	 * @param PlatformUserId	The local player to log in and fetch for. The global session if none.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the login data or the login error. If unset, the
+	 *			login failed to start.
+	 */
+	TCoroutine<TOptional<FLoginPipelineOutcome>> LoginPipeline(PlayFab::ClientModels::FLoginWithOpenIdConnectRequest Request,
+		FPlayFabLoginOptions Options = {}, const FPlatformUserId PlatformUserId = PLATFORMUSERID_NONE);
 
 private:
 
+	static TSharedPtr<PlayFab::ClientModels::FGetPlayerCombinedInfoRequestParams> MakeInfoRequestParameters(
+		const FPlayFabLoginOptions& Options);
+
+	TCoroutine<TOptional<FLoginPipelineOutcome>> RunLoginPipeline(TCoroutine<TOptional<FLoginOutcome>> Login,
+		FPlayFabLoginOptions Options, const FPlatformUserId PlatformUserId, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/** Load the title news cache of the current title id, if it is not loaded already. */
+	void LoadTitleNewsCache();
+
+	TCoroutine<bool> SendTitleNewsRefresh(const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/** Remember who logged in, and hand the entity token a login returns to the token manager. */
+	TCoroutine<TOptional<FLoginOutcome>> TrackLogin(TCoroutine<TOptional<FLoginOutcome>> Login, const FPlatformUserId PlatformUserId,
+		const FForceLatentCoroutine ForceLatentCoroutine = {});
+
 	TSharedPtr<PlayFab::UPlayFabClientAPI> ClientAPI;
+
+	TMap<FPlatformUserId, TSharedPtr<PlayFab::UPlayFabClientInstanceAPI>> ClientInstanceAPIs;
+
+	TSet<FString> CompressedUserDataKeys;
+
+	/** The PlayFab id of every player's last login. PLATFORMUSERID_NONE is the player of the global session. */
+	TMap<FPlatformUserId, FString> PlayFabIds;
+
+	FPlayFabTitleNewsCache TitleNewsCache;
+
+	TOptional<TCoroutine<bool>> TitleNewsRefresh;
+
+	/** The title whose feed TitleNewsCache holds. Unset until it is first loaded. */
+	TOptional<FString> TitleNewsTitleId;
+
+	/** FPlatformTime::Seconds before which reading the cache does not start another refresh, after a failed one. */
+	double TitleNewsRetryTime = 0.0;
+
+	int32 FailedTitleNewsRefreshes = 0;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncPlayFabAuthentication> Authentication;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncPlayFabEconomy> Economy;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncPlayFabProfiles> Profiles;
 };
@@ -3,14 +3,21 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Containers/Union.h"
 #include "UE5Coro.h"
 #include "Core/PlayFabCloudScriptAPI.h"
+#include "Dom/JsonValue.h"
+#include "PlayFabHelpers/AsyncPlayFabAuthentication.h"
+#include "PlayFabHelpers/PlayFabCall.h"
+#include "UObject/StructOnScope.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "AsyncPlayFabCloudScript.generated.h"
 
-typedef TUnion<PlayFab::CloudScriptModels::FExecuteCloudScriptResult, PlayFab::FPlayFabCppError> FExecuteCloudScriptUnion;
-typedef TUnion<PlayFab::CloudScriptModels::FExecuteFunctionResult, PlayFab::FPlayFabCppError> FExecuteFunctionUnion;
+typedef TPlayFabOutcome<PlayFab::CloudScriptModels::FExecuteCloudScriptResult> FExecuteCloudScriptOutcome;
+typedef TPlayFabOutcome<PlayFab::CloudScriptModels::FExecuteFunctionResult> FExecuteFunctionOutcome;
+typedef TPlayFabOutcome<TSharedPtr<FJsonValue>> FFunctionResultOutcome;
+
+using FExecuteCloudScriptUnion UE_DEPRECATED(5.4, "Use FExecuteCloudScriptOutcome instead.") = FExecuteCloudScriptOutcome;
+using FExecuteFunctionUnion UE_DEPRECATED(5.4, "Use FExecuteFunctionOutcome instead.") = FExecuteFunctionOutcome;
 
 UCLASS()
 class UE5COROOSS_API UAsyncPlayFabCloudScript final : public UGameInstanceSubsystem
@@ -20,12 +27,40 @@ class UE5COROOSS_API UAsyncPlayFabCloudScript final : public UGameInstanceSubsys
 public:
 
 	UAsyncPlayFabCloudScript();
-	
+
 	//~USubsystem Interface Begin
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
 	//~USubsystem Interface End
 
-	static UAsyncPlayFabCloudScript* Get(const UObject* WorldContext = GEngine->GameViewport);
+	static UAsyncPlayFabCloudScript* Get(const UObject* WorldContext = nullptr);
+
+	/**
+	 * @brief	Call any endpoint of the PlayFab CloudScript API.
+	 *
+	 * @note	Waits for the entity token manager first, so the call is not sent with an expired token. Set
+	 *			Request.AuthenticationContext to make the call as another player than the one of the global session.
+	 *
+	 * @param Method	The endpoint, for example &PlayFab::UPlayFabCloudScriptAPI::ExecuteCloudScript.
+	 * @param Request	The request to send.
+	 * @param Priority	Priority class of the request. The scoped priority, or interactive, if not given.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	template <typename TRequest, typename TResponse>
+	TCoroutine<TOptional<TPlayFabOutcome<TResponse>>> Call(const TPlayFabMethod<PlayFab::UPlayFabCloudScriptAPI, TRequest, TResponse> Method,
+		std::remove_const_t<TRequest> Request, const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority())
+	{
+		const TSharedPtr<PlayFab::UPlayFabCloudScriptAPI> Api = CloudScriptAPI;
+
+		if (!co_await Authentication->WaitForEntityToken(Request.AuthenticationContext))
+		{
+			co_return { TPlayFabOutcome<TResponse>(MakeError(UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError())) };
+		}
+
+		co_return co_await UE5CoroOSS::CallPlayFab(Api, Method, MoveTemp(Request), Priority);
+	}
 
 	/**
 	 * @brief	Executes CloudScript with the entity profile that is defined in the request.
@@ -34,14 +69,12 @@ public:
 	 *	kind of custom server-side functionality you can implement, and it can be used in conjunction with virtually
 	 *	anything.
 	 *
-	 * @param Request				PlayFab::CloudScriptModels::FExecuteEntityCloudScriptRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @param Request	PlayFab::CloudScriptModels::FExecuteEntityCloudScriptRequest
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FExecuteCloudScriptUnion>> ExecuteCloudScript(PlayFab::CloudScriptModels::FExecuteEntityCloudScriptRequest Request,
-		const FForceLatentCoroutine ForceLatentCoroutine = {});
+	TCoroutine<TOptional<FExecuteCloudScriptOutcome>> ExecuteCloudScript(PlayFab::CloudScriptModels::FExecuteEntityCloudScriptRequest Request);
 
 	/**
 	 * @brief	Executes an Azure Function with the profile of the entity that is defined in the request.
@@ -50,16 +83,196 @@ public:
 	 *	kind of custom server-side functionality you can implement, and it can be used in conjunction with virtually
 	 *	anything.
 	 *
-	 * @param Request				PlayFab::CloudScriptModels::FExecuteFunctionRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @note	While oss.playfab.offgamethreadparse is set, large responses are deserialized on a worker thread.
+	 *
+	 * @param Request					PlayFab::CloudScriptModels::FExecuteFunctionRequest
+	 * @param ForceLatentCoroutine		Do not set. Forces latent coroutine.
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FExecuteFunctionUnion>> ExecuteFunction(PlayFab::CloudScriptModels::FExecuteFunctionRequest Request,
+	TCoroutine<TOptional<FExecuteFunctionOutcome>> ExecuteFunction(PlayFab::CloudScriptModels::FExecuteFunctionRequest Request,
 		const FForceLatentCoroutine ForceLatentCoroutine = {});
 
+	/**
+	 * @brief	Executes an Azure Function, passing a USTRUCT as its parameter and reading its result into a USTRUCT.
+	 *
+	 *	The parameter is written and the result read by streaming JSON directly to and from the structs' reflected
+	 *	properties, without building an FJsonObject for either. Result fields missing from the JSON keep their default
+	 *	value. A function that throws, or whose result is too large to return, completes with an error.
+	 *
+	 * @param FunctionName				The name of the function to execute.
+	 * @param Parameter					The struct passed to the function as its parameter.
+	 * @param AuthenticationContext		The player to execute the function as. The player of the global session if null.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result struct or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	template <typename TResultStruct, typename TParameterStruct>
+	TCoroutine<TOptional<TPlayFabOutcome<TResultStruct>>> ExecuteFunction(FString FunctionName, TParameterStruct Parameter,
+		TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext = nullptr)
+	{
+		TOptional<TPlayFabOutcome<TSharedRef<FStructOnScope>>> Result = co_await ExecuteFunction(MoveTemp(FunctionName),
+			StaticStruct<TParameterStruct>(), &Parameter, StaticStruct<TResultStruct>(), MoveTemp(AuthenticationContext));
+
+		if (!Result.IsSet())
+		{
+			co_return {};
+		}
+
+		if (Result->HasError())
+		{
+			co_return { TPlayFabOutcome<TResultStruct>(MakeError(Result->StealError())) };
+		}
+
+		TResultStruct& ResultStruct = *reinterpret_cast<TResultStruct*>(Result->GetValue()->GetStructMemory());
+
+		co_return { TPlayFabOutcome<TResultStruct>(MakeValue(MoveTemp(ResultStruct))) };
+	}
+
+	/**
+	 * @brief	Executes an Azure Function with struct types known only at runtime.
+	 *
+	 * @param FunctionName				The name of the function to execute.
+	 * @param ParameterStruct			Type of the parameter struct.
+	 * @param Parameter					The parameter struct. Only read before the coroutine first suspends.
+	 * @param ResultStruct				Type of the result struct.
+	 * @param AuthenticationContext		The player to execute the function as. The player of the global session if null.
+	 * @param ForceLatentCoroutine		Do not set. Forces latent coroutine.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result struct or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	TCoroutine<TOptional<TPlayFabOutcome<TSharedRef<FStructOnScope>>>> ExecuteFunction(FString FunctionName,
+		const UScriptStruct* ParameterStruct, const void* Parameter, const UScriptStruct* ResultStruct,
+		TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext = nullptr, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/**
+	 * @brief	Queue a call to an Azure Function, to be sent together with other calls queued shortly after it.
+	 *
+	 *	Calls queued within oss.playfab.multiplexwindow seconds of each other are sent as a single ExecuteFunction to the
+	 *	dispatcher function named by oss.playfab.multiplexfunction, at most oss.playfab.multiplexmaxcalls at a time. A
+	 *	call that ends up alone in its window, or any call while no dispatcher is set, executes its function directly.
+	 *
+	 *	The dispatcher receives { "Calls": [ { "FunctionName", "FunctionParameter" } ] } and must return
+	 *	{ "Results": [ { "Result" } or { "Error": { "Error", "Message" } } ] } in the same order, so each call keeps its
+	 *	own error. Each entry may also hold "DurationMs", the time the call took, which registered functions are timed by.
+	 *	Without it, every call in the batch is timed by the round trip of the whole batch.
+	 *
+	 *	Calls made as different players are sent in separate dispatcher calls.
+	 *
+	 * @param FunctionName				The name of the function to execute.
+	 * @param Parameter					The function parameter.
+	 * @param AuthenticationContext		The player to execute the function as. The player of the global session if null.
+	 * @param ForceLatentCoroutine		Do not set. Forces latent coroutine.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the function result or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	TCoroutine<TOptional<FFunctionResultOutcome>> QueueFunction(FString FunctionName, TSharedPtr<FJsonValue> Parameter,
+		TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext = nullptr, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/**
+	 * @brief	Register a latency-critical function to be kept warm.
+	 *
+	 *	While the function has not been called for KeepWarmInterval seconds, give or take oss.playfab.warmjitter of it, a
+	 *	warm-up invocation is sent so Azure keeps an instance running. Real calls to the function are timed, and counted
+	 *	as cold if they take longer than oss.playfab.coldstartthreshold seconds. Registering a function again replaces its
+	 *	policy.
+	 *
+	 * @note	The function should return right away when called with WarmUpParameter.
+	 *
+	 * @param FunctionName		The name of the function.
+	 * @param KeepWarmInterval	Seconds of idle time before a warm-up is sent. Zero only warms up on WarmUpFunctions.
+	 * @param WarmUpParameter	Parameter of warm-up invocations. Defaults to { "WarmUp": true }.
+	 */
+	void RegisterWarmFunction(FString FunctionName, const float KeepWarmInterval, TSharedPtr<FJsonValue> WarmUpParameter = nullptr);
+
+	void UnregisterWarmFunction(const FString& FunctionName);
+
+	/**
+	 * @brief	Send a warm-up invocation to every registered function now, ahead of predicted use such as a match start.
+	 */
+	void WarmUpFunctions();
+
+	/** How often calls to a registered function found its Azure Function instance warm. */
+	struct FFunctionWarmth
+	{
+		int32 WarmCalls = 0;
+
+		int32 ColdCalls = 0;
+
+		int32 WarmUpCalls = 0;
+
+		/** Latency of the last real call, in seconds. The DurationMs reported by the dispatcher for multiplexed calls, if any. */
+		double LastLatency = 0.0;
+	};
+
+	/**
+	 * @brief	Get the warm and cold call counts of a registered function.
+	 *
+	 * @return	The counts, or null if the function is not registered.
+	 */
+	const FFunctionWarmth* GetFunctionWarmth(const FString& FunctionName) const;
+
 private:
 
+	struct FWarmFunction
+	{
+		TSharedPtr<FJsonValue> WarmUpParameter;
+
+		float KeepWarmInterval = 0.0f;
+
+		/** Platform time the function was last invoked, by a real call or a warm-up. */
+		double LastInvokeTime = 0.0;
+
+		/** Bumped on every registration, so a replaced keep-warm loop knows to stop. */
+		uint32 Generation = 0;
+
+		FFunctionWarmth Warmth;
+	};
+
+	TCoroutine<> KeepFunctionWarm(FString FunctionName, const uint32 Generation, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	TCoroutine<> WarmUpFunction(FString FunctionName);
+
+	/** Count a real call to a function against its warmth, if it is registered. */
+	void RecordFunctionCall(const FString& FunctionName, const double Latency);
+
+	struct FQueuedFunctionCall
+	{
+		FString FunctionName;
+
+		TSharedPtr<FJsonValue> Parameter;
+
+		TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext;
+
+		EPlayFabPriority Priority = EPlayFabPriority::Interactive;
+
+		TOptional<FFunctionResultOutcome> Result;
+
+		bool bDone = false;
+	};
+
+	TCoroutine<> FlushFunctionQueue(const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/** Send every queued call, one dispatcher call per player. */
+	void DispatchQueuedFunctionCalls();
+
+	TCoroutine<> DispatchFunctionCalls(TArray<TSharedRef<FQueuedFunctionCall>> Batch,
+		const FForceLatentCoroutine ForceLatentCoroutine = {});
+
 	TSharedPtr<PlayFab::UPlayFabCloudScriptAPI> CloudScriptAPI;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncPlayFabAuthentication> Authentication;
+
+	TArray<TSharedRef<FQueuedFunctionCall>> QueuedFunctionCalls;
+
+	/** Sends the queued calls once the multiplex window closes. Unset while nothing is queued. */
+	TOptional<TCoroutine<>> FunctionFlush;
+
+	TMap<FString, FWarmFunction> WarmFunctions;
+
+	uint32 WarmFunctionGeneration = 0;
 };
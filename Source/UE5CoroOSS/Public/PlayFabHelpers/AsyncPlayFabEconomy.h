@@ -3,15 +3,27 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Containers/Union.h"
 #include "UE5Coro.h"
 #include "Core/PlayFabEconomyAPI.h"
+#include "PlayFabHelpers/AsyncPlayFabAuthentication.h"
+#include "PlayFabHelpers/PlayFabCatalogCache.h"
+#include "PlayFabHelpers/PlayFabCatalogIndex.h"
+#include "PlayFabHelpers/PlayFabInventoryMirror.h"
+#include "PlayFabHelpers/PlayFabCall.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "AsyncPlayFabEconomy.generated.h"
 
-typedef TUnion<PlayFab::EconomyModels::FGetItemsResponse, PlayFab::FPlayFabCppError> FItemsUnion;
-typedef TUnion<PlayFab::EconomyModels::FGetInventoryItemsResponse, PlayFab::FPlayFabCppError> FInventoryItemsUnion;
-typedef TUnion<PlayFab::EconomyModels::FPurchaseInventoryItemsResponse, PlayFab::FPlayFabCppError> FPurchaseInventoryItemsUnion;
+typedef TPlayFabOutcome<PlayFab::EconomyModels::FGetItemsResponse> FItemsOutcome;
+typedef TPlayFabOutcome<PlayFab::EconomyModels::FGetInventoryItemsResponse> FInventoryItemsOutcome;
+typedef TPlayFabOutcome<PlayFab::EconomyModels::FPurchaseInventoryItemsResponse> FPurchaseInventoryItemsOutcome;
+typedef TPlayFabOutcome<PlayFab::EconomyModels::FExecuteInventoryOperationsResponse> FExecuteInventoryOperationsOutcome;
+
+using FItemsUnion UE_DEPRECATED(5.4, "Use FItemsOutcome instead.") = FItemsOutcome;
+using FInventoryItemsUnion UE_DEPRECATED(5.4, "Use FInventoryItemsOutcome instead.") = FInventoryItemsOutcome;
+using FPurchaseInventoryItemsUnion UE_DEPRECATED(5.4, "Use FPurchaseInventoryItemsOutcome instead.") = FPurchaseInventoryItemsOutcome;
+using FExecuteInventoryOperationsUnion UE_DEPRECATED(5.4, "Use FExecuteInventoryOperationsOutcome instead.") = FExecuteInventoryOperationsOutcome;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCatalogItemsChanged, const TArray<FString>& /*ItemIds*/);
 
 UCLASS()
 class UE5COROOSS_API UAsyncPlayFabEconomy final : public UGameInstanceSubsystem
@@ -24,9 +36,38 @@ public:
 
 	//~USubsystem Interface Begin
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
 	//~USubsystem Interface End
 
-	static UAsyncPlayFabEconomy* Get(const UObject* WorldContext = GEngine->GameViewport);
+	static UAsyncPlayFabEconomy* Get(const UObject* WorldContext = nullptr);
+
+	/**
+	 * @brief	Call any endpoint of the PlayFab Economy API.
+	 *
+	 * @note	Waits for the entity token manager first, so the call is not sent with an expired token. Set
+	 *			Request.AuthenticationContext to make the call as another player than the one of the global session.
+	 *
+	 * @param Method	The endpoint, for example &PlayFab::UPlayFabEconomyAPI::GetInventoryItems.
+	 * @param Request	The request to send.
+	 * @param Priority	Priority class of the request. The scoped priority, or interactive, if not given.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	template <typename TRequest, typename TResponse>
+	TCoroutine<TOptional<TPlayFabOutcome<TResponse>>> Call(const TPlayFabMethod<PlayFab::UPlayFabEconomyAPI, TRequest, TResponse> Method,
+		std::remove_const_t<TRequest> Request, const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority())
+	{
+		const TSharedPtr<PlayFab::UPlayFabEconomyAPI> Api = EconomyAPI;
+
+		if (!co_await Authentication->WaitForEntityToken(Request.AuthenticationContext))
+		{
+			co_return { TPlayFabOutcome<TResponse>(MakeError(UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError())) };
+		}
+
+		co_return co_await UE5CoroOSS::CallPlayFab(Api, Method, MoveTemp(Request), Priority);
+	}
 	
 	/**
 	 * @brief	Retrieves items from the public catalog.
@@ -35,27 +76,79 @@ public:
 	 *	used when trying to get recent item updates. However, please note that item references data is cached and
 	 *	may take a few moments for changes to propagate.
 	 *
+	 * @note	While oss.playfab.offgamethreadparse is set, large responses are deserialized on a worker thread.
+	 *
 	 * @param Request				PlayFab::EconomyModels::FGetItemsRequest
 	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FItemsUnion>> GetItems(PlayFab::EconomyModels::FGetItemsRequest Request,
+	TCoroutine<TOptional<FItemsOutcome>> GetItems(PlayFab::EconomyModels::FGetItemsRequest Request,
 		const FForceLatentCoroutine ForceLatentCoroutine = {});
 
+	/**
+	 * @brief	Retrieves items from the public catalog, serving them from the on-disk catalog cache when possible.
+	 *
+	 *	If every requested id is cached, the cached items are returned immediately and the request is revalidated
+	 *	against PlayFab in the background. Items whose ETag changed are rewritten to the cache and reported through
+	 *	OnCatalogItemsChanged. Otherwise, this behaves like GetItems and stores the result in the cache.
+	 *
+	 * @note	Only requests by Ids are cached. Requests using AlternateIds always go to PlayFab.
+	 *
+	 * @param Request				PlayFab::EconomyModels::FGetItemsRequest
+	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	TCoroutine<TOptional<FItemsOutcome>> GetItemsCached(PlayFab::EconomyModels::FGetItemsRequest Request,
+		const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/** Broadcast when a background revalidation finds catalog items that changed since they were cached. */
+	FOnCatalogItemsChanged OnCatalogItemsChanged;
+
+	/**
+	 * @brief	Get the index of every catalog item returned by GetItems or GetItemsCached so far.
+	 *
+	 *	Use this for storefront filtering and sorting by tag, type, content type and price instead of walking the
+	 *	result arrays.
+	 *
+	 * @return	The catalog index.
+	 */
+	const FPlayFabCatalogIndex& GetCatalogIndex() const;
+
 	/**
 	 * @brief	Get current inventory items.
 	 * 
 	 *	Given an entity type, entity identifier and container details, will get the entity's inventory items.
 	 *	
-	 * @param Request				PlayFab::EconomyModels::FGetInventoryItemsRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @note	While oss.playfab.offgamethreadparse is set, large responses are deserialized on a worker thread.
+	 *
+	 * @param Request	PlayFab::EconomyModels::FGetInventoryItemsRequest
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FInventoryItemsUnion>> GetInventoryItems(PlayFab::EconomyModels::FGetInventoryItemsRequest Request,
+	TCoroutine<TOptional<FInventoryItemsOutcome>> GetInventoryItems(PlayFab::EconomyModels::FGetInventoryItemsRequest Request);
+
+	/**
+	 * @brief	Get every inventory item, one page at a time.
+	 *
+	 *	Follows the ContinuationToken of each page until the inventory is exhausted. The next page is requested before
+	 *	OnPage is invoked for the current one, so processing overlaps with the next round trip while at most two pages
+	 *	are held at once.
+	 *
+	 * @param Request				PlayFab::EconomyModels::FGetInventoryItemsRequest. Count sets the page size.
+	 * @param OnPage				Coroutine invoked with each page, awaited before the following page is delivered. Returns
+	 *								true to continue paging, false to stop and cancel the request for the next page.
+	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the last page delivered or the error that stopped
+	 *			paging. If unset, a request failed to start.
+	 */
+	TCoroutine<TOptional<FInventoryItemsOutcome>> ForEachInventoryPage(PlayFab::EconomyModels::FGetInventoryItemsRequest Request,
+		TFunction<TCoroutine<bool>(const PlayFab::EconomyModels::FGetInventoryItemsResponse& /*Page*/)> OnPage,
 		const FForceLatentCoroutine ForceLatentCoroutine = {});
 
 	/**
@@ -66,13 +159,122 @@ public:
 	 * @param Request				PlayFab::EconomyModels::FPurchaseInventoryItemsRequest
 	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
 	 *
-	 *	@return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 *	@return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	TCoroutine<TOptional<FPurchaseInventoryItemsOutcome>> PurchaseInventoryItems(
+		PlayFab::EconomyModels::FPurchaseInventoryItemsRequest Request, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/**
+	 * @brief	Queue a purchase to be sent together with other purchases for the same inventory collection.
+	 *
+	 *	Purchases queued during the same frame by the same player for the same entity and collection are sent as a single
+	 *	ExecuteInventoryOperations transaction, split by the oss.playfab.maxinventoryoperations limit, with at most
+	 *	oss.playfab.maxpurchasesinflight transactions running at once. An IdempotencyId is generated if the request
+	 *	has none, and transient failures are retried with the same id. Requests with an ETag or CustomTags are sent on
+	 *	their own.
+	 *
+	 * @note	A batched transaction succeeds or fails as a whole. Every purchase in it receives the transaction ETag and
+	 *			TransactionIds. If it fails with a non-transient error, such as one unaffordable purchase, every purchase in
+	 *			it is resent on its own, one after the other, and receives its own outcome.
+	 *
+	 * @param Request				PlayFab::EconomyModels::FPurchaseInventoryItemsRequest
+	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 *
+	 *	@return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FPurchaseInventoryItemsUnion>> PurchaseInventoryItems(
+	TCoroutine<TOptional<FPurchaseInventoryItemsOutcome>> QueuePurchaseInventoryItems(
 		PlayFab::EconomyModels::FPurchaseInventoryItemsRequest Request, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/**
+	 * @brief	Execute a list of Inventory Operations for an Entity.
+	 *
+	 *	Operations are executed as a single transaction, either all succeed or none are applied.
+	 *
+	 * @param Request	PlayFab::EconomyModels::FExecuteInventoryOperationsRequest
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	TCoroutine<TOptional<FExecuteInventoryOperationsOutcome>> ExecuteInventoryOperations(
+		PlayFab::EconomyModels::FExecuteInventoryOperationsRequest Request);
+
+	/**
+	 * @brief	Bring the local inventory mirror of an entity's collection up to date.
+	 *
+	 *	If a mirror exists and is not stale, a single item page is requested to compare the collection ETag, and the
+	 *	full inventory is only reloaded if it differs. Purchases made through PurchaseInventoryItems are applied to the
+	 *	mirror directly and do not require a reconcile.
+	 *
+	 * @param Entity				The entity owning the inventory, or null for the logged in entity.
+	 * @param CollectionId			The inventory collection, or empty for the default collection.
+	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 *
+	 * @return	When awaited, returns true if the mirror is up to date.
+	 */
+	TCoroutine<bool> ReconcileInventory(TSharedPtr<PlayFab::EconomyModels::FEntityKey> Entity, FString CollectionId = FString(),
+		const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/**
+	 * @brief	Get the local inventory mirror of an entity's collection, for synchronous reads.
+	 *
+	 * @param Entity		The entity owning the inventory, or null for the logged in entity.
+	 * @param CollectionId	The inventory collection, or empty for the default collection.
+	 *
+	 * @return	The mirror, or null if the collection was never reconciled.
+	 */
+	const FPlayFabInventoryMirror* FindInventoryMirror(const TSharedPtr<PlayFab::EconomyModels::FEntityKey>& Entity,
+		const FString& CollectionId = FString()) const;
 	
 private:
 
+	TCoroutine<> RevalidateCatalogItems(PlayFab::EconomyModels::FGetItemsRequest Request, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	TArray<FString> CacheCatalogItems(const TArray<PlayFab::EconomyModels::FCatalogItem>& Items);
+
+	/** Write the catalog cache on a worker thread once changes stop arriving for a while. */
+	TCoroutine<> SaveCatalogCache(const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	static FString MakeInventoryKey(const TSharedPtr<PlayFab::EconomyModels::FEntityKey>& Entity, const FString& CollectionId);
+
+	void ApplyPurchaseToMirror(const PlayFab::EconomyModels::FPurchaseInventoryItemsRequest& Request,
+		const PlayFab::EconomyModels::FPurchaseInventoryItemsResponse& Response);
+
+	struct FPendingPurchase
+	{
+		PlayFab::EconomyModels::FPurchaseInventoryItemsRequest Request;
+
+		TOptional<FPurchaseInventoryItemsOutcome> Result;
+
+		bool bDone = false;
+	};
+
+	TCoroutine<> FlushPurchaseQueue(const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	TCoroutine<> ExecutePurchaseBatch(TArray<TSharedRef<FPendingPurchase>> Batch, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/** Send one queued purchase on its own, retrying transient failures. */
+	TCoroutine<> ExecutePurchase(const TSharedRef<FPendingPurchase> Pending, const FForceLatentCoroutine ForceLatentCoroutine = {});
+
 	TSharedPtr<PlayFab::UPlayFabEconomyAPI> EconomyAPI;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncPlayFabAuthentication> Authentication;
+
+	FPlayFabCatalogCache CatalogCache;
+
+	TOptional<TCoroutine<>> CatalogCacheSave;
+
+	FPlayFabCatalogIndex CatalogIndex;
+
+	TSet<FString> RevalidatingItemIds;
+
+	TMap<FString, FPlayFabInventoryMirror> InventoryMirrors;
+
+	TArray<TSharedRef<FPendingPurchase>> QueuedPurchases;
+
+	int32 PurchasesInFlight = 0;
+
+	bool bPurchaseFlushScheduled = false;
 };
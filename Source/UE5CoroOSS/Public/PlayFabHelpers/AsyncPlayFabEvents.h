@@ -0,0 +1,169 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UE5Coro.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+#include "Core/PlayFabEventsAPI.h"
+#include "PlayFabHelpers/AsyncPlayFabAuthentication.h"
+#include "PlayFabHelpers/PlayFabCall.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include <atomic>
+#include "AsyncPlayFabEvents.generated.h"
+
+typedef TPlayFabOutcome<PlayFab::EventsModels::FWriteEventsResponse> FWriteEventsOutcome;
+
+UCLASS()
+class UE5COROOSS_API UAsyncPlayFabEvents final : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UAsyncPlayFabEvents();
+
+	//~USubsystem Interface Begin
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+	//~USubsystem Interface End
+
+	static UAsyncPlayFabEvents* Get(const UObject* WorldContext = nullptr);
+
+	/**
+	 * @brief	Call any endpoint of the PlayFab Events API.
+	 *
+	 * @note	Waits for the entity token manager first, so the call is not sent with an expired token. Set
+	 *			Request.AuthenticationContext to make the call as another player than the one of the global session.
+	 *
+	 * @param Method	The endpoint, for example &PlayFab::UPlayFabEventsAPI::WriteEvents.
+	 * @param Request	The request to send.
+	 * @param Priority	Priority class of the request. The scoped priority, or interactive, if not given.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	template <typename TRequest, typename TResponse>
+	TCoroutine<TOptional<TPlayFabOutcome<TResponse>>> Call(const TPlayFabMethod<PlayFab::UPlayFabEventsAPI, TRequest, TResponse> Method,
+		std::remove_const_t<TRequest> Request, const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority())
+	{
+		const TSharedPtr<PlayFab::UPlayFabEventsAPI> Api = EventsAPI;
+
+		if (!co_await Authentication->WaitForEntityToken(Request.AuthenticationContext))
+		{
+			co_return { TPlayFabOutcome<TResponse>(MakeError(UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError())) };
+		}
+
+		co_return co_await UE5CoroOSS::CallPlayFab(Api, Method, MoveTemp(Request), Priority);
+	}
+
+	/**
+	 * @brief	Write batches of entity based events to PlayStream.
+	 *
+	 * @param Request	PlayFab::EventsModels::FWriteEventsRequest
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	TCoroutine<TOptional<FWriteEventsOutcome>> WriteEvents(PlayFab::EventsModels::FWriteEventsRequest Request);
+
+	/**
+	 * @brief	Write batches of entity based events to as Telemetry events (bypass PlayStream).
+	 *
+	 * @param Request	PlayFab::EventsModels::FWriteEventsRequest
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	TCoroutine<TOptional<FWriteEventsOutcome>> WriteTelemetryEvents(PlayFab::EventsModels::FWriteEventsRequest Request);
+
+	/**
+	 * @brief	Buffer an event to be written with the next batch. Safe to call from any thread.
+	 *
+	 *	Buffered events are sent every oss.playfab.eventflushinterval seconds, or as soon as oss.playfab.eventbatchsize
+	 *	of them are waiting, in batches of at most that many. While oss.playfab.maxbufferedevents are waiting, further
+	 *	events are dropped and counted. Events of a batch that fails with a transient error are buffered again, up to
+	 *	oss.playfab.maxeventretries times. Whatever is still buffered when the subsystem is deinitialized is sent
+	 *	without waiting for the result. Events of different players are written in separate requests.
+	 *
+	 * @param EventNamespace			The namespace of the event, for example custom.gameplay.
+	 * @param Name						The name of the event.
+	 * @param PayloadJSON				The event payload, as a JSON object.
+	 * @param bTelemetry				Write the event with WriteTelemetryEvents, bypassing PlayStream.
+	 * @param AuthenticationContext		The player to write the event as. The global session if null.
+	 *
+	 * @return	False if the event was dropped because the buffer is full.
+	 */
+	bool BufferEvent(FString EventNamespace, FString Name, FString PayloadJSON, const bool bTelemetry = false,
+		TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext = nullptr);
+
+	/**
+	 * @brief	Send every buffered event now, for example before quitting.
+	 *
+	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 *
+	 * @return	When awaited, the buffer has been emptied.
+	 */
+	TCoroutine<> FlushEvents(const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/** Events dropped because the buffer was full, or because the batch they were in could not be written or retried. */
+	int32 GetDroppedEventCount() const;
+
+private:
+
+	struct FBufferedEvent
+	{
+		PlayFab::EventsModels::FEventContents Contents;
+
+		bool bTelemetry = false;
+
+		TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext;
+
+		/** Number of batches the event was already in. */
+		int32 Attempts = 0;
+	};
+
+	/** The buffered events of one player and endpoint, written with one request. */
+	struct FEventBatch
+	{
+		TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext;
+
+		bool bTelemetry = false;
+
+		TArray<FBufferedEvent> Events;
+	};
+
+	bool Tick(float DeltaTime);
+
+	bool IsBatchInFlight() const;
+
+	/** Start writing the next batch. Only one batch is in flight at a time. */
+	void StartEventBatch();
+
+	TCoroutine<> SendEventBatch(const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	/** Count a written batch, or buffer its events again if the failure was transient. */
+	void ReportEventBatch(const TOptional<FWriteEventsOutcome>& Result, TArray<FBufferedEvent> Events);
+
+	/** Send every buffered event without awaiting the results, as the subsystem is going away. */
+	void SendRemainingEvents();
+
+	TSharedPtr<PlayFab::UPlayFabEventsAPI> EventsAPI;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncPlayFabAuthentication> Authentication;
+
+	TQueue<FBufferedEvent, EQueueMode::Mpsc> BufferedEvents;
+
+	std::atomic<int32> BufferedEventCount = 0;
+
+	std::atomic<int32> DroppedEventCount = 0;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	TOptional<TCoroutine<>> CurrentBatch;
+
+	double LastFlushTime = 0.0;
+};
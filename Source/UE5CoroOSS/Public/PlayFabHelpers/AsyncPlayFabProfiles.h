@@ -6,12 +6,15 @@
 #include "PlayFabError.h"
 #include "UE5Coro.h"
 #include "PlayFabProfilesDataModels.h"
-#include "Containers/Union.h"
 #include "Core/PlayFabProfilesAPI.h"
+#include "PlayFabHelpers/AsyncPlayFabAuthentication.h"
+#include "PlayFabHelpers/PlayFabCall.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "AsyncPlayFabProfiles.generated.h"
 
-typedef TUnion<PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsResponse, PlayFab::FPlayFabCppError> FTitlePlayersUnion;
+typedef TPlayFabOutcome<PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsResponse> FTitlePlayersOutcome;
+
+using FTitlePlayersUnion UE_DEPRECATED(5.4, "Use FTitlePlayersOutcome instead.") = FTitlePlayersOutcome;
 
 UCLASS()
 class UE5COROOSS_API UAsyncPlayFabProfiles : public UGameInstanceSubsystem
@@ -24,25 +27,78 @@ public:
 
 	//~USubsystem Interface Begin
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
 	//~USubsystem Interface End
 
-	static UAsyncPlayFabProfiles* Get(const UObject* WorldContext = GEngine->GameViewport);
+	static UAsyncPlayFabProfiles* Get(const UObject* WorldContext = nullptr);
+
+	/**
+	 * @brief	Call any endpoint of the PlayFab Profiles API.
+	 *
+	 * @note	Waits for the entity token manager first, so the call is not sent with an expired token. Set
+	 *			Request.AuthenticationContext to make the call as another player than the one of the global session.
+	 *
+	 * @param Method	The endpoint, for example &PlayFab::UPlayFabProfilesAPI::GetTitlePlayersFromMasterPlayerAccountIds.
+	 * @param Request	The request to send.
+	 * @param Priority	Priority class of the request. The scoped priority, or interactive, if not given.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	template <typename TRequest, typename TResponse>
+	TCoroutine<TOptional<TPlayFabOutcome<TResponse>>> Call(const TPlayFabMethod<PlayFab::UPlayFabProfilesAPI, TRequest, TResponse> Method,
+		std::remove_const_t<TRequest> Request, const EPlayFabPriority Priority = UE5CoroOSS::GetPlayFabPriority())
+	{
+		const TSharedPtr<PlayFab::UPlayFabProfilesAPI> Api = ProfilesAPI;
+
+		if (!co_await Authentication->WaitForEntityToken(Request.AuthenticationContext))
+		{
+			co_return { TPlayFabOutcome<TResponse>(MakeError(UAsyncPlayFabAuthentication::MakeEntityTokenExpiredError())) };
+		}
+
+		co_return co_await UE5CoroOSS::CallPlayFab(Api, Method, MoveTemp(Request), Priority);
+	}
 
 	/**
 	 * @brief	Retrieves the title player accounts associated with the given master player account.
 	 * 
 	 *	Given a master player account id (PlayFab ID), returns all title player accounts associated with it.
 	 *
-	 * @param Request				PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsRequest
-	 * @param ForceLatentCoroutine	Do not set. Forces latent coroutine.
+	 * @param Request	PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsRequest
 	 *
-	 * @return	When awaited, returns an optional union with either the result object or an error object. If unset,
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
 	 *			the request failed to start.
 	 */
-	TCoroutine<TOptional<FTitlePlayersUnion>> GetTitlePlayersFromMasterPlayerAccountIds(
-		PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsRequest& Request, const FForceLatentCoroutine ForceLatentCoroutine = {});
+	TCoroutine<TOptional<FTitlePlayersOutcome>> GetTitlePlayersFromMasterPlayerAccountIds(
+		PlayFab::ProfilesModels::FGetTitlePlayersFromMasterPlayerAccountIdsRequest& Request);
+
+	/**
+	 * @brief	Retrieves the title player accounts of any number of master player accounts.
+	 *
+	 *	Mappings resolved before are answered from a cache, as they never change. The rest are split into requests of
+	 *	oss.playfab.titleplayerschunksize ids, at most oss.playfab.maxtitleplayerrequests of which are in flight at
+	 *	once, and their results merged into one response.
+	 *
+	 * @param MasterPlayerAccountIds	The master player account ids (PlayFab IDs) to resolve.
+	 * @param TitleId					The title to resolve them in. The current title if empty.
+	 * @param AuthenticationContext		The player to make the requests as. The global session if null.
+	 * @param ForceLatentCoroutine		Do not set. Forces latent coroutine.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the merged result or the first error a request
+	 *			returned. If unset, a request failed to start. Mappings from requests that succeeded are cached either way.
+	 */
+	TCoroutine<TOptional<FTitlePlayersOutcome>> GetTitlePlayersFromMasterPlayerAccountIds(TArray<FString> MasterPlayerAccountIds,
+		FString TitleId = FString(), TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext = nullptr,
+		const FForceLatentCoroutine ForceLatentCoroutine = {});
 
 private:
 
 	TSharedPtr<PlayFab::UPlayFabProfilesAPI> ProfilesAPI;
+
+	/** Title player account of every master player account resolved so far, by title id. */
+	TMap<FString, TMap<FString, PlayFab::ProfilesModels::FEntityKey>> TitlePlayerCache;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncPlayFabAuthentication> Authentication;
 };
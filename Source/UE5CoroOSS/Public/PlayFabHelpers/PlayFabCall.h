@@ -0,0 +1,203 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UE5Coro.h"
+#include "PlayFabAuthenticationContext.h"
+#include "PlayFabError.h"
+#include "PlayFabSettings.h"
+#include "Dom/JsonObject.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "PlayFabHelpers/PlayFabOutcome.h"
+#include "PlayFabHelpers/PlayFabScheduler.h"
+#include "Stats/Stats.h"
+#include <type_traits>
+
+DECLARE_STATS_GROUP(TEXT("UE5CoroOSS PlayFab"), STATGROUP_UE5CoroOSSPlayFab, STATCAT_Advanced);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse Response"), STAT_PlayFabParseResponse, STATGROUP_UE5CoroOSSPlayFab, UE5COROOSS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Parsed Response Bytes"), STAT_PlayFabParsedBytes, STATGROUP_UE5CoroOSSPlayFab, UE5COROOSS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Responses Parsed Off Game Thread"), STAT_PlayFabParsedOffGameThread, STATGROUP_UE5CoroOSSPlayFab, UE5COROOSS_API);
+
+/** Authorization header expected by a PlayFab endpoint. */
+enum class EPlayFabAuthHeader : uint8
+{
+	/** X-EntityToken, used by the entity APIs such as Economy, CloudScript and Profiles. */
+	EntityToken,
+
+	/** X-Authorization, used by the Client API. */
+	SessionTicket
+};
+
+/** Pointer to a PlayFab API endpoint, such as &PlayFab::UPlayFabEconomyAPI::GetItems. */
+template <typename TApi, typename TRequest, typename TResponse>
+using TPlayFabMethod = bool (TApi::*)(TRequest&, const TDelegate<void(const TResponse&)>&, const PlayFab::FPlayFabErrorDelegate&);
+
+namespace UE5CoroOSS
+{
+	/**
+	 * @brief	Call any PlayFab API endpoint and await its outcome.
+	 *
+	 *	The request, response and delegate types are deduced from the endpoint. The success and error callbacks write
+	 *	into state shared with the coroutine, so a callback arriving after the awaiting coroutine was cancelled is
+	 *	harmless, and the call needs no coroutine frame besides its own.
+	 *
+	 * @note	Not a latent coroutine, so it outlives the world it was started from. See Coroutine Lifetime in the README.
+	 *			Only endpoints with the usual request, success delegate and error delegate signature can be called.
+	 *
+	 * @param Api		The PlayFab API instance to call the endpoint on.
+	 * @param Method	The endpoint.
+	 * @param Request	The request to send.
+	 * @param Priority	Priority class the request waits for a scheduler slot in.
+	 * @param SentTime	If set, receives FPlatformTime::Seconds() once the request leaves the scheduler and is sent.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	template <typename TApi, typename TRequest, typename TResponse>
+	TCoroutine<TOptional<TPlayFabOutcome<TResponse>>> CallPlayFab(const TSharedPtr<TApi> Api,
+		const TPlayFabMethod<TApi, TRequest, TResponse> Method, std::remove_const_t<TRequest> Request,
+		const EPlayFabPriority Priority = GetPlayFabPriority(), const TSharedPtr<double> SentTime = nullptr)
+	{
+		struct FState
+		{
+			TOptional<TPlayFabOutcome<TResponse>> Outcome;
+
+			FAwaitableEvent Done;
+		};
+
+		if (!Api.IsValid())
+		{
+			co_return {};
+		}
+
+		const FPlayFabSlot Slot(Priority);
+		co_await Slot.WhenGranted();
+
+		if (SentTime.IsValid())
+		{
+			*SentTime = FPlatformTime::Seconds();
+		}
+
+		const TSharedRef<FState> State = MakeShared<FState>();
+
+		const TDelegate<void(const TResponse&)> SuccessDelegate = TDelegate<void(const TResponse&)>::CreateLambda(
+			[State](const TResponse& Response)
+			{
+				State->Outcome.Emplace(MakeValue(Response));
+				State->Done.Trigger();
+			});
+
+		const PlayFab::FPlayFabErrorDelegate ErrorDelegate = PlayFab::FPlayFabErrorDelegate::CreateLambda(
+			[State](const PlayFab::FPlayFabCppError& Error)
+			{
+				State->Outcome.Emplace(MakeError(Error));
+				State->Done.Trigger();
+			});
+
+		if (!(Api.Get()->*Method)(Request, SuccessDelegate, ErrorDelegate))
+		{
+			co_return {};
+		}
+
+		co_await State->Done;
+
+		co_return MoveTemp(State->Outcome);
+	}
+
+	namespace Private
+	{
+		UE5COROOSS_API bool ShouldParseOnWorker(const FHttpResponsePtr& HttpResponse);
+
+		/**
+		 * @brief	Send a request body to a PlayFab endpoint once the scheduler grants it a slot.
+		 *
+		 * @param AuthenticationContext	The player to authorize the request as. The player of the global session if null.
+		 * @param SentTime				If set, receives FPlatformTime::Seconds() once the request is sent.
+		 *
+		 * @return	When awaited, returns the response and whether the server could be reached. Unset if there is no
+		 *			token or session ticket to send the request with.
+		 */
+		UE5COROOSS_API TCoroutine<TOptional<TTuple<FHttpResponsePtr, bool>>> SendPlayFabRequest(FString Path,
+			const EPlayFabAuthHeader AuthHeader, TSharedPtr<UPlayFabAuthenticationContext> AuthenticationContext, FString Body,
+			const EPlayFabPriority Priority, TSharedPtr<double> SentTime = nullptr);
+
+		UE5COROOSS_API TSharedPtr<FJsonObject> DecodePlayFabResponse(const FHttpResponsePtr& HttpResponse, const bool bSucceeded,
+			PlayFab::FPlayFabCppError& OutError);
+	} // namespace Private
+
+	/**
+	 * @brief	Whether wrappers that support it send their request with CallPlayFabOffGameThread.
+	 *
+	 * @return	Value of oss.playfab.offgamethreadparse.
+	 */
+	UE5COROOSS_API bool IsOffGameThreadParseEnabled();
+
+	/**
+	 * @brief	Call a PlayFab endpoint over HTTP directly, deserializing the response on a worker thread.
+	 *
+	 *	The PlayFab SDK parses every response into its model on the game thread before completing the call. This sends
+	 *	the request itself and, if the response is at least oss.playfab.offgamethreadparseminbytes long, parses it on a
+	 *	task graph worker. The coroutine resumes on the game thread with the finished outcome either way. Parse time and
+	 *	size are reported in the UE5CoroOSS PlayFab stat group.
+	 *
+	 * @note	Only use for endpoints the SDK does not post-process, such as reads. Login calls must go through the SDK so
+	 *			it stores the session.
+	 * @note	The response is still parsed into a full FJsonObject tree and read into the model from there, as the SDK
+	 *			does. Only where that happens changes.
+	 *
+	 * @param Path			The endpoint path, for example /Catalog/GetItems.
+	 * @param AuthHeader	The authorization header the endpoint expects.
+	 * @param Request		The request to send.
+	 * @param Priority		Priority class the request waits for a scheduler slot in.
+	 * @param SentTime		If set, receives FPlatformTime::Seconds() once the request leaves the scheduler and is sent.
+	 *
+	 * @return	When awaited, returns an optional outcome with either the result object or an error object. If unset,
+	 *			the request failed to start.
+	 */
+	template <typename TResponse, typename TRequest>
+	TCoroutine<TOptional<TPlayFabOutcome<TResponse>>> CallPlayFabOffGameThread(const FString Path, const EPlayFabAuthHeader AuthHeader,
+		TRequest Request, const EPlayFabPriority Priority = GetPlayFabPriority(), TSharedPtr<double> SentTime = nullptr)
+	{
+		const TOptional<TTuple<FHttpResponsePtr, bool>> Sent = co_await Private::SendPlayFabRequest(Path, AuthHeader,
+			Request.AuthenticationContext, Request.toJSONString(), Priority, MoveTemp(SentTime));
+
+		if (!Sent.IsSet())
+		{
+			co_return {};
+		}
+
+		const auto& [HttpResponse, bSucceeded] = *Sent;
+
+		const bool bOnWorker = Private::ShouldParseOnWorker(HttpResponse);
+		if (bOnWorker)
+		{
+			co_await Tasks::MoveToTask(TEXT("PlayFabParseResponse"));
+		}
+
+		TOptional<TPlayFabOutcome<TResponse>> Outcome;
+
+		PlayFab::FPlayFabCppError Error;
+		if (const TSharedPtr<FJsonObject> Data = Private::DecodePlayFabResponse(HttpResponse, bSucceeded, Error))
+		{
+			SCOPE_CYCLE_COUNTER(STAT_PlayFabParseResponse);
+
+			TResponse Response;
+			Response.readFromValue(Data);
+
+			Outcome.Emplace(MakeValue(MoveTemp(Response)));
+		}
+		else
+		{
+			Outcome.Emplace(MakeError(MoveTemp(Error)));
+		}
+
+		if (bOnWorker)
+		{
+			co_await Async::MoveToGameThread();
+		}
+
+		co_return Outcome;
+	}
+} // namespace UE5CoroOSS
@@ -0,0 +1,177 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/PlayFabEconomyDataModels.h"
+#include "Tasks/Task.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * @brief	Persistent, memory-mapped cache of PlayFab catalog items keyed by item id.
+ *
+ *	Items are stored in a compact binary file: a header, an entry table holding the id, ETag, last modified date and
+ *	payload location of every item, followed by the serialized item payloads. The file is memory-mapped on load and
+ *	payloads are only deserialized when an item is first requested.
+ *
+ *	BeginSave and FinishSave write the file on a worker thread. Only swapping the new file in happens on the calling
+ *	thread. Save is the blocking variant, for shutdown.
+ */
+class UE5COROOSS_API FPlayFabCatalogCache final
+{
+public:
+
+	FPlayFabCatalogCache();
+
+	~FPlayFabCatalogCache();
+
+	UE_NONCOPYABLE(FPlayFabCatalogCache);
+
+	/**
+	 * @brief	Map the cache file at the given path, replacing any entries currently held.
+	 *
+	 * @param InFilePath	Path to the cache file. Does not need to exist yet.
+	 *
+	 * @return	True if an existing cache file was mapped.
+	 */
+	bool Load(const FString& InFilePath);
+
+	/**
+	 * @brief	Write all entries back to the cache file, if anything changed since it was loaded. Blocks until the
+	 *			file is written, finishing a save started by BeginSave first.
+	 *
+	 * @return	True if the file is up to date.
+	 */
+	bool Save();
+
+	/**
+	 * @brief	Start writing all entries to a temporary file on a worker thread, if anything changed.
+	 *
+	 * @return	True if a write was started. False if nothing changed or a write is already running.
+	 */
+	bool BeginSave();
+
+	/** True while a write started by BeginSave is running. FinishSave does not block once this returns false. */
+	bool IsSaving() const;
+
+	/**
+	 * @brief	Replace the cache file with the one BeginSave wrote, and map it. Waits for the write if it is still running.
+	 *
+	 * @return	True if no save was pending or the file was replaced.
+	 */
+	bool FinishSave();
+
+	/**
+	 * @brief	Find a cached item by id, deserializing it from the mapped file if needed.
+	 *
+	 * @param ItemId	The catalog item id.
+	 *
+	 * @return	The cached item, or null if it is not cached.
+	 */
+	TSharedPtr<const PlayFab::EconomyModels::FCatalogItem> Find(const FString& ItemId);
+
+	/**
+	 * @brief	Find every item in the given list.
+	 *
+	 * @param ItemIds	The catalog item ids.
+	 * @param OutItems	Receives the cached items, in the order of ItemIds.
+	 *
+	 * @return	True if every item was found. OutItems is left empty otherwise.
+	 */
+	bool FindAll(const TArray<FString>& ItemIds, TArray<PlayFab::EconomyModels::FCatalogItem>& OutItems);
+
+	/**
+	 * @brief	Add or refresh items. Items whose ETag matches the cached entry are left untouched.
+	 *
+	 * @param Items	Items returned by the service.
+	 *
+	 * @return	Ids of the items that were added or changed.
+	 */
+	TArray<FString> Update(const TArray<PlayFab::EconomyModels::FCatalogItem>& Items);
+
+	bool Contains(const FString& ItemId) const;
+
+	bool IsDirty() const;
+
+	int32 Num() const;
+
+private:
+
+	struct FEntry
+	{
+		FString ETag;
+
+		FDateTime LastModified;
+
+		int64 PayloadOffset = INDEX_NONE;
+
+		int32 PayloadSize = 0;
+
+		TSharedPtr<const PlayFab::EconomyModels::FCatalogItem> Item;
+	};
+
+	/** Where a saved entry ended up in the written file. */
+	struct FSavedEntry
+	{
+		FString ETag;
+
+		int64 Offset = 0;
+
+		int32 Size = 0;
+	};
+
+	/** What the writer serializes for one entry. Either the item or its payload in the mapped file is set. */
+	struct FEntrySnapshot
+	{
+		FString ItemId;
+
+		FString ETag;
+
+		int64 Ticks = 0;
+
+		TSharedPtr<const PlayFab::EconomyModels::FCatalogItem> Item;
+
+		TConstArrayView64<uint8> Payload;
+	};
+
+	struct FPendingSave
+	{
+		UE::Tasks::TTask<bool> Task;
+
+		FString TempPath;
+
+		int64 PayloadStart = 0;
+
+		TMap<FString, FSavedEntry> Saved;
+	};
+
+	TArray<FEntrySnapshot> MakeSnapshot() const;
+
+	/** Serialize the snapshot into the file layout. Safe to call off the game thread while the file stays mapped. */
+	static TArray<uint8> Serialize(const TArray<FEntrySnapshot>& Snapshot, int64& OutPayloadStart, TMap<FString, FSavedEntry>& OutSaved);
+
+	/** Swap a written temporary file in and point the entries at it. */
+	bool ReplaceFile(const FString& TempPath, const int64 PayloadStart, const TMap<FString, FSavedEntry>& Saved);
+
+	bool ReadEntryTable(TConstArrayView64<uint8> Bytes);
+
+	TConstArrayView64<uint8> GetPayload(const FEntry& Entry) const;
+
+	bool Map();
+
+	void Unmap();
+
+	FString FilePath;
+
+	TMap<FString, FEntry> Entries;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	TUniquePtr<FPendingSave> PendingSave;
+
+	bool bDirty = false;
+};
@@ -0,0 +1,164 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/PlayFabEconomyDataModels.h"
+
+/**
+ * @brief	Lightweight reference to an item held by an FPlayFabCatalogIndex. Stays valid until the index is reset.
+ */
+struct UE5COROOSS_API FPlayFabCatalogItemHandle
+{
+	int32 Index = INDEX_NONE;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	friend bool operator==(const FPlayFabCatalogItemHandle A, const FPlayFabCatalogItemHandle B) { return A.Index == B.Index; }
+
+	friend bool operator<(const FPlayFabCatalogItemHandle A, const FPlayFabCatalogItemHandle B) { return A.Index < B.Index; }
+
+	friend uint32 GetTypeHash(const FPlayFabCatalogItemHandle Handle) { return ::GetTypeHash(Handle.Index); }
+};
+
+enum class EPlayFabCatalogSort : uint8
+{
+	None,
+	PriceAscending,
+	PriceDescending
+};
+
+/**
+ * @brief	Filter for FPlayFabCatalogIndex::Query. Empty fields are ignored.
+ */
+struct UE5COROOSS_API FPlayFabCatalogQuery
+{
+	/** Items must have every one of these tags. */
+	TArray<FString> Tags;
+
+	FString Type;
+
+	FString ContentType;
+
+	/** Currency item id used for the price range and price sorting. Required when sorting by price. */
+	FString CurrencyId;
+
+	int32 MinPrice = 0;
+
+	int32 MaxPrice = MAX_int32;
+
+	EPlayFabCatalogSort Sort = EPlayFabCatalogSort::None;
+};
+
+/**
+ * @brief	Columnar in-memory index over catalog items, for storefront filtering and sorting.
+ *
+ *	Strings are interned once, tags, types and content types each keep a sorted posting list of item handles, and
+ *	every currency keeps an array of item prices sorted by amount. Queries only touch those lists, never the item models.
+ *	Price arrays changed by Add are sorted by the next query that reads them, so paged loads sort each currency once.
+ */
+class UE5COROOSS_API FPlayFabCatalogIndex final
+{
+public:
+
+	/**
+	 * @brief	Add items to the index, replacing previously indexed items with the same id if their ETag changed.
+	 *
+	 * @param NewItems	Items returned by GetItems or SearchItems.
+	 */
+	void Add(const TArray<PlayFab::EconomyModels::FCatalogItem>& NewItems);
+
+	void Reset();
+
+	int32 Num() const;
+
+	FPlayFabCatalogItemHandle FindById(const FString& ItemId) const;
+
+	const PlayFab::EconomyModels::FCatalogItem* Get(const FPlayFabCatalogItemHandle Handle) const;
+
+	/**
+	 * @brief	Get the lowest price of an item in the given currency.
+	 *
+	 * @return	The price, or unset if the item can not be bought with that currency.
+	 */
+	TOptional<int32> GetPrice(const FPlayFabCatalogItemHandle Handle, const FString& CurrencyId) const;
+
+	TConstArrayView<FPlayFabCatalogItemHandle> QueryTag(const FString& Tag) const;
+
+	TConstArrayView<FPlayFabCatalogItemHandle> QueryType(const FString& Type) const;
+
+	TConstArrayView<FPlayFabCatalogItemHandle> QueryContentType(const FString& ContentType) const;
+
+	/**
+	 * @brief	Query items priced in the given currency within a price range.
+	 *
+	 * @return	Matching items, sorted by ascending price.
+	 */
+	TArray<FPlayFabCatalogItemHandle> QueryPrice(const FString& CurrencyId, const int32 MinPrice = 0, const int32 MaxPrice = MAX_int32) const;
+
+	/**
+	 * @brief	Run a combined query, intersecting every set filter.
+	 *
+	 * @return	Matching items, sorted as requested. Unsorted results are in index order. Empty if a price sort is
+	 *			requested without a CurrencyId.
+	 */
+	TArray<FPlayFabCatalogItemHandle> Query(const FPlayFabCatalogQuery& Query) const;
+
+	/**
+	 * @brief	Intersect two handle lists sorted in index order.
+	 */
+	static TArray<FPlayFabCatalogItemHandle> Intersect(TConstArrayView<FPlayFabCatalogItemHandle> A,
+		TConstArrayView<FPlayFabCatalogItemHandle> B);
+
+private:
+
+	struct FPriceEntry
+	{
+		int32 Amount = 0;
+
+		FPlayFabCatalogItemHandle Item;
+	};
+
+	int32 Intern(const FString& String);
+
+	int32 FindString(const FString& String) const;
+
+	void Unindex(const FPlayFabCatalogItemHandle Handle);
+
+	void Index(const FPlayFabCatalogItemHandle Handle);
+
+	static void InsertSorted(TArray<FPlayFabCatalogItemHandle>& Postings, const FPlayFabCatalogItemHandle Handle);
+
+	/** Get the prices of a currency, sorting them first if Add changed them since the last query. */
+	const TArray<FPriceEntry>* FindPrices(const int32 Currency) const;
+
+	TConstArrayView<FPlayFabCatalogItemHandle> FindPostings(const TMap<int32, TArray<FPlayFabCatalogItemHandle>>& Postings,
+		const FString& Key) const;
+
+	TArray<FString> Strings;
+
+	TMap<FString, int32> StringIds;
+
+	TMap<int32, int32> ItemIdToIndex;
+
+	TArray<int32> TypeColumn;
+
+	TArray<int32> ContentTypeColumn;
+
+	TArray<TArray<int32>> TagColumn;
+
+	TArray<TArray<TPair<int32 /*CurrencyId*/, int32 /*Amount*/>>> PriceColumn;
+
+	TArray<TSharedRef<const PlayFab::EconomyModels::FCatalogItem>> Items;
+
+	TMap<int32, TArray<FPlayFabCatalogItemHandle>> TagPostings;
+
+	TMap<int32, TArray<FPlayFabCatalogItemHandle>> TypePostings;
+
+	TMap<int32, TArray<FPlayFabCatalogItemHandle>> ContentTypePostings;
+
+	mutable TMap<int32, TArray<FPriceEntry>> Prices;
+
+	/** Currencies whose price array is out of order since the last Add. */
+	mutable TSet<int32> UnsortedCurrencies;
+};
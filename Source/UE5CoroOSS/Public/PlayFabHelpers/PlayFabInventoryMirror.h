@@ -0,0 +1,64 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/PlayFabEconomyDataModels.h"
+
+/**
+ * @brief	Local copy of one entity's inventory collection, kept current by applying transaction results to it.
+ *
+ *	The mirror tracks the ETag PlayFab reported for the collection. Deltas that can not be applied locally, such as
+ *	bundle purchases or items referenced by alternate id, mark the mirror stale so the next reconcile reloads it.
+ */
+class UE5COROOSS_API FPlayFabInventoryMirror final
+{
+public:
+
+	/**
+	 * @brief	Replace the contents of the mirror.
+	 *
+	 * @param NewItems	Every item in the collection.
+	 * @param NewETag	The collection ETag the items were read at.
+	 */
+	void Reset(TArray<PlayFab::EconomyModels::FInventoryItem> NewItems, const FString& NewETag);
+
+	/**
+	 * @brief	Apply a successful purchase to the mirror.
+	 *
+	 * @param Request	The purchase request that was sent.
+	 * @param Response	The response PlayFab returned for it.
+	 * @param bIsBundle	True if the purchased item is a bundle, whose contents can not be known locally.
+	 */
+	void ApplyPurchase(const PlayFab::EconomyModels::FPurchaseInventoryItemsRequest& Request,
+		const PlayFab::EconomyModels::FPurchaseInventoryItemsResponse& Response, const bool bIsBundle);
+
+	const PlayFab::EconomyModels::FInventoryItem* FindItem(const FString& ItemId, const FString& StackId = FString()) const;
+
+	/**
+	 * @brief	Get the amount of an item held in a stack.
+	 *
+	 * @return	The amount, or zero if the item is not held.
+	 */
+	int32 GetAmount(const FString& ItemId, const FString& StackId = FString()) const;
+
+	const TMap<FString, PlayFab::EconomyModels::FInventoryItem>& GetItems() const;
+
+	const FString& GetETag() const;
+
+	bool IsStale() const;
+
+	void MarkStale();
+
+private:
+
+	static FString MakeStackKey(const FString& ItemId, const FString& StackId);
+
+	void AddAmount(const FString& ItemId, const FString& StackId, const int32 Amount);
+
+	TMap<FString, PlayFab::EconomyModels::FInventoryItem> Items;
+
+	FString ETag;
+
+	bool bStale = true;
+};
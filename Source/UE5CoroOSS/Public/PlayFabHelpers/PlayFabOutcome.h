@@ -0,0 +1,18 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlayFabError.h"
+#include "Templates/ValueOrError.h"
+
+/**
+ * @brief	Outcome of a PlayFab call, holding either the response model or the error PlayFab reported.
+ *
+ *	The API callback hands out a const reference, so the response is copied once out of it and moved from there on.
+ *	Use StealValue to take large models such as catalogs, inventories or user data out of the outcome by move.
+ *
+ * @note	The deprecated *Union names of the wrapper results alias these outcomes. They no longer name TUnion types.
+ */
+template <typename TResponse>
+using TPlayFabOutcome = TValueOrError<TResponse, PlayFab::FPlayFabCppError>;
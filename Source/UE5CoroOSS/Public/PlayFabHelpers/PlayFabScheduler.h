@@ -0,0 +1,85 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UE5Coro.h"
+
+/** How urgently a PlayFab request is sent when more are waiting than may be in flight. */
+enum class EPlayFabPriority : uint8
+{
+	/** Logins, token refreshes and purchases. */
+	Critical,
+
+	/** Requests the player is waiting on. The default. */
+	Interactive,
+
+	/** Prefetches and revalidations nobody is waiting on. */
+	Background
+};
+
+namespace UE5CoroOSS
+{
+	/**
+	 * @brief	Get the priority a PlayFab request started now is sent with.
+	 *
+	 * @param Default	Priority of the request if no FScopedPlayFabPriority is active.
+	 *
+	 * @return	The innermost scoped priority, or Default.
+	 */
+	UE5COROOSS_API EPlayFabPriority GetPlayFabPriority(const EPlayFabPriority Default = EPlayFabPriority::Interactive);
+
+	/**
+	 * @brief	Override the priority of PlayFab requests started on this thread while in scope.
+	 *
+	 *	Wrappers read the priority when they are called, so a request keeps it while it waits for the entity token or a
+	 *	free slot. Do not keep the scope across a co_await, or it applies to whatever else runs on the thread meanwhile.
+	 */
+	class UE5COROOSS_API FScopedPlayFabPriority final : FNoncopyable
+	{
+	public:
+
+		explicit FScopedPlayFabPriority(const EPlayFabPriority Priority);
+
+		~FScopedPlayFabPriority();
+
+	private:
+
+		TOptional<EPlayFabPriority> PreviousPriority;
+	};
+
+	/**
+	 * @brief	A place in the PlayFab request scheduler, held for as long as one request is in flight.
+	 *
+	 *	At most oss.playfab.maxinflight requests are in flight at once, and no more than the limit of their priority
+	 *	class. Waiting requests are started in order of priority, then age, and every oss.playfab.priorityaging seconds
+	 *	spent waiting lifts a request one class, so background requests are not starved. Game thread only.
+	 */
+	class UE5COROOSS_API FPlayFabSlot final : FNoncopyable
+	{
+	public:
+
+		explicit FPlayFabSlot(const EPlayFabPriority Priority);
+
+		/** Frees the slot, or leaves the queue if it was never granted. */
+		~FPlayFabSlot();
+
+		/** Await before sending the request. Completes immediately if the slot was granted straight away. */
+		FAwaitableEvent& WhenGranted() const;
+
+		struct FState
+		{
+			EPlayFabPriority Priority = EPlayFabPriority::Interactive;
+
+			double QueuedTime = 0.0;
+
+			bool bGranted = false;
+
+			FAwaitableEvent Granted{EEventMode::ManualReset};
+		};
+
+	private:
+
+		TSharedRef<FState> State;
+	};
+} // namespace UE5CoroOSS
@@ -0,0 +1,48 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonWriter.h"
+
+typedef TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>> FCondensedJsonWriter;
+
+/**
+ * @brief	Streams USTRUCTs to and from JSON by walking their reflected properties, without building an FJsonObject.
+ *
+ *	Supports numeric, bool, enum, string, name, text, struct, array and map properties. Property names are written
+ *	with FJsonObjectConverter::StandardizeCase and matched case-insensitively when read. Fields without a matching
+ *	property, and values of an unexpected type, are skipped.
+ */
+namespace UE5CoroOSS
+{
+	/**
+	 * @brief	Write a struct as a JSON object value.
+	 *
+	 * @param Writer	Writer positioned where a value is expected.
+	 * @param Struct	Type of the struct.
+	 * @param Data		The struct to write.
+	 */
+	UE5COROOSS_API void WriteStructJson(FCondensedJsonWriter& Writer, const UScriptStruct* Struct, const void* Data);
+
+	/**
+	 * @brief	Read a JSON value into a struct.
+	 *
+	 * @param Reader	Reader whose last read token was Notation.
+	 * @param Notation	The token starting the value. Anything but ObjectStart is skipped.
+	 * @param Struct	Type of the struct.
+	 * @param Data		The struct to read into. Fields not present in the JSON keep their value.
+	 *
+	 * @return	False if the JSON is malformed.
+	 */
+	UE5COROOSS_API bool ReadStructJson(TJsonReader<>& Reader, const EJsonNotation Notation, const UScriptStruct* Struct, void* Data);
+
+	/**
+	 * @brief	Skip over the value that starts with the last read token.
+	 *
+	 * @return	False if the JSON is malformed.
+	 */
+	UE5COROOSS_API bool SkipJsonValue(TJsonReader<>& Reader, const EJsonNotation Notation);
+} // namespace UE5CoroOSS
@@ -0,0 +1,66 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlayFabClientDataModels.h"
+
+/**
+ * @brief	Persistent copy of the title news feed, newest first, keyed by news id and timestamp.
+ *
+ *	The feed is stored in a small binary file holding every item and the time the feed was last checked, so it can be
+ *	shown before the first refresh of a session completes.
+ */
+class UE5COROOSS_API FPlayFabTitleNewsCache final
+{
+public:
+
+	/**
+	 * @brief	Read the cache file at the given path, replacing any items currently held.
+	 *
+	 * @param InFilePath	Path to the cache file. Does not need to exist yet.
+	 *
+	 * @return	True if an existing cache file was read.
+	 */
+	bool Load(const FString& InFilePath);
+
+	/**
+	 * @brief	Write the feed back to the cache file, if anything changed since it was loaded.
+	 *
+	 * @return	True if the file is up to date.
+	 */
+	bool Save();
+
+	/**
+	 * @brief	Whether an item is cached with the same timestamp.
+	 */
+	bool Contains(const PlayFab::ClientModels::FTitleNewsItem& Item) const;
+
+	/**
+	 * @brief	Add new items and replace changed ones, keeping at most MaxItems of the newest.
+	 *
+	 * @param Items		Items returned by the service.
+	 * @param bComplete	True if Items is the whole feed, so cached items missing from it were removed.
+	 * @param MaxItems	Number of items to keep.
+	 *
+	 * @return	True if the feed changed.
+	 */
+	bool Merge(const TArray<PlayFab::ClientModels::FTitleNewsItem>& Items, const bool bComplete, const int32 MaxItems);
+
+	/** Record that the feed was checked against the service now. */
+	void MarkChecked();
+
+	const TArray<PlayFab::ClientModels::FTitleNewsItem>& GetItems() const;
+
+	FDateTime GetLastChecked() const;
+
+private:
+
+	FString FilePath;
+
+	TArray<PlayFab::ClientModels::FTitleNewsItem> Items;
+
+	FDateTime LastChecked;
+
+	bool bDirty = false;
+};
@@ -0,0 +1,45 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlayFabClientDataModels.h"
+
+/**
+ * @brief	Compresses user data values into base64 strings PlayFab can store, and back.
+ *
+ *	Encoded values start with a marker naming the format and the uncompressed size, so values written before a key
+ *	was compressed, or by clients without the codec, are read back unchanged. The format is taken from
+ *	oss.playfab.userdatacodec when encoding.
+ */
+namespace UE5CoroOSS
+{
+	UE5COROOSS_API bool IsEncodedUserData(const FString& Value);
+
+	/**
+	 * @brief	Compress and base64 encode a user data value.
+	 *
+	 * @param Value			The value to encode.
+	 * @param OutEncoded	Receives the encoded value.
+	 *
+	 * @return	False if encoding would not make the value smaller, in which case it should be stored as it is.
+	 */
+	UE5COROOSS_API bool EncodeUserData(const FString& Value, FString& OutEncoded);
+
+	/**
+	 * @brief	Decode a value written by EncodeUserData.
+	 *
+	 * @param Value			The stored value.
+	 * @param OutDecoded	Receives the original value.
+	 *
+	 * @return	False if the value is not encoded or is corrupt.
+	 */
+	UE5COROOSS_API bool DecodeUserData(const FString& Value, FString& OutDecoded);
+
+	UE5COROOSS_API bool HasEncodedUserData(const TMap<FString, PlayFab::ClientModels::FUserDataRecord>& Data);
+
+	/**
+	 * @brief	Decode every encoded value in a user data map, in place. Corrupt values are left as they are.
+	 */
+	UE5COROOSS_API void DecodeUserDataRecords(TMap<FString, PlayFab::ClientModels::FUserDataRecord>& Data);
+} // namespace UE5CoroOSS
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/GameInstance.h"
 
 namespace UE5CoroOSS
 {
@@ -19,4 +20,70 @@ namespace UE5CoroOSS
 	 * @return	Timeout value in seconds.
 	 */
 	double UE5COROOSS_API GetLoginTimeout();
+
+	/**
+	 * @brief	Find the game instance of a world context, without going through the game viewport.
+	 *
+	 *	Dedicated servers and other headless processes never create a viewport, so this resolves through the world
+	 *	instead. Without a usable world context, the game instance owning the game or PIE world is returned.
+	 *
+	 * @note	Without a world context, the game instance is ambiguous once several run in one process, for example
+	 *			with multiple PIE clients. That ensures and returns the first one, so pass a world context there.
+	 *
+	 * @param WorldContext	Any object in a world, such as an actor, a world or a game instance. May be null.
+	 *
+	 * @return	The game instance, or nullptr if none exists yet.
+	 */
+	UE5COROOSS_API UGameInstance* FindGameInstance(const UObject* WorldContext = nullptr);
+
+	namespace Private
+	{
+		UE5COROOSS_API int32 AllocateSubsystemSlot();
+
+		UE5COROOSS_API USubsystem* GetCachedSubsystem(const int32 Slot);
+
+		UE5COROOSS_API void CacheSubsystem(const int32 Slot, USubsystem* Subsystem);
+	} // namespace Private
+
+	/**
+	 * @brief	Drop a subsystem from the lookup cache. Call from Deinitialize of every subsystem resolved through
+	 *			GetGameInstanceSubsystem, so the next lookup does not return a subsystem that is shutting down.
+	 */
+	UE5COROOSS_API void ForgetSubsystem(const USubsystem* Subsystem);
+
+	/**
+	 * @brief	Get a game instance subsystem of the game instance FindGameInstance resolves.
+	 *
+	 * @note	Lookups without a world context are served from a cache on the game thread, so that hot paths do not
+	 *			walk the world contexts and the subsystem map on every call. The cache is only used while a single game
+	 *			instance runs. With several, such lookups resolve every time and ensure, see FindGameInstance.
+	 *
+	 * @return	The subsystem, or nullptr if there is no game instance yet.
+	 */
+	template <typename TSubsystem>
+	TSubsystem* GetGameInstanceSubsystem(const UObject* WorldContext = nullptr)
+	{
+		if (WorldContext || !IsInGameThread())
+		{
+			const UGameInstance* GameInstance = FindGameInstance(WorldContext);
+
+			return GameInstance ? GameInstance->GetSubsystem<TSubsystem>() : nullptr;
+		}
+
+		static const int32 Slot = Private::AllocateSubsystemSlot();
+
+		if (USubsystem* Cached = Private::GetCachedSubsystem(Slot))
+		{
+			return static_cast<TSubsystem*>(Cached);
+		}
+
+		const UGameInstance* GameInstance = FindGameInstance();
+		TSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<TSubsystem>() : nullptr;
+		if (Subsystem)
+		{
+			Private::CacheSubsystem(Slot, Subsystem);
+		}
+
+		return Subsystem;
+	}
 } // namespace UE5CoroOSS
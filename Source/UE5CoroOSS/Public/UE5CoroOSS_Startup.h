@@ -0,0 +1,111 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UE5Coro.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UE5CoroOSS_Startup.generated.h"
+
+class UAsyncAchievements;
+class UAsyncFriends;
+class UAsyncIdentity;
+class UAsyncPlayFabClient;
+class UAsyncPlayFabEconomy;
+
+/**
+ * @brief	Brings up every UE5CoroOSS subsystem of a game instance together, and prefetches what the main menu needs.
+ *
+ *	The interface subsystems are initialized as dependencies, so every online interface is resolved in one pass. Once
+ *	the local user is logged in, the configured prefetches start side by side. Their results land where later callers
+ *	already look: achievement descriptions and the friends list in the online subsystem's caches, catalog items in the
+ *	PlayFab catalog cache, and title data in GetTitleData. Each prefetch waits at most oss.startupprefetchtimeout
+ *	seconds for its login, and is skipped if the login does not happen by then.
+ *
+ *	Configured in the [/Script/UE5CoroOSS.AsyncOSSStartup] section of DefaultGame.ini.
+ */
+UCLASS(Config=Game)
+class UE5COROOSS_API UAsyncOSSStartup final : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UAsyncOSSStartup();
+
+	//~UGameInstanceSubsystem Interface Begin
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+	//~UGameInstanceSubsystem Interface End
+
+	static UAsyncOSSStartup* Get(const UObject* WorldContext = nullptr);
+
+	/**
+	 * @brief	Wait for every prefetch started at startup.
+	 *
+	 * @note	Failed prefetches are not retried. Callers fall back to their regular round trip.
+	 *
+	 * @return	Coroutine, completed once every prefetch has finished.
+	 */
+	TCoroutine<> WaitForPrefetch() const;
+
+	/**
+	 * @brief	Get the title data prefetched at startup.
+	 *
+	 * @note	UAsyncPlayFabClient::GetTitleData does not read this, and always makes a round trip.
+	 *
+	 * @return	The title data, empty until the prefetch completes or if it is disabled.
+	 */
+	const TMap<FString, FString>& GetTitleData() const;
+
+	/** The local user whose login starts the prefetches. */
+	UPROPERTY(Config)
+	int32 LocalUserNum = 0;
+
+	UPROPERTY(Config)
+	bool bPrefetchAchievementDescriptions = false;
+
+	UPROPERTY(Config)
+	bool bPrefetchFriendsList = false;
+
+	/** The friends list to read, see EFriendsLists. */
+	UPROPERTY(Config)
+	FString FriendsListName = TEXT("default");
+
+	UPROPERTY(Config)
+	bool bPrefetchTitleData = false;
+
+	/** Title data keys to prefetch. All keys if empty. */
+	UPROPERTY(Config)
+	TArray<FString> TitleDataKeys;
+
+	/** Catalog items to prefetch into the PlayFab catalog cache. Nothing is prefetched if empty. */
+	UPROPERTY(Config)
+	TArray<FString> CatalogItemIds;
+
+private:
+
+	TCoroutine<> RunPrefetch(const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	TCoroutine<> PrefetchPlayFab(const FForceLatentCoroutine ForceLatentCoroutine = {});
+
+	TOptional<TCoroutine<>> Prefetch;
+
+	TMap<FString, FString> TitleData;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncIdentity> Identity;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncAchievements> Achievements;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncFriends> Friends;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncPlayFabClient> Client;
+
+	UPROPERTY()
+	TObjectPtr<UAsyncPlayFabEconomy> Economy;
+};
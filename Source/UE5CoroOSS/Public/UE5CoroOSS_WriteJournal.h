@@ -0,0 +1,223 @@
+﻿// Copyright No Bright Shadows. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineKeyValuePair.h"
+#include "GameFramework/OnlineReplStructs.h"
+#include "Tasks/Task.h"
+
+class IFileHandle;
+
+/** Backend a journaled write is replayed to. */
+enum class EOfflineWriteKind : uint8
+{
+	/** IOnlineStats::UpdateStats. Method holds the EOnlineStatModificationType. */
+	Stat,
+
+	/** IOnlineAchievements::WriteAchievements. Progress only ever grows, so writes coalesce to the largest. */
+	Achievement,
+
+	/** UPlayFabClientAPI::UpdateUserData. Method holds the EOfflineUserDataMethod flags. Later writes win. */
+	UserData
+};
+
+enum class EOfflineUserDataMethod : uint8
+{
+	None = 0,
+
+	Remove = 1 << 0,
+
+	Private = 1 << 1,
+
+	Public = 1 << 2
+};
+ENUM_CLASS_FLAGS(EOfflineUserDataMethod);
+
+/** One pending write, coalesced with every earlier write to the same key. */
+struct FOfflineWrite
+{
+	EOfflineWriteKind Kind = EOfflineWriteKind::Stat;
+
+	/** The local user the write is made as. Unset for user data, which is written as the logged in PlayFab player. */
+	FUniqueNetIdRepl LocalUserId;
+
+	/** The user whose stat or achievement is written. */
+	FUniqueNetIdRepl UserId;
+
+	/** The PlayFab id of the player whose user data is written. Empty for stats and achievements. */
+	FString Owner;
+
+	/** Stat name, achievement id or user data key. */
+	FString Key;
+
+	FVariantData Value;
+
+	uint8 Method = 0;
+
+	/** Bumped whenever the write changes, so a replay can tell whether it sent the latest value. */
+	uint64 Sequence = 0;
+};
+
+/**
+ * @brief	Append-only on-disk journal of writes waiting for the backend, coalesced by key.
+ *
+ *	Appended writes are merged into the pending write for the same key in memory and buffered for the file. Sync writes
+ *	the buffered records and flushes them to disk in one go, so a burst of writes costs a single fsync. Acknowledgements
+ *	are journaled as records too, so a synced acknowledgement is never replayed again. On Open the file is read back,
+ *	records are applied in order, and a partially written last record is ignored.
+ *
+ *	Compact rewrites the file with only the pending writes. BeginCompact and FinishCompact do it on a worker thread,
+ *	once NeedsCompaction reports the file has grown well past the pending writes.
+ */
+class UE5COROOSS_API FOfflineWriteJournal final
+{
+public:
+
+	FOfflineWriteJournal();
+
+	~FOfflineWriteJournal();
+
+	UE_NONCOPYABLE(FOfflineWriteJournal);
+
+	/**
+	 * @brief	Read the journal at the given path and open it for appending, replacing any writes currently held.
+	 *
+	 * @param InFilePath	Path to the journal. Does not need to exist yet.
+	 *
+	 * @return	The number of pending writes read back.
+	 */
+	int32 Open(const FString& InFilePath);
+
+	void Close();
+
+	/**
+	 * @brief	Add a write, coalescing it with the pending write for the same key.
+	 *
+	 * @note	Not durable until the next Sync.
+	 */
+	void Append(FOfflineWrite Write);
+
+	/**
+	 * @brief	Write buffered records to the journal and flush it to disk.
+	 *
+	 * @return	True if every appended write is on disk.
+	 */
+	bool Sync();
+
+	/**
+	 * @brief	Rewrite the journal with only the pending writes. Blocks until the file is written, finishing a
+	 *			compaction started by BeginCompact first.
+	 *
+	 * @return	True if the journal was rewritten.
+	 */
+	bool Compact();
+
+	/**
+	 * @brief	Start rewriting the journal with only the pending writes on a worker thread.
+	 *
+	 *	Writes appended in the meantime are buffered, and synced once FinishCompact has run.
+	 *
+	 * @return	True if a rewrite was started. False if one is already running.
+	 */
+	bool BeginCompact();
+
+	/** True while a rewrite started by BeginCompact is running. FinishCompact does not block once this returns false. */
+	bool IsCompacting() const;
+
+	/**
+	 * @brief	Complete a rewrite started by BeginCompact. Waits for it if it is still running.
+	 *
+	 * @return	True if no rewrite was pending or the journal was rewritten.
+	 */
+	bool FinishCompact();
+
+	/**
+	 * @brief	Mark a write as accepted by the backend.
+	 *
+	 *	The pending write is dropped if it has not changed since Sent was taken from it. If it has, a summed stat keeps
+	 *	only what was added since, while other writes are kept as they are, as sending them again is harmless.
+	 *
+	 * @note	The acknowledgement is durable after the next Sync. A summed stat the backend accepted is added twice if
+	 *			the game crashes before then, as summing is not idempotent. Every other write is safe to send again.
+	 *
+	 * @param Sent	The write as it was sent.
+	 */
+	void Acknowledge(const FOfflineWrite& Sent);
+
+	TArray<FOfflineWrite> GetPending() const;
+
+	int32 Num() const;
+
+	bool NeedsSync() const;
+
+	/** True once the file holds many more records than there are pending writes. */
+	bool NeedsCompaction() const;
+
+private:
+
+	/** How a record read back from the file is applied to the pending writes. */
+	enum class ERecordKind : uint8
+	{
+		/** Coalesced with the pending write for the same key. */
+		Append,
+
+		/** Replaces the pending write for the same key, after a partial acknowledgement. */
+		Replace,
+
+		/** Drops the pending write for the same key, after an acknowledgement. */
+		Remove
+	};
+
+	struct FPendingCompaction
+	{
+		UE::Tasks::TTask<bool> Task;
+
+		/** The buffered bytes and records the rewritten file already holds. */
+		int32 BufferedBytes = 0;
+
+		int32 BufferedRecords = 0;
+
+		int32 Records = 0;
+	};
+
+	static FString MakeKey(const FOfflineWrite& Write);
+
+	static void SerializeWrite(FArchive& Ar, FOfflineWrite& Write);
+
+	/** Serialize a whole journal holding just the given writes. Safe to call off the game thread. */
+	static TArray<uint8> SerializeJournal(TArray<FOfflineWrite> Writes);
+
+	/** Write one length-prefixed record. Takes a mutable write, as serialization is two-way. */
+	static void WriteRecord(FArchive& Ar, FOfflineWrite& Write, const ERecordKind Kind);
+
+	/** Write a journal to a temporary file and swap it in. Safe to call off the game thread. */
+	static bool ReplaceFile(const FString& Path, const TArray<uint8>& Bytes);
+
+	/** Merge a write into the pending writes, without buffering it for the file. */
+	void Coalesce(FOfflineWrite Write);
+
+	/** Apply a record read back from the file. */
+	void ApplyRecord(const ERecordKind Kind, FOfflineWrite Write);
+
+	/** Buffer a record for the next sync. Takes a mutable write, as serialization is two-way. */
+	void BufferRecord(FOfflineWrite& Write, const ERecordKind Kind = ERecordKind::Append);
+
+	bool OpenForAppend();
+
+	FString FilePath;
+
+	TMap<FString, FOfflineWrite> Pending;
+
+	TUniquePtr<IFileHandle> FileHandle;
+
+	TUniquePtr<FPendingCompaction> PendingCompaction;
+
+	TArray<uint8> Buffered;
+
+	int32 BufferedRecords = 0;
+
+	int32 RecordsInFile = 0;
+
+	uint64 NextSequence = 1;
+};
@@ -26,6 +26,8 @@ public class UE5CoroOSS : ModuleRules
 			new []
 			{
 				"Core",
+				"HTTP",
+				"Json",
 				"UE5Coro",
 				"OnlineSubsystem",
 				"OnlineSubsystemUtils", 
@@ -42,6 +44,8 @@ public class UE5CoroOSS : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"Json",
+				"JsonUtilities",
 				"Slate",
 				"SlateCore",
 				"UE5Coro", 